@@ -0,0 +1,230 @@
+#include "decision_evaluator.h"
+#include "fitness.h"
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <stdexcept>
+#include "../strategies/feature_based_strategy.h"
+
+DecisionEvaluator::DecisionEvaluator(std::shared_ptr<const PlacementPool> heatPool, int maxTrials, int maxShots)
+    : m_heatPool(heatPool ? std::move(heatPool) : std::make_shared<const PlacementPool>()),
+      m_maxTrials(maxTrials),
+      m_maxShots(maxShots)
+{
+}
+
+bool DecisionEvaluator::placeFleet(const PlacementChromosome& placement, Board& board) {
+    auto fleet = placement.decodeFleet();
+    if (!fleet || !fleet->isValid()) {
+        return false;
+    }
+    // Корабли целиком: поклеточный placeShip не регистрирует корабли, и
+    // allShipsSunk никогда не становится true
+    return board.placeFleet(*fleet);
+}
+
+void DecisionEvaluator::setResult(DecisionChromosome& chromosome, const std::vector<int>& shots) {
+    if (shots.empty()) {
+        throw std::runtime_error("Нет успешных симуляций");
+    }
+
+    // Вычисляем среднее и стандартное отклонение
+    int totalShots = 0;
+    for (int count : shots) {
+        totalShots += count;
+    }
+    const double meanShots = static_cast<double>(totalShots) / shots.size();
+
+    double sumSquares = 0.0;
+    for (int count : shots) {
+        sumSquares += (count - meanShots) * (count - meanShots);
+    }
+    const double stdDevShots = std::sqrt(sumSquares / shots.size());
+
+    chromosome.setMeanShots(meanShots);
+    chromosome.setStdDevShots(stdDevShots);
+    chromosome.setFitness(Fitness::calculateDecisionFitness(meanShots, stdDevShots));
+}
+
+void DecisionEvaluator::evaluate(DecisionChromosome& chromosome, const PlacementPool& pool) const {
+    if (pool.empty()) {
+        throw std::runtime_error("Пул расстановок пуст");
+    }
+
+    FeatureBasedStrategy strategy(chromosome.getGenes(), m_heatPool);
+    std::vector<int> allShots;
+    const int trials = std::min(m_maxTrials, static_cast<int>(pool.size()));
+
+    for (int i = 0; i < trials; ++i) {
+        Board board;
+        if (!placeFleet(pool.getPlacement(i), board)) {
+            continue; // Пропускаем невалидные расстановки
+        }
+
+        strategy.reset(); // Сбрасываем стратегию перед новой симуляцией
+        int shots = 0;
+        while (!board.allShipsSunk() && shots < m_maxShots) {
+            auto shot = strategy.getNextShot(board);
+            bool hit = board.shoot(shot.first, shot.second);
+            bool sunk = hit && board.wasShipSunkAt(shot.first, shot.second);
+            strategy.notifyShotResult(shot.first, shot.second, hit, sunk, board);
+            shots++;
+        }
+
+        if (shots < m_maxShots) {
+            allShots.push_back(shots);
+        }
+    }
+
+    setResult(chromosome, allShots);
+}
+
+int DecisionEvaluator::allocState() {
+    if (m_freeStates.empty()) {
+        m_states.emplace_back();
+        return static_cast<int>(m_states.size()) - 1;
+    }
+    const int state = m_freeStates.back();
+    m_freeStates.pop_back();
+    return state;
+}
+
+void DecisionEvaluator::shoot(State& state, int idx) {
+    const int x = idx % BitMask128::SIDE;
+    const int y = idx / BitMask128::SIDE;
+    const bool hit = state.board.shoot(x, y);
+    const bool sunk = hit && state.board.wasShipSunkAt(x, y);
+    state.tracker.observe(x, y, hit ? (sunk ? ShotResult::KILL : ShotResult::HIT) : ShotResult::MISS);
+    state.heat.observe(idx, hit);
+}
+
+void DecisionEvaluator::evaluateLockstep(const std::vector<DecisionChromosome*>& chromosomes,
+                                         const PlacementPool& pool) {
+    if (pool.empty()) {
+        throw std::runtime_error("Пул расстановок пуст");
+    }
+    if (chromosomes.empty()) {
+        return;
+    }
+
+    // Оценки хромосом и общий набор признаков: плоскости считаются для всех
+    // признаков, нужных хоть одной хромосоме, кроме шума (он у каждой свой)
+    std::vector<FeatureScorer> scorers;
+    scorers.reserve(chromosomes.size());
+    uint32_t sharedFeatures = 0;
+    for (const DecisionChromosome* chromosome : chromosomes) {
+        if (chromosome->getGenes().size() != Features::FEATURE_COUNT) {
+            throw std::invalid_argument("Неверное количество весов для стратегии на основе признаков");
+        }
+        scorers.emplace_back(chromosome->getGenes());
+        sharedFeatures |= scorers.back().features();
+    }
+    sharedFeatures &= ~FeaturePlanes::NOISE_FEATURES;
+
+    const size_t count = chromosomes.size();
+    std::vector<std::vector<int>> allShots(count);
+    std::vector<int> gameShots(count);
+    m_shot.assign(count, -1);
+    const int trials = std::min(m_maxTrials, static_cast<int>(pool.size()));
+
+    for (int i = 0; i < trials; ++i) {
+        Board board;
+        if (!placeFleet(pool.getPlacement(i), board)) {
+            continue; // Пропускаем невалидные расстановки
+        }
+
+        // Все партии начинаются одной группой
+        m_freeStates.clear();
+        for (int state = static_cast<int>(m_states.size()) - 1; state >= 0; --state) {
+            m_freeStates.push_back(state);
+        }
+        const int root = allocState();
+        m_states[root].board = board;
+        m_states[root].tracker.reset(board.shipMask());
+        m_states[root].heat.reset(*m_heatPool);
+        m_order.resize(count);
+        std::iota(m_order.begin(), m_order.end(), 0);
+        m_branches.assign(1, Branch{root, 0, 0, count});
+
+        while (!m_branches.empty()) {
+            Branch branch = m_branches.back();
+            m_branches.pop_back();
+
+            // Группа идет одним состоянием, пока ее хромосомы выбирают одну клетку
+            while (true) {
+                State& state = m_states[branch.state];
+                const bool finished = state.board.allShipsSunk();
+                if (finished || branch.move >= m_maxShots) {
+                    for (size_t k = branch.first; k < branch.last; ++k) {
+                        gameShots[m_order[k]] = finished ? branch.move : m_maxShots;
+                    }
+                    m_freeStates.push_back(branch.state);
+                    break;
+                }
+
+                const BitMask128 available = ~state.board.shotMask();
+                state.planes.compute(state.tracker, state.heat, branch.move, available, sharedFeatures);
+                m_stats.lookups += branch.last - branch.first;
+                m_stats.hits += branch.last - branch.first - 1;
+                for (size_t k = branch.first; k < branch.last; ++k) {
+                    const int c = m_order[k];
+                    const FeatureScorer& scorer = scorers[c];
+                    if (scorer.features() & FeaturePlanes::NOISE_FEATURES) {
+                        state.planes.compute(state.tracker, state.heat, branch.move, available,
+                                             FeaturePlanes::NOISE_FEATURES);
+                    }
+                    float bestScore;
+                    m_shot[c] = scorer.argmax(state.planes, branch.move, available, bestScore);
+                }
+
+                // Деление группы по выбранной клетке. Хромосомам без клетки для
+                // выстрела партия не засчитывается, как не уложившаяся в предел
+                std::sort(m_order.begin() + branch.first, m_order.begin() + branch.last,
+                          [this](int a, int b) { return m_shot[a] != m_shot[b] ? m_shot[a] < m_shot[b] : a < b; });
+                size_t begin = branch.first;
+                while (begin < branch.last && m_shot[m_order[begin]] < 0) {
+                    gameShots[m_order[begin++]] = m_maxShots;
+                }
+                if (begin == branch.last) {
+                    m_freeStates.push_back(branch.state);
+                    break;
+                }
+
+                // Все подгруппы, кроме последней, копируют состояние и ждут в стеке;
+                // последняя продолжает с этим состоянием
+                size_t groupStart = begin;
+                while (true) {
+                    const int shot = m_shot[m_order[groupStart]];
+                    size_t groupEnd = groupStart + 1;
+                    while (groupEnd < branch.last && m_shot[m_order[groupEnd]] == shot) {
+                        ++groupEnd;
+                    }
+                    if (groupEnd == branch.last) {
+                        shoot(m_states[branch.state], shot);
+                        branch = Branch{branch.state, branch.move + 1, groupStart, groupEnd};
+                        break;
+                    }
+                    const int copy = allocState();
+                    State& target = m_states[copy];
+                    const State& source = m_states[branch.state];
+                    target.board = source.board;
+                    target.tracker = source.tracker;
+                    target.heat = source.heat;
+                    shoot(target, shot);
+                    m_branches.push_back(Branch{copy, branch.move + 1, groupStart, groupEnd});
+                    groupStart = groupEnd;
+                }
+            }
+        }
+
+        for (size_t c = 0; c < count; ++c) {
+            if (gameShots[c] < m_maxShots) {
+                allShots[c].push_back(gameShots[c]);
+            }
+        }
+    }
+
+    for (size_t c = 0; c < count; ++c) {
+        setResult(*chromosomes[c], allShots[c]);
+    }
+}
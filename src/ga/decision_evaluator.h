@@ -0,0 +1,113 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "decision_chromosome.h"
+#include "placement_pool.h"
+#include "../models/board.h"
+#include "../strategies/features.h"
+
+/**
+ * @brief Оценка хромосом DecisionGA партиями против расстановок пула
+ *
+ * Каждая хромосома играет FeatureBasedStrategy против первых maxTrials
+ * расстановок пула; фитнес считается по среднему и СКО числа выстрелов.
+ *
+ * Режим lockstep играет партии всех хромосом поколения на одной расстановке
+ * вместе. Поле и признаки зависят только от упорядоченной истории выстрелов,
+ * поэтому хромосомы с одной историей (например, с одинаковым дебютом) образуют
+ * группу с общим состоянием: выстрел учитывается, а плоскости признаков
+ * считаются один раз на группу, и для каждой хромосомы остается только ее
+ * взвешенная сумма (FeatureScorer). Выбрав разные клетки, группа делится.
+ * Группы обходятся в глубину, поэтому в кэше процессора одно состояние, как
+ * и при игре по одной хромосоме.
+ */
+class DecisionEvaluator {
+public:
+    static constexpr int DEFAULT_TRIALS = 30;     ///< Расстановок пула на хромосому
+    static constexpr int DEFAULT_MAX_SHOTS = 200; ///< Предел выстрелов в партии
+
+    /**
+     * @brief Статистика общих плоскостей признаков режима lockstep
+     */
+    struct CacheStats {
+        uint64_t lookups = 0; ///< Ходов хромосом (запросов плоскостей)
+        uint64_t hits = 0;    ///< Ходов, взявших плоскости, посчитанные для группы
+
+        double hitRate() const { return lookups ? static_cast<double>(hits) / lookups : 0.0; }
+    };
+
+    /**
+     * @param heatPool Пул для признака Heat, как у FeatureBasedStrategy (nullptr - пустой пул)
+     * @param maxTrials Расстановок пула на хромосому
+     * @param maxShots Предел выстрелов (партии, не уложившиеся в него, не учитываются)
+     */
+    explicit DecisionEvaluator(std::shared_ptr<const PlacementPool> heatPool = nullptr,
+                               int maxTrials = DEFAULT_TRIALS, int maxShots = DEFAULT_MAX_SHOTS);
+
+    /**
+     * @brief Оценивает одну хромосому: отдельная FeatureBasedStrategy на каждую партию
+     */
+    void evaluate(DecisionChromosome& chromosome, const PlacementPool& pool) const;
+
+    /**
+     * @brief Оценивает хромосомы в режиме lockstep с общими плоскостями признаков
+     *
+     * Результат совпадает с evaluate для каждой хромосомы (кроме случайного
+     * шума RandNoise, который, как и в стратегии, выбирается для каждой
+     * хромосомы заново).
+     */
+    void evaluateLockstep(const std::vector<DecisionChromosome*>& chromosomes, const PlacementPool& pool);
+
+    /**
+     * @brief Статистика общих плоскостей с последнего resetStats
+     */
+    const CacheStats& stats() const { return m_stats; }
+
+    void resetStats() { m_stats = CacheStats(); }
+
+private:
+    /// Общая история выстрелов группы партий: поле, признаки партии и плоскости
+    struct State {
+        Board board;
+        FeatureTracker tracker;
+        PlacementHeatIndex heat;
+        FeaturePlanes planes;
+    };
+
+    /// Группа партий с одной историей, ожидающая обхода
+    struct Branch {
+        int state;    ///< Индекс состояния в m_states
+        int move;     ///< Выстрелов в истории
+        size_t first; ///< Партии группы: m_order[first, last)
+        size_t last;
+    };
+
+    std::shared_ptr<const PlacementPool> m_heatPool;
+    int m_maxTrials;
+    int m_maxShots;
+    CacheStats m_stats;
+    std::vector<State> m_states;     ///< Состояния (переиспользуются между вызовами)
+    std::vector<int> m_freeStates;   ///< Свободные индексы m_states
+    std::vector<int> m_order;        ///< Хромосомы, упорядоченные по группам
+    std::vector<int> m_shot;         ///< Клетка, выбранная хромосомой на текущем ходу
+    std::vector<Branch> m_branches;  ///< Стек групп
+
+    /// Свободное состояние (новое, если свободных нет)
+    int allocState();
+
+    /// Применяет выстрел к состоянию
+    void shoot(State& state, int idx);
+
+    /**
+     * @brief Расставляет флот расстановки пула на поле
+     * @return false, если расстановка невалидна
+     */
+    static bool placeFleet(const PlacementChromosome& placement, Board& board);
+
+    /**
+     * @brief Записывает в хромосому среднее, СКО и фитнес по числам выстрелов партий
+     */
+    static void setResult(DecisionChromosome& chromosome, const std::vector<int>& shots);
+};
@@ -58,37 +58,37 @@ DecisionGA::DecisionGA(
 DecisionGA::Chromosome DecisionGA::run(
     int maxGenerations,
     double targetFitness,
-    const std::function<void(Chromosome&, const PlacementPool&)>& fitnessFunction
+    const std::function<void(Chromosome&, const PlacementPool&)>& fitnessFunction,
+    const PlacementPool& pool
 ) {
     // Инициализируем популяцию
     initializePopulation();
     
-    // Создаем пул расстановок для оценки стратегий
-    PlacementPool pool;
-    
     // Оцениваем начальную популяцию
+    std::vector<Chromosome*> chromosomes;
     for (auto& chromosome : m_population) {
-        fitnessFunction(chromosome, pool);
+        chromosomes.push_back(&chromosome);
     }
+    evaluate(chromosomes, fitnessFunction, pool);
     
     // Сортируем популяцию по убыванию фитнеса
     std::sort(m_population.begin(), m_population.end(),
               [](const Chromosome& a, const Chromosome& b) {
-                  return a.fitness > b.fitness;
+                  return a.getFitness() > b.getFitness();
               });
     
     // Получаем лучшую хромосому в начальной популяции
     Chromosome bestChromosome = getBestChromosome();
     
-    std::cout << "Поколение 0: Лучший фитнес = " << bestChromosome.fitness 
-              << ", Среднее число выстрелов = " << bestChromosome.meanShots
-              << ", СКО = " << bestChromosome.stdDevShots << std::endl;
+    std::cout << "Поколение 0: Лучший фитнес = " << bestChromosome.getFitness() 
+              << ", Среднее число выстрелов = " << bestChromosome.getMeanShots()
+              << ", СКО = " << bestChromosome.getStdDevShots() << std::endl;
               
     // Логирование начального поколения
     double sigmaNow = m_initialSigma;
     Logger::instance().logDecisionGen(
             0,  // поколение 0
-            bestChromosome.fitness,
+            bestChromosome.getFitness(),
             getAverageFitness(),
             sigmaNow);
     
@@ -101,24 +101,24 @@ DecisionGA::Chromosome DecisionGA::run(
         sigmaNow = calculateMutationSigma(gen);
         
         // Эволюция популяции на одно поколение
-        bestChromosome = evolvePopulation(fitnessFunction);
+        bestChromosome = evolvePopulation(fitnessFunction, pool);
         
         // Логирование информации о текущем поколении
         Logger::instance().logDecisionGen(
             gen, 
-            bestChromosome.fitness, 
+            bestChromosome.getFitness(), 
             getAverageFitness(),
             sigmaNow);
         
         // Выводим информацию о текущем поколении
         std::cout << "Поколение " << gen 
-                  << ": Лучший фитнес = " << bestChromosome.fitness
-                  << ", Среднее число выстрелов = " << bestChromosome.meanShots
-                  << ", СКО = " << bestChromosome.stdDevShots
+                  << ": Лучший фитнес = " << bestChromosome.getFitness()
+                  << ", Среднее число выстрелов = " << bestChromosome.getMeanShots()
+                  << ", СКО = " << bestChromosome.getStdDevShots()
                   << ", Средний фитнес = " << getAverageFitness() << std::endl;
         
         // Проверяем условие ранней остановки
-        if (bestChromosome.fitness >= targetFitness) {
+        if (bestChromosome.getFitness() >= targetFitness) {
             std::cout << "Целевой фитнес достигнут в поколении " 
                       << gen << std::endl;
             break;
@@ -126,13 +126,13 @@ DecisionGA::Chromosome DecisionGA::run(
     }
     
     std::cout << "Генетический алгоритм завершен." << std::endl;
-    std::cout << "Лучший фитнес: " << bestChromosome.fitness << std::endl;
-    std::cout << "Среднее число выстрелов: " << bestChromosome.meanShots << std::endl;
-    std::cout << "Стандартное отклонение: " << bestChromosome.stdDevShots << std::endl;
+    std::cout << "Лучший фитнес: " << bestChromosome.getFitness() << std::endl;
+    std::cout << "Среднее число выстрелов: " << bestChromosome.getMeanShots() << std::endl;
+    std::cout << "Стандартное отклонение: " << bestChromosome.getStdDevShots() << std::endl;
     std::cout << "Веса признаков:" << std::endl;
     
-    for (size_t i = 0; i < bestChromosome.weights.size(); ++i) {
-        std::cout << "  θ_" << (i + 1) << " = " << bestChromosome.weights[i] << std::endl;
+    for (size_t i = 0; i < bestChromosome.getGenes().size(); ++i) {
+        std::cout << "  θ_" << (i + 1) << " = " << bestChromosome.getGenes()[i] << std::endl;
     }
     
     return bestChromosome;
@@ -182,11 +182,9 @@ void DecisionGA::initializePopulation() {
 }
 
 DecisionGA::Chromosome DecisionGA::evolvePopulation(
-    const std::function<void(Chromosome&, const PlacementPool&)>& fitnessFunction
+    const std::function<void(Chromosome&, const PlacementPool&)>& fitnessFunction,
+    const PlacementPool& pool
 ) {
-    // Создаем пул расстановок для оценки стратегий
-    PlacementPool pool;
-    
     // Создаем новую популяцию
     std::vector<Chromosome> newPopulation;
     newPopulation.reserve(m_populationSize);
@@ -195,6 +193,7 @@ DecisionGA::Chromosome DecisionGA::evolvePopulation(
     for (int i = 0; i < m_eliteCount && i < static_cast<int>(m_population.size()); ++i) {
         newPopulation.push_back(m_population[i]);
     }
+    const size_t eliteEnd = newPopulation.size();
     
     // Заполняем оставшуюся часть новой популяции потомками
     while (newPopulation.size() < m_populationSize) {
@@ -212,26 +211,45 @@ DecisionGA::Chromosome DecisionGA::evolvePopulation(
             mutate(offspring);
         }
         
-        // Вычисляем фитнес для нового потомка
-        fitnessFunction(offspring, pool);
-        
         // Добавляем потомка в новую популяцию
         newPopulation.push_back(offspring);
     }
     
+    // Вычисляем фитнес потомков (селекция идет только по старой популяции,
+    // поэтому всех потомков можно оценить вместе)
+    std::vector<Chromosome*> children;
+    for (size_t i = eliteEnd; i < newPopulation.size(); ++i) {
+        children.push_back(&newPopulation[i]);
+    }
+    evaluate(children, fitnessFunction, pool);
+    
     // Заменяем текущую популяцию новой
     m_population = std::move(newPopulation);
     
     // Сортируем популяцию по убыванию фитнеса
     std::sort(m_population.begin(), m_population.end(),
               [](const Chromosome& a, const Chromosome& b) {
-                  return a.fitness > b.fitness;
+                  return a.getFitness() > b.getFitness();
               });
     
     // Возвращаем лучшую хромосому
     return m_population.front();
 }
 
+void DecisionGA::evaluate(
+    const std::vector<Chromosome*>& chromosomes,
+    const std::function<void(Chromosome&, const PlacementPool&)>& fitnessFunction,
+    const PlacementPool& pool
+) {
+    if (m_populationFitness) {
+        m_populationFitness(chromosomes, pool);
+        return;
+    }
+    for (Chromosome* chromosome : chromosomes) {
+        fitnessFunction(*chromosome, pool);
+    }
+}
+
 DecisionGA::Chromosome DecisionGA::selectParent() {
     // Реализуем турнирную селекцию
     
@@ -251,7 +269,7 @@ DecisionGA::Chromosome DecisionGA::selectParent() {
     // Находим хромосому с максимальным фитнесом в турнире
     auto it = std::max_element(tournament.begin(), tournament.end(),
                                [](const Chromosome& a, const Chromosome& b) {
-                                   return a.fitness < b.fitness;
+                                   return a.getFitness() < b.getFitness();
                                });
     
     return *it;
@@ -265,7 +283,7 @@ DecisionGA::Chromosome DecisionGA::crossover(
     // θ_k^child = α θ_k^A + (1-α) θ_k^B, α ~ U(0,1)
     
     // Проверяем размеры векторов весов
-    if (parent1.weights.size() != DECISION_GENES || parent2.weights.size() != DECISION_GENES) {
+    if (parent1.getGenes().size() != DECISION_GENES || parent2.getGenes().size() != DECISION_GENES) {
         throw std::invalid_argument("Неверный размер вектора весов");
     }
     
@@ -277,7 +295,7 @@ DecisionGA::Chromosome DecisionGA::crossover(
     
     // Применяем арифметический кроссовер с единым α для всех генов
     for (size_t i = 0; i < DECISION_GENES; ++i) {
-        childWeights[i] = alpha * parent1.weights[i] + (1.0 - alpha) * parent2.weights[i];
+        childWeights[i] = alpha * parent1.getGenes()[i] + (1.0 - alpha) * parent2.getGenes()[i];
     }
     
     return Chromosome(childWeights);
@@ -287,7 +305,8 @@ void DecisionGA::mutate(Chromosome& chromosome) {
     // Реализуем гауссовскую мутацию с затухающей дисперсией
     
     // Проверяем размер вектора весов
-    if (chromosome.weights.size() != DECISION_GENES) {
+    std::vector<double> weights = chromosome.getGenes();
+    if (weights.size() != DECISION_GENES) {
         throw std::invalid_argument("Неверный размер вектора весов");
     }
     
@@ -297,12 +316,12 @@ void DecisionGA::mutate(Chromosome& chromosome) {
     // Применяем мутацию к каждому гену
     for (size_t i = 0; i < DECISION_GENES; ++i) {
         // Добавляем гауссовский шум
-        chromosome.weights[i] += m_rng.normalReal(0.0, sigma);
+        weights[i] += m_rng.normalReal(0.0, sigma);
         
         // Ограничиваем значение веса
-        chromosome.weights[i] = std::clamp(chromosome.weights[i], 
-                                          -m_weightBound, m_weightBound);
+        weights[i] = std::clamp(weights[i], -m_weightBound, m_weightBound);
     }
+    chromosome.setGenes(weights);
 }
 
 double DecisionGA::calculateMutationSigma(int generation) const {
@@ -326,7 +345,7 @@ DecisionGA::Chromosome DecisionGA::getBestChromosome() const {
     // Находим хромосому с максимальным фитнесом
     auto it = std::max_element(m_population.begin(), m_population.end(),
                                [](const Chromosome& a, const Chromosome& b) {
-                                   return a.fitness < b.fitness;
+                                   return a.getFitness() < b.getFitness();
                                });
     
     return *it;
@@ -337,7 +356,7 @@ double DecisionGA::getBestFitness() const {
         throw std::runtime_error("Популяция пуста");
     }
     
-    return m_population.front().fitness;
+    return m_population.front().getFitness();
 }
 
 double DecisionGA::getAverageFitness() const {
@@ -347,7 +366,7 @@ double DecisionGA::getAverageFitness() const {
     
     double sum = std::accumulate(m_population.begin(), m_population.end(), 0.0,
                                 [](double sum, const Chromosome& chromosome) {
-                                    return sum + chromosome.fitness;
+                                    return sum + chromosome.getFitness();
                                 });
     
     return sum / m_population.size();
@@ -3,6 +3,7 @@
 #include <vector>
 #include <functional>
 #include <memory>
+#include <algorithm>
 #include "../utils/rng.h"
 #include "../strategies/features.h"
 #include "placement_pool.h"
@@ -21,6 +22,9 @@ class DecisionGA {
 public:
     using Chromosome = DecisionChromosome;   // локальный алиас
     
+    /// Оценка всех новых хромосом поколения одним вызовом
+    using PopulationFitness = std::function<void(const std::vector<Chromosome*>&, const PlacementPool&)>;
+    
     /**
      * @brief Конструктор DecisionGA
      * 
@@ -50,12 +54,14 @@ public:
      * @param maxGenerations Максимальное количество поколений
      * @param targetFitness Целевое значение фитнеса для ранней остановки
      * @param fitnessFunction Функция оценки фитнеса
+     * @param pool Пул расстановок для оценки фитнеса
      * @return Лучшая хромосома
      */
     Chromosome run(
         int maxGenerations,
         double targetFitness,
-        const std::function<void(Chromosome&, const PlacementPool&)>& fitnessFunction
+        const std::function<void(Chromosome&, const PlacementPool&)>& fitnessFunction,
+        const PlacementPool& pool
     );
     
     /**
@@ -108,6 +114,19 @@ public:
         m_currentGeneration = 0;
     }
     
+    /**
+     * @brief Включает оценку поколения целиком
+     *
+     * Если функция задана, новые хромосомы поколения оцениваются одним ее
+     * вызовом (например, DecisionEvaluator::evaluateLockstep), а fitnessFunction
+     * не вызывается.
+     *
+     * @param populationFitness Функция оценки поколения или пустая функция (оценка по одной)
+     */
+    void setPopulationFitness(PopulationFitness populationFitness) {
+        m_populationFitness = std::move(populationFitness);
+    }
+    
     /**
      * @brief Инициализирует начальную популяцию и вычисляет фитнесы 
      * @param fitnessFunction Функция оценки фитнеса
@@ -120,9 +139,17 @@ public:
         initializePopulation();
         
         // Вычисляем фитнес для каждой хромосомы в начальной популяции
+        std::vector<Chromosome*> chromosomes;
         for (auto& chromosome : m_population) {
-            fitnessFunction(chromosome, pool);
+            chromosomes.push_back(&chromosome);
         }
+        evaluate(chromosomes, fitnessFunction, pool);
+        
+        // Элиты берутся из начала популяции, поэтому она должна быть отсортирована
+        std::sort(m_population.begin(), m_population.end(),
+            [](const Chromosome& a, const Chromosome& b) {
+                return a.getFitness() > b.getFitness();
+            });
     }
     
     /**
@@ -134,7 +161,7 @@ public:
         const std::function<void(Chromosome&, const PlacementPool&)>& fitnessFunction,
         const PlacementPool& pool)
     {
-        evolvePopulation(fitnessFunction);
+        evolvePopulation(fitnessFunction, pool);
     }
     
     /**
@@ -166,10 +193,21 @@ private:
      * @brief Эволюция популяции на одно поколение
      * 
      * @param fitnessFunction Функция оценки фитнеса
+     * @param pool Пул расстановок для оценки фитнеса
      * @return Лучшая хромосома в новом поколении
      */
     Chromosome evolvePopulation(
-        const std::function<void(Chromosome&, const PlacementPool&)>& fitnessFunction
+        const std::function<void(Chromosome&, const PlacementPool&)>& fitnessFunction,
+        const PlacementPool& pool
+    );
+    
+    /**
+     * @brief Оценивает хромосомы: одним вызовом populationFitness или по одной
+     */
+    void evaluate(
+        const std::vector<Chromosome*>& chromosomes,
+        const std::function<void(Chromosome&, const PlacementPool&)>& fitnessFunction,
+        const PlacementPool& pool
     );
     
     /**
@@ -215,6 +253,7 @@ private:
     int m_currentGeneration;        ///< Текущее поколение
     
     std::vector<Chromosome> m_population;  ///< Популяция хромосом
+    PopulationFitness m_populationFitness;         ///< Оценка поколения целиком (пусто - по одной)
     RNG m_rng;                                     ///< Генератор случайных чисел
     
     static constexpr int FEATURE_COUNT = 20;       ///< Количество признаков (размерность θ)
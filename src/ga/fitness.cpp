@@ -65,7 +65,7 @@ double calculateDecisionFitness(
  * @param stdDevShots Стандартное отклонение числа ходов
  * @return Значение фитнеса (чем больше, тем лучше)
  */
-double Fitness::calculateDecisionFitness(double meanShots, double stdDevShots) {
+double calculateDecisionFitness(double meanShots, double stdDevShots) {
     // Формула из §3.5: F_d = -μ + 0.1σ
     // Минимизируем среднее число ходов, но добавляем небольшую "премию" за стабильность
     return -meanShots + 0.1 * stdDevShots;
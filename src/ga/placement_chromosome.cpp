@@ -1,5 +1,7 @@
 #include "placement_chromosome.h"
 #include "placement_generator.h"
+#include "../models/placement_masks.h"
+#include "../models/symmetry.h"
 #include <algorithm>
 #include <stdexcept>
 #include <iostream>
@@ -8,131 +10,180 @@
 const std::array<int, PlacementChromosome::SHIP_COUNT> PlacementChromosome::SHIP_LENGTHS = {4, 3, 3, 2, 2, 2, 1, 1, 1, 1};
 
 PlacementChromosome::PlacementChromosome() 
-    : m_genes(GENES_COUNT, 0), m_fitness(0.0), m_meanShots(0.0), m_stdDevShots(0.0),
+    : m_fitness(0.0), m_meanShots(0.0), m_stdDevShots(0.0),
       m_meanShotsRandom(0.0), m_meanShotsCheckerboard(0.0), m_meanShotsMC(0.0)
 {
     // Конструктор по умолчанию, инициализирует гены нулями
 }
 
 PlacementChromosome::PlacementChromosome(RNG& rng) 
-    : m_genes(GENES_COUNT), m_fitness(0.0), m_meanShots(0.0), m_stdDevShots(0.0),
+    : m_fitness(0.0), m_meanShots(0.0), m_stdDevShots(0.0),
       m_meanShotsRandom(0.0), m_meanShotsCheckerboard(0.0), m_meanShotsMC(0.0)
 {
     generateRandomGenes(rng);
 }
 
-PlacementChromosome::PlacementChromosome(const std::vector<int>& genes)
+PlacementChromosome::PlacementChromosome(const Genome& genes)
     : m_genes(genes), m_fitness(0.0), m_meanShots(0.0), m_stdDevShots(0.0),
       m_meanShotsRandom(0.0), m_meanShotsCheckerboard(0.0), m_meanShotsMC(0.0)
+{
+}
+
+PlacementChromosome::PlacementChromosome(const std::vector<int>& genes)
+    : PlacementChromosome()
 {
     if (genes.size() != GENES_COUNT) {
         throw std::invalid_argument("Incorrect number of genes");
     }
+    // Значения вне 0..255 после приведения дают невалидные координаты, что ловит validate()
+    std::transform(genes.begin(), genes.end(), m_genes.begin(),
+                   [](int g) { return static_cast<uint8_t>(g); });
 }
 
-PlacementChromosome::PlacementChromosome(const PlacementChromosome& other)
-    : m_genes(other.m_genes), m_fitness(other.m_fitness), 
-      m_meanShots(other.m_meanShots), m_stdDevShots(other.m_stdDevShots),
-      m_meanShotsRandom(other.m_meanShotsRandom),
-      m_meanShotsCheckerboard(other.m_meanShotsCheckerboard),
-      m_meanShotsMC(other.m_meanShotsMC)
-{
+bool PlacementChromosome::pack(PackedGenome& out) const {
+    for (int i = 0; i < SHIP_COUNT; ++i) {
+        int x = m_genes[i * 3];
+        int y = m_genes[i * 3 + 1];
+        int o = m_genes[i * 3 + 2];
+        if (x > 9 || y > 9 || o > 1) {
+            return false;
+        }
+        out[i] = static_cast<uint8_t>((y * 10 + x) | (o << 7));
+    }
+    return true;
 }
 
-PlacementChromosome& PlacementChromosome::operator=(const PlacementChromosome& other)
-{
-    if (this != &other) {
-        m_genes = other.m_genes;
-        m_fitness = other.m_fitness;
-        m_meanShots = other.m_meanShots;
-        m_stdDevShots = other.m_stdDevShots;
-        m_meanShotsRandom = other.m_meanShotsRandom;
-        m_meanShotsCheckerboard = other.m_meanShotsCheckerboard;
-        m_meanShotsMC = other.m_meanShotsMC;
+PlacementChromosome PlacementChromosome::unpack(const PackedGenome& packed) {
+    Genome genes{};
+    for (int i = 0; i < SHIP_COUNT; ++i) {
+        int pos = packed[i] & 0x7F;
+        genes[i * 3] = static_cast<uint8_t>(pos % 10);
+        genes[i * 3 + 1] = static_cast<uint8_t>(pos / 10);
+        genes[i * 3 + 2] = static_cast<uint8_t>(packed[i] >> 7);
     }
-    return *this;
+    return PlacementChromosome(genes);
+}
+
+uint64_t PlacementChromosome::key() const {
+    // Байт на корабль, как в упакованной форме: 80 бит в двух словах
+    uint64_t lo = 0, hi = 0;
+    for (int i = 0; i < SHIP_COUNT; ++i) {
+        uint64_t b = static_cast<uint64_t>((m_genes[i * 3 + 1] * 10 + m_genes[i * 3]) & 0x7F)
+                   | (static_cast<uint64_t>(m_genes[i * 3 + 2] & 1) << 7);
+        if (i < 8) lo |= b << (8 * i);
+        else hi |= b << (8 * (i - 8));
+    }
+    // Перемешивание splitmix64, чтобы ключи равномерно распределялись по корзинам
+    auto mix = [](uint64_t z) {
+        z += 0x9E3779B97F4A7C15ULL;
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        return z ^ (z >> 31);
+    };
+    return mix(lo ^ mix(hi));
+}
+
+BitMask128 PlacementChromosome::canonicalKey() const {
+    return BoardSymmetry::canonical(occupancyMask());
 }
 
 std::shared_ptr<Fleet> PlacementChromosome::decodeFleet() const {
-    // Используем конструктор по умолчанию Fleet() и добавляем корабли
     auto fleet = std::make_shared<Fleet>(); 
+    decodeInto(*fleet);
+    return fleet;
+}
 
+void PlacementChromosome::decodeInto(Fleet& fleet) const {
+    fleet.clear();
     // Размеры кораблей в порядке: 4,3,3,2,2,2,1,1,1,1 (из Fleet::standardShipLengths)
-    // const std::vector<int> shipSizes = {4, 3, 3, 2, 2, 2, 1, 1, 1, 1}; // Заменено на Fleet::standardShipLengths
-    
-    int geneIndex = 0;
-    for (size_t i = 0; i < Fleet::standardShipLengths.size(); ++i) {
-        int size = Fleet::standardShipLengths[i];
-        // Проверка, что гены не выходят за пределы m_genes
-        if (geneIndex + 2 >= m_genes.size()) {
-            // Ошибка: недостаточно генов для декодирования всех кораблей
-            // Можно вернуть nullptr или кинуть исключение
-            std::cerr << "Ошибка декодирования флота: недостаточно генов в хромосоме." << std::endl;
-            return nullptr; 
-        }
-        int x = m_genes[geneIndex++];
-        int y = m_genes[geneIndex++];
-        bool isHorizontal = m_genes[geneIndex++] == 1; // 1 для горизонтального, 0 для вертикального
-        
-        fleet->addShip(Ship(x, y, size, isHorizontal));
+    for (int i = 0; i < SHIP_COUNT; ++i) {
+        int x = m_genes[i * 3];
+        int y = m_genes[i * 3 + 1];
+        bool isHorizontal = m_genes[i * 3 + 2] == 1; // 1 для горизонтального, 0 для вертикального
+        fleet.addShip(Ship(x, y, SHIP_LENGTHS[i], isHorizontal));
     }
-    
-    return fleet;
 }
 
-bool PlacementChromosome::isValid() const {
-    // Декодируем хромосому в флот
-        auto fleet = decodeFleet();
-    
-    // Проверяем, что флот создан успешно
-    if (!fleet) {
-        std::cout << "ОШИБКА: Не удалось декодировать флот из хромосомы" << std::endl;
-        return false;
-    }
-    
-    // Проверяем, что количество кораблей соответствует ожидаемому
-    if (fleet->size() != SHIP_COUNT) {
-        std::cout << "ОШИБКА: Неверное количество кораблей: " << fleet->size() << " вместо " << SHIP_COUNT << std::endl;
-        return false;
-    }
-    
-    // Проверяем валидность флота (корабли не пересекаются и не касаются)
-    bool fleetValid = fleet->isValid();
+PlacementCheck PlacementChromosome::validateGenes(const Genome& genes, BitMask128* occupancy) {
+    if (occupancy) *occupancy = BitMask128();
     
-    // Дополнительная проверка: все гены должны быть в допустимом диапазоне
-    bool genesValid = true;
+    // Корпус каждого корабля не должен пересекаться с корпусами и ореолами предыдущих
+    FleetMask mask;
+    PlacementCheck result;
     for (int i = 0; i < SHIP_COUNT; ++i) {
-        int x = m_genes[i * 3];
-        int y = m_genes[i * 3 + 1];
-        int o = m_genes[i * 3 + 2];
-        int length = SHIP_LENGTHS[i];
+        int x = genes[i * 3];
+        int y = genes[i * 3 + 1];
+        int o = genes[i * 3 + 2];
         
-        // Координаты должны быть в пределах 0-9
         if (x < 0 || x > 9 || y < 0 || y > 9) {
-            std::cout << "ОШИБКА: Некорректные координаты корабля " << i << ": (" << x << "," << y << ")" << std::endl;
-            genesValid = false;
+            result = {PlacementError::BAD_COORDINATES, i};
             break;
         }
-        
-        // Ориентация должна быть 0 или 1
         if (o != 0 && o != 1) {
-            std::cout << "ОШИБКА: Некорректная ориентация корабля " << i << ": " << o << std::endl;
-            genesValid = false;
+            result = {PlacementError::BAD_ORIENTATION, i};
             break;
         }
-        
-        // Проверка выхода за границы поля
-        if ((o == 0 && y + length - 1 > 9) || (o == 1 && x + length - 1 > 9)) {
-            genesValid = false;
+        const PlacementMask& m = PlacementMasks::get(x, y, SHIP_LENGTHS[i], o == 1);
+        if (!m.legal) {
+            result = {PlacementError::OUT_OF_BOUNDS, i};
+            break;
+        }
+        if (!mask.fits(m)) {
+            result = {PlacementError::OVERLAP, i};
             break;
         }
+        mask.add(m);
     }
     
-    return fleetValid && genesValid;
+    if (occupancy) *occupancy = mask.body;
+    return result;
+}
+
+PlacementCheck PlacementChromosome::validate() const {
+    if (!m_checkCached) {
+        m_check = validateGenes(m_genes, &m_occupancy);
+        m_checkCached = true;
+    }
+    return m_check;
+}
+
+const BitMask128& PlacementChromosome::occupancyMask() const {
+    validate();
+    return m_occupancy;
+}
+
+std::string PlacementChromosome::describe(const PlacementCheck& check) {
+    switch (check.error) {
+        case PlacementError::NONE:
+            return "Расстановка корректна";
+        case PlacementError::BAD_COORDINATES:
+            return "Некорректные координаты корабля " + std::to_string(check.ship);
+        case PlacementError::BAD_ORIENTATION:
+            return "Некорректная ориентация корабля " + std::to_string(check.ship);
+        case PlacementError::OUT_OF_BOUNDS:
+            return "Корабль " + std::to_string(check.ship) + " выходит за пределы поля";
+        case PlacementError::OVERLAP:
+            return "Корабль " + std::to_string(check.ship) + " пересекается или касается другого корабля";
+    }
+    return "Неизвестная ошибка";
+}
+
+bool PlacementChromosome::isValidVerbose(std::ostream& os) const {
+    PlacementCheck check = validate();
+    if (check.ok()) return true;
+    
+    os << "ОШИБКА: " << describe(check);
+    if (check.ship >= 0) {
+        int i = check.ship;
+        os << ": (" << int(m_genes[i * 3]) << "," << int(m_genes[i * 3 + 1])
+           << "), длина=" << SHIP_LENGTHS[i] << ", ориентация=" << int(m_genes[i * 3 + 2]);
+    }
+    os << std::endl;
+    return false;
 }
 
 // Новая реализация, использующая PlacementGenerator
-std::vector<int> PlacementChromosome::generateValidRandomGenes(RNG& rng) {
+PlacementChromosome::Genome PlacementChromosome::generateValidRandomGenes(RNG& rng) {
     // Создаем временный генератор
     PlacementGenerator generator;
     
@@ -149,25 +200,25 @@ std::vector<int> PlacementChromosome::generateValidRandomGenes(RNG& rng) {
 // Реализации функций для различных стратегий размещения,
 // все они делегируют работу PlacementGenerator
 
-std::vector<int> PlacementChromosome::generateCornerPlacement(RNG& rng) {
+PlacementChromosome::Genome PlacementChromosome::generateCornerPlacement(RNG& rng) {
     PlacementGenerator generator;
     auto chrom = generator.generate(Bias::CORNER, rng);
     return chrom.getGenes();
 }
 
-std::vector<int> PlacementChromosome::generateEdgePlacement(RNG& rng) {
+PlacementChromosome::Genome PlacementChromosome::generateEdgePlacement(RNG& rng) {
     PlacementGenerator generator;
     auto chrom = generator.generate(Bias::EDGE, rng);
     return chrom.getGenes();
 }
 
-std::vector<int> PlacementChromosome::generateCenterPlacement(RNG& rng) {
+PlacementChromosome::Genome PlacementChromosome::generateCenterPlacement(RNG& rng) {
     PlacementGenerator generator;
     auto chrom = generator.generate(Bias::CENTER, rng);
     return chrom.getGenes();
 }
 
-std::vector<int> PlacementChromosome::generateMixedPlacement(RNG& rng) {
+PlacementChromosome::Genome PlacementChromosome::generateMixedPlacement(RNG& rng) {
     PlacementGenerator generator;
     auto chrom = generator.generate(Bias::RANDOM, rng);
     return chrom.getGenes();
@@ -176,11 +227,12 @@ std::vector<int> PlacementChromosome::generateMixedPlacement(RNG& rng) {
 void PlacementChromosome::generateRandomGenes(RNG& rng) {
     // Используем новый генератор для создания гарантированно валидных генов
     m_genes = generateValidRandomGenes(rng);
+    m_checkCached = false;
 }
 
 std::string PlacementChromosome::serialize() const {
     std::string result;
-    for (int i = 0; i < m_genes.size(); ++i) {
+    for (size_t i = 0; i < m_genes.size(); ++i) {
         result += std::to_string(m_genes[i]);
         if (i < m_genes.size() - 1) {
             result += ",";
@@ -4,17 +4,52 @@
 #include <memory>
 #include <array>
 #include <string>
+#include <cstdint>
+#include <iostream>
 #include "../models/fleet.h"
+#include "../models/bitboard.h"
 #include "../utils/rng.h"
 #include "constants.h"
 
+/**
+ * @brief Код ошибки проверки генов расстановки
+ */
+enum class PlacementError {
+    NONE,             ///< Расстановка корректна
+    BAD_COORDINATES,  ///< Координаты корабля вне диапазона 0-9
+    BAD_ORIENTATION,  ///< Ориентация не равна 0 или 1
+    OUT_OF_BOUNDS,    ///< Корабль выходит за пределы поля
+    OVERLAP           ///< Корабль пересекается или касается предыдущих
+};
+
+/**
+ * @brief Результат проверки расстановки: код ошибки и номер корабля, на котором она найдена
+ */
+struct PlacementCheck {
+    PlacementError error = PlacementError::NONE; ///< Код ошибки
+    int ship = -1;                               ///< Индекс корабля (-1, если ошибка не связана с кораблем)
+
+    bool ok() const { return error == PlacementError::NONE; }
+};
+
 /**
  * @brief Класс, представляющий хромосому размещения кораблей в генетическом алгоритме
  * 
- * Хромосома содержит 30 целых генов: x, y, ориентация для каждого из 10 кораблей
+ * Хромосома содержит 30 целых генов: x, y, ориентация для каждого из 10 кораблей.
+ * Гены хранятся в массиве фиксированного размера по байту на ген, поэтому
+ * хромосома не выделяет память в куче и популяции лежат в памяти непрерывно.
+ * Для файлов используется упакованная форма: байт на корабль (7 бит позиции + бит ориентации).
  */
 class PlacementChromosome {
 public:
+    // Константы
+    static const int SHIP_COUNT = 10;
+    static const int GENES_COUNT = PLACEMENT_GENES; // x, y, orientation для каждого корабля
+    static const std::array<int, SHIP_COUNT> SHIP_LENGTHS;
+
+    using Genome = std::array<uint8_t, GENES_COUNT>;       ///< Гены: x1,y1,o1, x2,y2,o2, ...
+    using PackedGenome = std::array<uint8_t, SHIP_COUNT>;  ///< Байт на корабль: (y*10+x) | (o << 7)
+
     /**
      * @brief Конструктор по умолчанию
      */
@@ -28,28 +63,64 @@ public:
 
     /**
      * @brief Конструктор для создания хромосомы с заданными генами
-     * @param genes Вектор генов
+     * @param genes Гены расстановки
+     */
+    PlacementChromosome(const Genome& genes);
+
+    /**
+     * @brief Конструктор из вектора генов (для совместимости)
+     * @param genes Вектор из GENES_COUNT генов
+     * @throws std::invalid_argument если количество генов неверно
      */
     PlacementChromosome(const std::vector<int>& genes);
 
+    // Копирование и перемещение - поэлементные: хромосома не владеет памятью в куче
+    PlacementChromosome(const PlacementChromosome& other) = default;
+    PlacementChromosome(PlacementChromosome&& other) noexcept = default;
+    PlacementChromosome& operator=(const PlacementChromosome& other) = default;
+    PlacementChromosome& operator=(PlacementChromosome&& other) noexcept = default;
+
     /**
-     * @brief Конструктор копирования
-     * @param other Копируемая хромосома
+     * @brief Проверяет, валидна ли хромосома
+     * @return true, если хромосома валидна, иначе false
      */
-    PlacementChromosome(const PlacementChromosome& other);
+    bool isValid() const { return validate().ok(); }
 
     /**
-     * @brief Оператор присваивания
-     * @param other Копируемая хромосома
-     * @return Ссылка на текущую хромосому
+     * @brief Проверяет гены без выделения памяти и вывода в консоль
+     * 
+     * Результат и маска занятых клеток кэшируются до следующего setGenes.
+     * @return Код ошибки и номер корабля, на котором она обнаружена
      */
-    PlacementChromosome& operator=(const PlacementChromosome& other);
+    PlacementCheck validate() const;
 
     /**
-     * @brief Проверяет, валидна ли хромосома
+     * @brief Проверка с выводом диагностических сообщений (для отладки)
+     * @param os Поток для сообщений об ошибках
      * @return true, если хромосома валидна, иначе false
      */
-    bool isValid() const;
+    bool isValidVerbose(std::ostream& os = std::cout) const;
+
+    /**
+     * @brief Маска клеток, занятых кораблями (кэшируется вместе с результатом validate)
+     * @return Маска корпусов всех кораблей, помещающихся на поле
+     */
+    const BitMask128& occupancyMask() const;
+
+    /**
+     * @brief Проверяет вектор генов по таблице масок без выделения памяти
+     * @param genes Гены расстановки
+     * @param occupancy Если не nullptr, сюда записывается маска клеток кораблей
+     * @return Код ошибки и номер корабля, на котором она обнаружена
+     */
+    static PlacementCheck validateGenes(const Genome& genes, BitMask128* occupancy = nullptr);
+
+    /**
+     * @brief Текстовое описание результата проверки
+     * @param check Результат validate/validateGenes
+     * @return Строка с описанием ошибки на русском языке
+     */
+    static std::string describe(const PlacementCheck& check);
 
     /**
      * @brief Декодирует хромосому в объект Fleet
@@ -57,17 +128,56 @@ public:
      */
     std::shared_ptr<Fleet> decodeFleet() const;
 
+    /**
+     * @brief Декодирует хромосому в существующий флот
+     * 
+     * Повторно использует память флота, поэтому при многократном вызове
+     * с одним и тем же объектом не выделяет память.
+     * @param fleet Флот, который будет заполнен кораблями хромосомы
+     */
+    void decodeInto(Fleet& fleet) const;
+
     /**
      * @brief Получает гены хромосомы
-     * @return Константная ссылка на вектор генов
+     * @return Константная ссылка на массив генов
      */
-    const std::vector<int>& getGenes() const { return m_genes; }
+    const Genome& getGenes() const { return m_genes; }
 
     /**
      * @brief Устанавливает гены хромосомы
-     * @param g Новый вектор генов
+     * @param g Новые гены
+     */
+    void setGenes(const Genome& g) { m_genes = g; m_checkCached = false; }
+
+    /**
+     * @brief Упаковывает гены: байт на корабль, (y*10+x) в младших 7 битах и ориентация в старшем
+     * @param out Упакованные гены
+     * @return false, если гены вне допустимого диапазона и не могут быть упакованы
+     */
+    bool pack(PackedGenome& out) const;
+
+    /**
+     * @brief Создает хромосому из упакованной формы
+     * @param packed Упакованные гены
+     * @return Хромосома с распакованными генами
      */
-    void setGenes(const std::vector<int>& g) { m_genes = g; }
+    static PlacementChromosome unpack(const PackedGenome& packed);
+
+    /**
+     * @brief 64-битный ключ расстановки (хеш генов) для хеш-таблиц и поиска дубликатов
+     * @return Ключ; одинаковые гены дают одинаковый ключ
+     */
+    uint64_t key() const;
+
+    /**
+     * @brief Канонический ключ расстановки с учетом 8 симметрий поля
+     * 
+     * Минимум из 8 повернутых/отраженных масок клеток кораблей. Симметричные
+     * расстановки получают один и тот же ключ; используется для отсева
+     * дубликатов и как ключ кэша фитнеса.
+     * @return 128-битный ключ (маска)
+     */
+    BitMask128 canonicalKey() const;
 
     /**
      * @brief Получает среднее число выстрелов
@@ -153,19 +263,14 @@ public:
     std::string serialize() const;
 
     // Статические методы для генерации хромосом
-    static std::vector<int> generateValidRandomGenes(RNG& rng);
-    static std::vector<int> generateCornerPlacement(RNG& rng);
-    static std::vector<int> generateEdgePlacement(RNG& rng);
-    static std::vector<int> generateCenterPlacement(RNG& rng);
-    static std::vector<int> generateMixedPlacement(RNG& rng);
-
-    // Константы
-    static const int SHIP_COUNT = 10;
-    static const int GENES_COUNT = PLACEMENT_GENES; // x, y, orientation для каждого корабля
-    static const std::array<int, SHIP_COUNT> SHIP_LENGTHS;
+    static Genome generateValidRandomGenes(RNG& rng);
+    static Genome generateCornerPlacement(RNG& rng);
+    static Genome generateEdgePlacement(RNG& rng);
+    static Genome generateCenterPlacement(RNG& rng);
+    static Genome generateMixedPlacement(RNG& rng);
 
 private:
-    std::vector<int> m_genes;    // гены: x1,y1,o1, x2,y2,o2, ...
+    Genome m_genes{};            // гены: x1,y1,o1, x2,y2,o2, ...
     double m_fitness;            // значение функции приспособленности
     double m_meanShots;          // среднее число выстрелов для потопления
     double m_stdDevShots;        // стандартное отклонение числа выстрелов
@@ -175,5 +280,11 @@ private:
     double m_meanShotsCheckerboard = 0.0;  // среднее для CheckerboardStrategy
     double m_meanShotsMC = 0.0;            // среднее для MonteCarloStrategy
 
+    // Кэш результата validate() (сбрасывается при изменении генов).
+    // Как и остальные const-методы, не предназначен для одновременного вызова из разных потоков.
+    mutable bool m_checkCached = false;    // кэш актуален
+    mutable PlacementCheck m_check;        // результат последней проверки
+    mutable BitMask128 m_occupancy;        // маска клеток кораблей
+
     void generateRandomGenes(RNG& rng);
 }; 
\ No newline at end of file
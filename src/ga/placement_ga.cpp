@@ -1,5 +1,6 @@
 #include "placement_ga.h"
 #include "../utils/logger.h"
+#include "../models/placement_masks.h"
 #include <algorithm>
 #include <numeric>
 #include <stdexcept>
@@ -116,6 +117,8 @@ PlacementChromosome PlacementGA::evolve(
     std::cout << "Лучший фитнес: " << bestChromosome.getFitness() << std::endl;
     std::cout << "Общее количество перегенерированных (невалидных) особей за все время: " 
               << m_regeneratedCount << std::endl;
+    std::cout << "Кэш фитнеса: " << m_cacheHits << " попаданий из " << (m_cacheHits + m_cacheMisses)
+              << " оценок, симметричных дубликатов: " << m_duplicateCount << std::endl;
     
     return bestChromosome;
 }
@@ -142,14 +145,14 @@ void PlacementGA::initializePopulation(
                 // Если не удалось исправить
                 if (!chromosome.isValid()) {
                     // Создаем хромосому с гарантированно валидными генами
-                    std::vector<int> validGenes = PlacementChromosome::generateValidRandomGenes(m_rng);
+                    auto validGenes = PlacementChromosome::generateValidRandomGenes(m_rng);
                     chromosome = PlacementChromosome(validGenes);
                     m_regeneratedCount++;
                 }
         }
         
             // Вычисляем фитнес каждой хромосомы
-            fitnessFunction(chromosome);
+            evaluateFitness(chromosome, fitnessFunction);
         }
         
         // Используем сгенерированную популяцию
@@ -161,7 +164,7 @@ void PlacementGA::initializePopulation(
             // С вероятностью 70% используем более эффективный метод размещения
             PlacementChromosome chromosome;
             if (m_rng.uniformReal(0.0, 1.0) < 0.7) {
-                std::vector<int> validGenes = PlacementChromosome::generateValidRandomGenes(m_rng);
+                auto validGenes = PlacementChromosome::generateValidRandomGenes(m_rng);
                 chromosome = PlacementChromosome(validGenes);
             } else {
                 chromosome = PlacementChromosome(m_rng);
@@ -175,14 +178,14 @@ void PlacementGA::initializePopulation(
                 // Дополнительная проверка валидности после ремонта
                 if (!chromosome.isValid()) {
                     // Создаем новую с гарантированно валидными генами
-                    std::vector<int> validGenes = PlacementChromosome::generateValidRandomGenes(m_rng);
+                    auto validGenes = PlacementChromosome::generateValidRandomGenes(m_rng);
                     chromosome = PlacementChromosome(validGenes);
                     m_regeneratedCount++;
                 }
         }
         
         // Вычисляем фитнес для хромосомы
-        fitnessFunction(chromosome);
+        evaluateFitness(chromosome, fitnessFunction);
         
             // Добавляем в популяцию
         m_population.push_back(chromosome);
@@ -206,9 +209,13 @@ PlacementChromosome PlacementGA::evolvePopulation(
     std::vector<PlacementChromosome> newPopulation;
     newPopulation.reserve(m_populationSize);
     
+    // Канонические ключи особей новой популяции (для поиска симметричных дубликатов)
+    std::unordered_set<BitMask128, BitMask128Hash> keys;
+    
     // Сохраняем элитных особей (лучшие хромосомы из текущей популяции)
     for (int i = 0; i < m_eliteCount; ++i) {
         newPopulation.push_back(m_population[i]);
+        keys.insert(m_population[i].canonicalKey());
     }
     
     // Заполняем оставшуюся часть новой популяции потомками
@@ -237,16 +244,17 @@ PlacementChromosome PlacementGA::evolvePopulation(
         if (!offspring.isValid()) {
                 // Если по какой-то причине хромосома все еще невалидна, 
                 // генерируем новую с использованием гарантированно валидного метода
-                std::vector<int> validGenes = PlacementChromosome::generateValidRandomGenes(m_rng);
+                auto validGenes = PlacementChromosome::generateValidRandomGenes(m_rng);
                 offspring = PlacementChromosome(validGenes);
                 m_regeneratedCount++; // Увеличиваем счетчик перегенерированных особей
             }
         }
         
         // На этом этапе offspring гарантированно валидна
+        diversifyDuplicate(offspring, keys);
         
         // Вычисляем фитнес для нового потомка
-        fitnessFunction(offspring);
+        evaluateFitness(offspring, fitnessFunction);
         
         // Добавляем потомка в новую популяцию
         newPopulation.push_back(offspring);
@@ -311,8 +319,8 @@ PlacementChromosome PlacementGA::crossover(
     // Этот оператор меняет местами гены, соответствующие случайно выбранным кораблям
     
     // Получаем гены родителей
-    std::vector<int> offspringGenes = parent1.getGenes();
-    const std::vector<int>& parent2Genes = parent2.getGenes();
+    PlacementChromosome::Genome offspringGenes = parent1.getGenes();
+    const PlacementChromosome::Genome& parent2Genes = parent2.getGenes();
     
     // Выбираем случайное количество кораблей для обмена (1-4)
     int swapCount = m_rng.uniformInt(1, 4);
@@ -354,7 +362,7 @@ void PlacementGA::mutate(PlacementChromosome& chromosome) {
     // 3. teleport (5%) - полная перестановка корабля
     
     // Получаем гены для модификации
-    std::vector<int> genes = chromosome.getGenes();
+    PlacementChromosome::Genome genes = chromosome.getGenes();
     
     // Выбираем случайный корабль
     int shipIndex = m_rng.uniformInt(0, 9);
@@ -426,39 +434,32 @@ bool PlacementGA::repair(PlacementChromosome& chromosome) {
     if (chromosome.isValid()) return true;
 
     // 1. Декодируем корабли, чтобы работать с координатами
-    auto genes = chromosome.getGenes();                   // 30 int
+    auto genes = chromosome.getGenes();                   // 30 генов (копия)
     constexpr int SHIP_COUNT = 10;
     const int lens[SHIP_COUNT] = {4,3,3,2,2,2,1,1,1,1};
     
-    // 2. «Каркас» поля: 0 = свободно, 1+ = занято/запрещено
-    int field[10][10] = {0};
-
-    auto markShip = [&](int idx, int v){             // v=+1 поставить, v=-1 убрать
-        int len = lens[idx];
-        int x   = genes[idx*3];
-        int y   = genes[idx*3+1];
-        bool hor= genes[idx*3+2]==1;
-        for(int i=0;i<len;++i){
-            int xx = x + (hor?i:0);
-            int yy = y + (hor?0:i);
-            if (xx < 0 || xx >= 10 || yy < 0 || yy >= 10) continue; // Защита от выхода за границы
-            for(int dy=-1;dy<=1;++dy)
-                for(int dx=-1;dx<=1;++dx){
-                    int nx=xx+dx, ny=yy+dy;
-                    if(nx>=0 && nx<10 && ny>=0 && ny<10)
-                        field[ny][nx] += v;
-    }
+    // 2. Маски кораблей по таблице; занятые/запрещённые клетки - объединение
+    //    корпусов и ореолов всех кораблей, кроме переставляемого
+    auto shipMask = [&](int idx) -> const PlacementMask& {
+        return PlacementMasks::get(genes[idx*3], genes[idx*3+1], lens[idx], genes[idx*3+2]==1);
+    };
+    auto othersBlocked = [&](int skip){
+        FleetMask fleet;
+        for(int i=0;i<SHIP_COUNT;++i){
+            if(i!=skip) fleet.add(shipMask(i));
         }
+        return fleet;
     };
+    auto genesValid = [&](){ return PlacementChromosome::validateGenes(genes).ok(); };
 
     // 3. Пытаемся 50 × (#конфликтных) раз «починить» конфигурацию
-    for(int attempt=0; attempt<50 && !chromosome.isValid(); ++attempt){
+    for(int attempt=0; attempt<50 && !genesValid(); ++attempt){
 
         // 3.1 выбираем любой из 10 кораблей случайно
         int s = m_rng.uniformInt(0, SHIP_COUNT-1);
 
         // 3.2 снимаем его с поля
-        markShip(s, -1);
+        FleetMask others = othersBlocked(s);
 
         // 3.3 пробуем до 30 раз поставить заново вокруг текущей позиции
         bool placed = false;
@@ -474,15 +475,9 @@ bool PlacementGA::repair(PlacementChromosome& chromosome) {
             if (hor && x+len-1>9) x = 10-len;
             if (!hor && y+len-1>9) y = 10-len;
     
-            // проверка
-            bool ok=true;
-            for(int i=0;i<len && ok;++i){
-                int xx=x+(hor?i:0), yy=y+(hor?0:i);
-                if(field[yy][xx]) ok=false;          // занято или запрещено
-            }
-            if(ok){
+            // проверка: корпус не задевает чужие корабли и их ореолы
+            if(others.fits(x, y, len, hor)){
                 genes[s*3]=x; genes[s*3+1]=y; genes[s*3+2]=hor?1:0;
-                markShip(s,+1);
                 placed=true;
             }
         }
@@ -495,14 +490,8 @@ bool PlacementGA::repair(PlacementChromosome& chromosome) {
                 int len = lens[s];
                 int x   = m_rng.uniformInt(0, hor?10-len:9);
                 int y   = m_rng.uniformInt(0, hor?9:10-len);
-                bool ok=true;
-                for(int i=0;i<len && ok;++i){
-                    int xx=x+(hor?i:0), yy=y+(hor?0:i);
-                    if(field[yy][xx]) ok=false;
-                }
-                if(ok){
+                if(others.fits(x, y, len, hor)){
                     genes[s*3]=x; genes[s*3+1]=y; genes[s*3+2]=hor?1:0;
-                    markShip(s,+1);
                     done=true;
                 }
             }
@@ -565,12 +554,75 @@ bool PlacementGA::repair(PlacementChromosome& chromosome) {
     return chromosome.isValid(); // true => успех; false => особь можно отбросить (но это не должно случаться)
 }
 
+void PlacementGA::evaluateFitness(
+    PlacementChromosome& chromosome,
+    const std::function<double(PlacementChromosome&)>& fitnessFunction
+) {
+    if (!m_fitnessCacheEnabled || !chromosome.isValid()) {
+        fitnessFunction(chromosome);
+        return;
+    }
+    
+    BitMask128 key = chromosome.canonicalKey();
+    auto it = m_fitnessCache.find(key);
+    if (it != m_fitnessCache.end()) {
+        // Симметричная (или та же) расстановка уже оценивалась
+        const CachedFitness& c = it->second;
+        chromosome.setFitness(c.fitness);
+        chromosome.setMeanShots(c.meanShots);
+        chromosome.setStdDevShots(c.stdDevShots);
+        chromosome.setMeanShotsRandom(c.meanShotsRandom);
+        chromosome.setMeanShotsCheckerboard(c.meanShotsCheckerboard);
+        chromosome.setMeanShotsMC(c.meanShotsMC);
+        m_cacheHits++;
+        return;
+    }
+    
+    fitnessFunction(chromosome);
+    m_cacheMisses++;
+    
+    if (m_fitnessCache.size() >= MAX_FITNESS_CACHE) {
+        m_fitnessCache.clear(); // Ограничиваем память
+    }
+    m_fitnessCache.emplace(key, CachedFitness{
+        chromosome.getFitness(),
+        chromosome.getMeanShots(),
+        chromosome.getStdDevShots(),
+        chromosome.getMeanShotsRandom(),
+        chromosome.getMeanShotsCheckerboard(),
+        chromosome.getMeanShotsMC()
+    });
+}
+
+void PlacementGA::diversifyDuplicate(
+    PlacementChromosome& offspring,
+    std::unordered_set<BitMask128, BitMask128Hash>& keys
+) {
+    BitMask128 key = offspring.canonicalKey();
+    for (int attempt = 0; attempt < MAX_DUPLICATE_RETRIES && keys.count(key); ++attempt) {
+        m_duplicateCount++;
+        PlacementChromosome previous = offspring;
+        mutate(offspring);
+        if (!offspring.isValid()) {
+            repair(offspring);
+            if (!offspring.isValid()) {
+                // Ремонт не удался - возвращаем валидного потомка до мутации
+                offspring = std::move(previous);
+                continue;
+            }
+        }
+        key = offspring.canonicalKey();
+    }
+    keys.insert(key);
+}
+
 bool PlacementGA::verifyPopulationValidity() const {
     bool allValid = true;
     
     for (size_t i = 0; i < m_population.size(); ++i) {
         if (!m_population[i].isValid()) {
             std::cerr << "ОШИБКА: Невалидная хромосома в популяции на позиции " << i << std::endl;
+            m_population[i].isValidVerbose(std::cerr);
             allValid = false;
         }
     }
@@ -646,6 +698,11 @@ PlacementChromosome PlacementGA::evolveWithParams(
         
         nextPopulation.insert(nextPopulation.end(), m_population.begin(), m_population.begin() + m_eliteCount);
         
+        std::unordered_set<BitMask128, BitMask128Hash> keys;
+        for (const auto& elite : nextPopulation) {
+            keys.insert(elite.canonicalKey());
+        }
+        
         // 2. Заполняем остаток новой популяции через операторы GA
         while (nextPopulation.size() < m_populationSize) {
             // Выбираем двух родителей турнирной селекцией
@@ -672,9 +729,11 @@ PlacementChromosome PlacementGA::evolveWithParams(
                     continue;
                 }
             }
+            diversifyDuplicate(offspring, keys);
+            
             
             // Вычисляем фитнес для нового потомка
-            fitnessFunction(offspring);
+            evaluateFitness(offspring, fitnessFunction);
             
             // Добавляем потомка в новую популяцию
             nextPopulation.push_back(std::move(offspring));
@@ -713,6 +772,8 @@ PlacementChromosome PlacementGA::evolveWithParams(
     std::cout << "Генетический алгоритм завершен." << std::endl;
     std::cout << "Лучший фитнес: " << bestChromosome.getFitness() << std::endl;
     std::cout << "Регенерировано невалидных хромосом: " << m_regeneratedCount << std::endl;
+    std::cout << "Кэш фитнеса: " << m_cacheHits << " попаданий из " << (m_cacheHits + m_cacheMisses)
+              << " оценок, симметричных дубликатов: " << m_duplicateCount << std::endl;
     
     return bestChromosome;
 } 
\ No newline at end of file
@@ -3,6 +3,8 @@
 #include <vector>
 #include <memory>
 #include <functional>
+#include <unordered_map>
+#include <unordered_set>
 #include "placement_chromosome.h"
 #include "placement_generator.h"
 #include "../utils/rng.h"
@@ -137,6 +139,33 @@ public:
      */
     int getRegeneratedCount() const { return m_regeneratedCount; }
 
+    /**
+     * @brief Включает или выключает кэш фитнеса по каноническому ключу расстановки
+     * 
+     * Симметричные расстановки против симметричных стрелков имеют одинаковый
+     * ожидаемый фитнес, поэтому повторно не оцениваются.
+     * @param enabled true - использовать кэш (по умолчанию), false - оценивать всегда
+     */
+    void setFitnessCacheEnabled(bool enabled) {
+        m_fitnessCacheEnabled = enabled;
+        if (!enabled) m_fitnessCache.clear();
+    }
+
+    /**
+     * @brief Количество оценок фитнеса, взятых из кэша
+     */
+    size_t getFitnessCacheHits() const { return m_cacheHits; }
+
+    /**
+     * @brief Количество реальных вызовов фитнес-функции через кэш
+     */
+    size_t getFitnessCacheMisses() const { return m_cacheMisses; }
+
+    /**
+     * @brief Количество потомков, оказавшихся симметричными дубликатами особей новой популяции
+     */
+    int getDuplicateCount() const { return m_duplicateCount; }
+
     /**
      * @brief Получает текущую популяцию
      * @return Ссылка на вектор хромосом
@@ -212,7 +241,47 @@ private:
      */
     bool verifyPopulationValidity() const;
 
+    /**
+     * @brief Вычисляет фитнес хромосомы, используя кэш по каноническому ключу
+     * @param chromosome Хромосома для оценки
+     * @param fitnessFunction Фитнес-функция
+     */
+    void evaluateFitness(
+        PlacementChromosome& chromosome,
+        const std::function<double(PlacementChromosome&)>& fitnessFunction
+    );
+
+    /**
+     * @brief Разнообразит потомка, если он симметричен уже принятой особи
+     * 
+     * До MAX_DUPLICATE_RETRIES раз применяет мутацию (с ремонтом), затем
+     * добавляет канонический ключ потомка в набор ключей популяции. Мутация,
+     * после которой ремонт не вернул валидность, отменяется, поэтому валидный
+     * потомок остается валидным.
+     * @param offspring Потомок
+     * @param keys Канонические ключи особей новой популяции
+     */
+    void diversifyDuplicate(
+        PlacementChromosome& offspring,
+        std::unordered_set<BitMask128, BitMask128Hash>& keys
+    );
+
 private:
+    /**
+     * @brief Статистика расстановки, сохраняемая в кэше фитнеса
+     */
+    struct CachedFitness {
+        double fitness;
+        double meanShots;
+        double stdDevShots;
+        double meanShotsRandom;
+        double meanShotsCheckerboard;
+        double meanShotsMC;
+    };
+
+    static constexpr size_t MAX_FITNESS_CACHE = 1u << 20;  // Предел записей кэша (при переполнении кэш очищается)
+    static constexpr int MAX_DUPLICATE_RETRIES = 3;        // Попыток мутации для симметричного дубликата
+
     // Текущая популяция хромосом
     std::vector<PlacementChromosome> m_population;
     
@@ -248,4 +317,13 @@ private:
     
     // Счетчик перегенерированных невалидных особей
     int m_regeneratedCount = 0;
+    
+    // Кэш фитнеса по каноническому ключу расстановки
+    std::unordered_map<BitMask128, CachedFitness, BitMask128Hash> m_fitnessCache;
+    bool m_fitnessCacheEnabled = true;
+    size_t m_cacheHits = 0;
+    size_t m_cacheMisses = 0;
+    
+    // Счетчик симметричных дубликатов среди потомков
+    int m_duplicateCount = 0;
 }; 
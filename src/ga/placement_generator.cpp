@@ -4,15 +4,6 @@
 PlacementGenerator::PlacementGenerator(int maxTries)
         : maxTries(maxTries) {}
 
-// Вспомогательная функция для генерации уникального строкового ключа хромосомы
-static std::string generateChromosomeKey(const PlacementChromosome& chrom) {
-    std::string key;
-    for (int gene : chrom.getGenes()) {
-        key += std::to_string(gene) + ",";
-    }
-    return key;
-}
-
 static std::pair<int,int> randomXY(int len, bool vert,
                                    RNG& rng, Bias bias, int shipIdx) {
     int x,y;
@@ -90,38 +81,19 @@ static std::pair<int,int> randomXY(int len, bool vert,
 }
 
 bool PlacementGenerator::fits(int x, int y, int len, bool vert,
-    const std::vector<std::vector<int>>& g) const {
-    // Проверка границ поля
-    if (x < 0 || (vert ? x > 9 : x + len - 1 > 9) ||
-        y < 0 || (vert ? y + len - 1 > 9 : y > 9)) {
-        return false; // Выход за границы
-    }
-    
-    // Проверка каждой клетки корабля и правила no-touch
-    for (int i=0; i<len; ++i){
-        int xi = x + (!vert?i:0);
-        int yi = y + (vert?i:0);
-        if (g[yi][xi]) return false;                // занято
-        // проверка no-touch по правилу Чебышева (расстояние > 1)
-        for(int dy=-1; dy<=1; ++dy)
-            for(int dx=-1; dx<=1; ++dx){
-                int xx=xi+dx, yy=yi+dy;
-                if (xx>=0 && xx<10 && yy>=0 && yy<10 && g[yy][xx]) return false;
-            }
-    }
-    return true;
+    const FleetMask& fleet) const {
+    // Выход за границы, пересечение и правило no-touch проверяются одной операцией над масками
+    return fleet.fits(x, y, len, !vert);
 }
 
 bool PlacementGenerator::placeShip(int len, bool vert,
-    std::vector<std::vector<int>>& g, int& outX, int& outY,
+    FleetMask& fleet, int& outX, int& outY,
     RNG& rng, Bias bias, int shipIdx) const {
     for(int t=0; t<maxTries; ++t){
         auto [x,y] = randomXY(len, vert, rng, bias, shipIdx);
-        if (fits(x, y, len, vert, g)){
-            // Размещаем корабль в сетке
-            for(int i=0; i<len; ++i){
-                g[y+(vert?i:0)][x+(!vert?i:0)]=1;
-            }
+        if (fits(x, y, len, vert, fleet)){
+            // Размещаем корабль
+            fleet.add(PlacementMasks::get(x, y, len, !vert));
             outX=x; outY=y;
             return true;
         }
@@ -132,8 +104,8 @@ bool PlacementGenerator::placeShip(int len, bool vert,
 }
 
 PlacementChromosome PlacementGenerator::generate(Bias bias, RNG& rng) const {
-    std::vector<std::vector<int>> grid(10, std::vector<int>(10,0));
-    std::vector<int> genes(PlacementChromosome::GENES_COUNT);
+    FleetMask fleet;
+    PlacementChromosome::Genome genes{};
     const int lens[10]={4,3,3,2,2,2,1,1,1,1};
     int geneIdx=0;
     
@@ -141,7 +113,7 @@ PlacementChromosome PlacementGenerator::generate(Bias bias, RNG& rng) const {
         int len = lens[s];
         bool vert = rng.getBool(0.5); // 50% вероятность вертикального размещения
         int x, y;
-        if (!placeShip(len, vert, grid, x, y, rng, bias, s))
+        if (!placeShip(len, vert, fleet, x, y, rng, bias, s))
             return generate(Bias::RANDOM, rng); // Рестарт всей схемы с RANDOM bias
             
         genes[geneIdx++] = x;
@@ -159,7 +131,8 @@ PlacementChromosome PlacementGenerator::generate(Bias bias, RNG& rng) const {
 
 std::vector<PlacementChromosome>
 PlacementGenerator::generatePopulation(size_t n, RNG& rng) const {
-    std::unordered_set<std::string> seen;
+    // Канонические ключи: симметричные расстановки считаются одинаковыми
+    std::unordered_set<BitMask128, BitMask128Hash> seen;
     std::vector<PlacementChromosome> pop;
     pop.reserve(n);
     
@@ -180,8 +153,8 @@ PlacementGenerator::generatePopulation(size_t n, RNG& rng) const {
             continue; // Пропускаем невалидные хромосомы
         }
         
-        // Создаем уникальный ключ и добавляем в популяцию, если такой расстановки еще нет
-        if (seen.insert(generateChromosomeKey(chrom)).second) {
+        // Добавляем в популяцию, если такой расстановки (с точностью до симметрии) еще нет
+        if (seen.insert(chrom.canonicalKey()).second) {
             pop.push_back(chrom);
         }
     }
@@ -193,11 +166,11 @@ PlacementGenerator::generatePopulation(size_t n, RNG& rng) const {
     
     while (pop.size() < n && additionalAttempts < maxAdditionalAttempts) {
         additionalAttempts++;
-        std::vector<int> genes = PlacementChromosome::generateValidRandomGenes(rng);
+        auto genes = PlacementChromosome::generateValidRandomGenes(rng);
         PlacementChromosome chrom(genes);
         
         // Добавляем в популяцию, только если такой расстановки еще нет
-        if (seen.insert(generateChromosomeKey(chrom)).second) {
+        if (seen.insert(chrom.canonicalKey()).second) {
         pop.push_back(chrom);
         }
     }
@@ -1,5 +1,6 @@
 #pragma once
 #include "placement_chromosome.h"
+#include "../models/placement_masks.h"
 #include <unordered_set>
 
 enum class Bias { EDGE, CORNER, CENTER, RANDOM };
@@ -12,10 +13,10 @@ public:
             size_t n, RNG& rng) const;
 private:
     bool placeShip(int len, bool vertical,
-                   std::vector<std::vector<int>>& grid,
+                   FleetMask& fleet,
                    int& outX, int& outY, RNG& rng,
                    Bias bias, int shipIdx) const;
     bool fits(int x, int y, int len, bool vertical,
-              const std::vector<std::vector<int>>& grid) const;
+              const FleetMask& fleet) const;
     int maxTries;
 }; 
\ No newline at end of file
@@ -9,6 +9,8 @@
 #include "../strategies/random_strategy.h"
 #include "../strategies/checkerboard_strategy.h"
 #include "../strategies/monte_carlo_strategy.h"
+#include "../strategies/surrogate_strategy.h"
+#include "../models/heatmap.h"
 
 PlacementPool::PlacementPool(
     size_t bestPoolSize,
@@ -32,6 +34,17 @@ void PlacementPool::setBestPlacements(const std::vector<PlacementChromosome>& pl
     }
     
     bestPlacements = placements;
+
+    // Индекс масок: маски кэшируются хромосомами, счетчики клеток - суммой масок
+    bestMasks.clear();
+    bestMasks.reserve(bestPlacements.size());
+    bestCellCounts.fill(0);
+    BitSlicedCounter counter;
+    for (const auto& placement : bestPlacements) {
+        bestMasks.push_back(placement.occupancyMask());
+        counter.add(bestMasks.back());
+    }
+    counter.addTo(bestCellCounts);
 }
 
 void PlacementPool::setRandomPlacements(const std::vector<PlacementChromosome>& placements) {
@@ -85,6 +98,35 @@ PlacementChromosome PlacementPool::getRandomPlacement() {
     }
 }
 
+// --- Реализация класса PlacementHeatIndex ---
+
+void PlacementHeatIndex::reset(const PlacementPool& pool) {
+    m_live = pool.getBestMasks();
+    m_counts = pool.getBestCellCounts();
+    m_observed = BitMask128();
+}
+
+void PlacementHeatIndex::observe(int idx, bool hit) {
+    if (m_observed.test(idx)) {
+        return;
+    }
+    m_observed.set(idx);
+
+    // Удаляем противоречащие выстрелу маски (перестановкой с последней)
+    size_t i = 0;
+    while (i < m_live.size()) {
+        if (m_live[i].test(idx) == hit) {
+            ++i;
+            continue;
+        }
+        for (BitMask128 cells = m_live[i]; cells.any(); ) {
+            --m_counts[cells.popLowest()];
+        }
+        m_live[i] = m_live.back();
+        m_live.pop_back();
+    }
+}
+
 // --- Реализация класса ShooterPool ---
 
 ShooterPool::ShooterPool(int randomGames, int checkerGames, int mcGames, int mcIterations)
@@ -129,7 +171,7 @@ double ShooterPool::random(const PlacementChromosome& chromosome) {
             if (target.first == -1 && target.second == -1) break; // Проверка сигнала окончания игры
             
             bool hit = board.shoot(target.first, target.second);
-            bool sunk = hit && board.wasShipSunkAt(target.first, target.second);
+            bool sunk = hit && board.lastSunk().any();
             shooter->notifyShotResult(target.first, target.second, hit, sunk, board);
             shots++;
         }
@@ -171,7 +213,7 @@ double ShooterPool::checker(const PlacementChromosome& chromosome) {
             if (target.first == -1 && target.second == -1) break; // Проверка сигнала окончания игры
             
             bool hit = board.shoot(target.first, target.second);
-            bool sunk = hit && board.wasShipSunkAt(target.first, target.second);
+            bool sunk = hit && board.lastSunk().any();
             shooter->notifyShotResult(target.first, target.second, hit, sunk, board);
             shots++;
         }
@@ -191,8 +233,15 @@ double ShooterPool::montecarlo(const PlacementChromosome& chromosome) {
     int totalTurns = 0;
     
     for (int i = 0; i < m_mcGames; ++i) {
-        // Используем настоящую стратегию Монте-Карло вместо случайной
-        auto shooter = std::make_unique<MonteCarloStrategy>(m_rng, m_mcIterations);
+        // Используем настоящую стратегию Монте-Карло или ее быстрый заменитель
+        std::unique_ptr<MonteCarloStrategy> shooter;
+        if (m_surrogate) {
+            shooter = std::make_unique<SurrogateStrategy>(m_rng, m_surrogate);
+        } else {
+            shooter = std::make_unique<MonteCarloStrategy>(m_rng, m_mcIterations);
+            // Выборка переживает ходы: пересчитываются только отброшенные образцы
+            shooter->setIncremental(true);
+        }
         
         // Создаем игровую доску и размещаем флот
         Board board;
@@ -213,7 +262,7 @@ double ShooterPool::montecarlo(const PlacementChromosome& chromosome) {
             if (target.first == -1 && target.second == -1) break; // Проверка сигнала окончания игры
             
             bool hit = board.shoot(target.first, target.second);
-            bool sunk = hit && board.wasShipSunkAt(target.first, target.second);
+            bool sunk = hit && board.lastSunk().any();
             shooter->notifyShotResult(target.first, target.second, hit, sunk, board);
             shots++;
         }
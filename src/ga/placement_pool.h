@@ -3,10 +3,12 @@
 #include <vector>
 #include <random>
 #include <memory>
+#include <array>
 #include "placement_chromosome.h"
 #include "../utils/rng.h"
 #include "../strategies/random_strategy.h"
 #include "../strategies/checkerboard_strategy.h"
+#include "../strategies/surrogate_model.h"
 #include "../simulator/game.h"
 #include <cmath>
 
@@ -97,8 +99,20 @@ public:
      */
     const std::vector<PlacementChromosome>& getRandomPlacements() const { return randomPlacements; }
 
+    /**
+     * @brief Маски клеток кораблей лучших расстановок (в порядке getBestPlacements)
+     */
+    const std::vector<BitMask128>& getBestMasks() const { return bestMasks; }
+
+    /**
+     * @brief Число лучших расстановок, занимающих каждую клетку
+     */
+    const std::array<int, BitMask128::CELLS>& getBestCellCounts() const { return bestCellCounts; }
+
 private:
     std::vector<PlacementChromosome> bestPlacements;  ///< Пул лучших расстановок
+    std::vector<BitMask128> bestMasks;                 ///< Индекс масок P_best
+    std::array<int, BitMask128::CELLS> bestCellCounts{}; ///< Расстановок P_best через клетку
     std::vector<PlacementChromosome> randomPlacements; ///< Пул случайных расстановок
     size_t bestPoolSize; ///< Размер пула лучших расстановок
     size_t randPoolSize; ///< Размер пула случайных расстановок
@@ -106,6 +120,59 @@ private:
     RNG rng;             ///< Генератор случайных чисел
 };
 
+/**
+ * @brief Живое подмножество P_best, согласованное с выстрелами партии
+ *
+ * Хранит маски расстановок, не противоречащих наблюдениям (промахи не на
+ * палубах, все попадания на палубах), и число таких расстановок через каждую
+ * клетку. Выстрел отбрасывает только противоречащие ему маски, поэтому доля
+ * расстановок для любой клетки - чтение таблицы, а стоимость хода не зависит
+ * от размера пула.
+ */
+class PlacementHeatIndex {
+public:
+    PlacementHeatIndex() = default;
+
+    explicit PlacementHeatIndex(const PlacementPool& pool) { reset(pool); }
+
+    /**
+     * @brief Начинает партию: в подмножестве все лучшие расстановки пула
+     */
+    void reset(const PlacementPool& pool);
+
+    /**
+     * @brief Учитывает выстрел (повторный выстрел по клетке игнорируется)
+     *
+     * @param idx Индекс клетки
+     * @param hit true, если попадание
+     */
+    void observe(int idx, bool hit);
+
+    /**
+     * @brief Число согласованных расстановок
+     */
+    size_t size() const { return m_live.size(); }
+
+    /**
+     * @brief Число согласованных расстановок, занимающих клетку
+     */
+    int count(int idx) const { return m_counts[idx]; }
+
+    /**
+     * @brief Доля согласованных расстановок, занимающих клетку
+     *
+     * @return Доля или 0.5, если согласованных расстановок нет
+     */
+    double heat(int idx) const {
+        return m_live.empty() ? 0.5 : static_cast<double>(m_counts[idx]) / m_live.size();
+    }
+
+private:
+    std::vector<BitMask128> m_live;               ///< Маски согласованных расстановок
+    std::array<int, BitMask128::CELLS> m_counts{}; ///< Согласованных расстановок через клетку
+    BitMask128 m_observed;                        ///< Обстрелянные клетки
+};
+
 /**
  * @brief Класс для тестирования расстановки против различных стрелков
  */
@@ -141,6 +208,15 @@ public:
      */
     double montecarlo(const PlacementChromosome& chromosome);
     
+    /**
+     * @brief Заменяет стрелка Монте-Карло быстрой моделью (отбор кандидатов)
+     *
+     * По умолчанию пул играет настоящим Монте-Карло; заменитель включает
+     * вызывающий код.
+     * @param surrogate Модель-заменитель или nullptr, чтобы вернуть настоящую выборку
+     */
+    void setSurrogate(std::shared_ptr<const SurrogateModel> surrogate) { m_surrogate = std::move(surrogate); }
+    
     /**
      * @brief Комплексная оценка хромосомы против всех стрелков с весами
      * @param chromosome Оцениваемая хромосома
@@ -153,5 +229,6 @@ private:
     int m_checkerGames;   // Количество игр для стратегии Checkerboard
     int m_mcGames;        // Количество игр для стратегии Monte-Carlo
     int m_mcIterations;   // Количество итераций для метода Монте-Карло
+    std::shared_ptr<const SurrogateModel> m_surrogate; // Модель вместо выборки Монте-Карло (nullptr - выборка)
     RNG m_rng;            // Генератор случайных чисел
 }; 
\ No newline at end of file
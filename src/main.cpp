@@ -4,10 +4,13 @@
 #include <iomanip>
 #include <algorithm>
 #include <numeric>
+#include <limits>
+#include <random>
 #include <chrono>
 #include <thread>     // Добавляем для функции sleep_for
 #include <sstream>
 #include <ctime>
+#include <cstdio>
 #include <locale.h>  // Для setlocale
 #include <sstream>   // Для stringstream
 #include <fstream>   // Для работы с файлами
@@ -20,11 +23,15 @@
 #include "strategies/random_strategy.h"
 #include "strategies/checkerboard_strategy.h"
 #include "strategies/monte_carlo_strategy.h"
+#include "strategies/opening_book.h"
+#include "strategies/fleet_corpus.h"
+#include "strategies/surrogate_strategy.h"
 #include "strategies/feature_based_strategy.h"
 #include "simulator/game.h"
 // Раскомментируем подключения GA
 #include "ga/placement_ga.h"
 #include "ga/decision_ga.h"
+#include "ga/decision_evaluator.h"
 #include "ga/fitness.h"
 #include "ga/placement_generator.h"
 
@@ -473,7 +480,7 @@ void testPlacementGA() {
     
     // Эволюционируем популяцию
     for (int gen = 1; gen <= maxGenerations; ++gen) {
-        auto bestChromosome = ga.evolvePopulation(fitnessFunction);
+        ga.evolvePopulation(fitnessFunction);
         
         // Выводим информацию о текущем поколении
         std::cout << "Поколение " << gen << ":" << std::endl;
@@ -519,7 +526,7 @@ void testPlacementDiversity() {
     // Генерируем и выводим расстановки для каждой стратегии
     std::cout << "=== Расстановки с углами ===" << std::endl;
     for (int i = 0; i < NUM_PLACEMENTS; ++i) {
-        std::vector<int> genes = PlacementChromosome::generateCornerPlacement(tempRng);
+        auto genes = PlacementChromosome::generateCornerPlacement(tempRng);
         PlacementChromosome chromosome(genes);
         auto fleet = chromosome.decodeFleet();
         
@@ -530,7 +537,7 @@ void testPlacementDiversity() {
     
     std::cout << "\n=== Расстановки по краям ===" << std::endl;
     for (int i = 0; i < NUM_PLACEMENTS; ++i) {
-        std::vector<int> genes = PlacementChromosome::generateEdgePlacement(tempRng);
+        auto genes = PlacementChromosome::generateEdgePlacement(tempRng);
         PlacementChromosome chromosome(genes);
         auto fleet = chromosome.decodeFleet();
         
@@ -541,7 +548,7 @@ void testPlacementDiversity() {
     
     std::cout << "\n=== Расстановки в центре ===" << std::endl;
     for (int i = 0; i < NUM_PLACEMENTS; ++i) {
-        std::vector<int> genes = PlacementChromosome::generateCenterPlacement(tempRng);
+        auto genes = PlacementChromosome::generateCenterPlacement(tempRng);
         PlacementChromosome chromosome(genes);
         auto fleet = chromosome.decodeFleet();
         
@@ -552,7 +559,7 @@ void testPlacementDiversity() {
     
     std::cout << "\n=== Смешанные расстановки ===" << std::endl;
     for (int i = 0; i < NUM_PLACEMENTS; ++i) {
-        std::vector<int> genes = PlacementChromosome::generateMixedPlacement(tempRng);
+        auto genes = PlacementChromosome::generateMixedPlacement(tempRng);
         PlacementChromosome chromosome(genes);
         auto fleet = chromosome.decodeFleet();
         
@@ -670,7 +677,1178 @@ void testPlacementGenerator() {
     std::cout << "В среднем " << (elapsed.count() / benchmarkSize) << " мс на расстановку" << std::endl;
 }
 
-void trainPlacement(const std::string& outFile, int customMaxGen = -1) {
+/**
+ * @brief Эталонное поле на сетке CellState (прежнее представление Board)
+ *
+ * Используется только в testBoardBenchmark для сравнения с битовыми масками:
+ * при попадании перебирает все корабли и их клетки через Ship::getCells().
+ */
+struct GridBoardReference {
+    std::array<std::array<CellState, Board::BOARD_SIZE>, Board::BOARD_SIZE> grid;
+    std::vector<Ship> ships;
+    int sunkShipCells = 0;
+    int totalShipCells = 0;
+
+    void placeFleet(const Fleet& fleet) {
+        for (auto& row : grid) row.fill(CellState::SEA);
+        ships.clear();
+        sunkShipCells = 0;
+        totalShipCells = 0;
+        for (const auto& ship : fleet.getShips()) {
+            for (const auto& cell : ship.getCells()) {
+                grid[cell.second][cell.first] = CellState::SHIP;
+            }
+            ships.push_back(ship);
+            totalShipCells += ship.getLength();
+        }
+    }
+
+    bool shoot(int x, int y) {
+        CellState& current = grid[y][x];
+        if (current != CellState::SHIP && current != CellState::SEA) return false;
+        if (current == CellState::SEA) {
+            current = CellState::MISS;
+            return false;
+        }
+        current = CellState::HIT;
+        sunkShipCells++;
+        for (const auto& ship : ships) {
+            auto cells = ship.getCells();
+            bool hitThisShip = std::find(cells.begin(), cells.end(), std::make_pair(x, y)) != cells.end();
+            if (hitThisShip) {
+                bool sunk = std::none_of(cells.begin(), cells.end(), [this](const std::pair<int, int>& c) {
+                    return grid[c.second][c.first] == CellState::SHIP;
+                });
+                if (sunk) {
+                    for (const auto& c : cells) grid[c.second][c.first] = CellState::SUNK;
+                }
+                break;
+            }
+        }
+        return true;
+    }
+
+    bool wasShipSunkAt(int x, int y) const { return grid[y][x] == CellState::SUNK; }
+    bool allShipsSunk() const { return totalShipCells > 0 && sunkShipCells >= totalShipCells; }
+};
+
+/**
+ * @brief Микробенчмарк Board: битовые маски против прежней сетки CellState
+ *
+ * Обе реализации проигрывают одинаковые партии (одни и те же флоты и порядок
+ * выстрелов), результаты сверяются, затем сравнивается время.
+ */
+void testBoardBenchmark() {
+    std::cout << "\n===== Бенчмарк Board: битовые маски против сетки =====\n" << std::endl;
+
+    const int gamesCount = 20000;
+    RNG rng;
+
+    // Заранее готовим флоты и порядок выстрелов, чтобы измерять только игру
+    std::vector<Fleet> fleets;
+    std::vector<std::array<uint8_t, 100>> orders;
+    fleets.reserve(gamesCount);
+    orders.reserve(gamesCount);
+    std::mt19937 shuffleEngine(12345);
+    for (int g = 0; g < gamesCount; ++g) {
+        Fleet fleet;
+        while (!fleet.createStandardFleet(rng)) {}
+        fleets.push_back(fleet);
+        std::array<uint8_t, 100> order;
+        std::iota(order.begin(), order.end(), 0);
+        std::shuffle(order.begin(), order.end(), shuffleEngine);
+        orders.push_back(order);
+    }
+
+    // Прогон одной реализации: суммарное число выстрелов, попаданий и потоплений
+    auto run = [&](auto& board, long long& shots, long long& hits, long long& sunkEvents) {
+        shots = hits = sunkEvents = 0;
+        auto start = std::chrono::high_resolution_clock::now();
+        for (int g = 0; g < gamesCount; ++g) {
+            board.placeFleet(fleets[g]);
+            for (uint8_t idx : orders[g]) {
+                int x = idx % 10, y = idx / 10;
+                ++shots;
+                if (board.shoot(x, y)) {
+                    ++hits;
+                    if (board.wasShipSunkAt(x, y)) ++sunkEvents;
+                }
+                if (board.allShipsSunk()) break;
+            }
+        }
+        auto end = std::chrono::high_resolution_clock::now();
+        return std::chrono::duration<double, std::milli>(end - start).count();
+    };
+
+    Board bitBoard;
+    GridBoardReference gridBoard;
+    long long bitShots, bitHits, bitSunk, gridShots, gridHits, gridSunk;
+    double bitMs = run(bitBoard, bitShots, bitHits, bitSunk);
+    double gridMs = run(gridBoard, gridShots, gridHits, gridSunk);
+
+    bool same = bitShots == gridShots && bitHits == gridHits && bitSunk == gridSunk;
+    std::cout << "Партий: " << gamesCount << ", выстрелов: " << bitShots
+              << ", попаданий: " << bitHits << ", потоплений: " << bitSunk << std::endl;
+    std::cout << "Результаты совпадают: " << (same ? "Да" : "Нет") << std::endl;
+    std::cout << std::fixed << std::setprecision(2);
+    std::cout << "Сетка CellState:  " << gridMs << " мс ("
+              << (gridShots / gridMs / 1000.0) << " млн выстрелов/с)" << std::endl;
+    std::cout << "Битовые маски:    " << bitMs << " мс ("
+              << (bitShots / bitMs / 1000.0) << " млн выстрелов/с)" << std::endl;
+    std::cout << "Ускорение: " << (gridMs / bitMs) << "x" << std::endl;
+}
+
+/**
+ * @brief Бенчмарк оценки клеток FeatureBasedStrategy
+ *
+ * Сравнивает прежний путь (объект Features и скалярное произведение на каждую
+ * клетку) с плоскостями признаков и ядрами взвешенной суммы (скалярным и AVX2)
+ * на одних и тех же позициях и весах, а в целых партиях - пересчет с нуля с
+ * FeatureTracker и полную сумму признаков с FeatureScorer. Шум RandNoise отключен нулевым весом, чтобы выборы разных
+ * путей можно было сверить.
+ */
+void testFeatureBenchmark() {
+    std::cout << "\n===== Бенчмарк признаков FeatureBasedStrategy =====\n" << std::endl;
+
+    const int positionsCount = 2000;
+    const int weightsCount = 50;
+    const int referenceMoves = 2000;
+    const int kernelRepeats = 20;
+    RNG rng;
+
+    // Позиции: случайные флоты, обстрелянные в случайном порядке на случайную глубину
+    struct Position {
+        Board board;
+        std::vector<std::pair<Cell, ShotResult>> history;
+    };
+    std::vector<Position> positions(positionsCount);
+    std::mt19937 engine(12345);
+    for (Position& position : positions) {
+        Fleet fleet;
+        while (!fleet.createStandardFleet(rng)) {}
+        position.board.placeFleet(fleet);
+        std::array<int, 100> order;
+        std::iota(order.begin(), order.end(), 0);
+        std::shuffle(order.begin(), order.end(), engine);
+        const int depth = std::uniform_int_distribution<int>(0, 60)(engine);
+        for (int i = 0; i < depth && !position.board.allShipsSunk(); ++i) {
+            const int x = order[i] % 10, y = order[i] / 10;
+            const bool hit = position.board.shoot(x, y);
+            const bool sunk = hit && position.board.wasShipSunkAt(x, y);
+            position.history.push_back({Cell{x, y}, hit ? (sunk ? ShotResult::KILL : ShotResult::HIT) : ShotResult::MISS});
+        }
+    }
+
+    std::vector<std::vector<double>> weightSets(weightsCount);
+    std::uniform_real_distribution<double> weightDist(-1.0, 1.0);
+    for (auto& weights : weightSets) {
+        weights.resize(Features::FEATURE_COUNT);
+        for (double& w : weights) w = weightDist(engine);
+        weights[18] = 0.0; // RandNoise
+    }
+
+    const PlacementPool pool;
+    const PlacementHeatIndex heat(pool);
+
+    // Прежний путь: Features и скалярное произведение по каждой клетке
+    std::vector<int> referencePicks(referenceMoves);
+    auto start = std::chrono::high_resolution_clock::now();
+    for (int m = 0; m < referenceMoves; ++m) {
+        const Position& position = positions[m % positionsCount];
+        const auto& weights = weightSets[m % weightsCount];
+        Features features(position.board, position.history, pool, 0);
+        double bestScore = -std::numeric_limits<double>::max();
+        int best = -1;
+        for (int idx = 0; idx < 100; ++idx) {
+            if (position.board.isShot(idx % 10, idx / 10)) continue;
+            auto values = features.getFeatures(Cell{idx % 10, idx / 10});
+            double score = 0.0;
+            for (size_t f = 0; f < values.size(); ++f) score += values[f] * weights[f];
+            if (score > bestScore) {
+                bestScore = score;
+                best = idx;
+            }
+        }
+        referencePicks[m] = best;
+    }
+    double referenceMs = std::chrono::duration<double, std::milli>(
+        std::chrono::high_resolution_clock::now() - start).count();
+
+    // Плоскости признаков + ядро: полный ход
+    std::vector<FeaturePlanes::Weights> planeWeights;
+    for (const auto& weights : weightSets) planeWeights.push_back(FeaturePlanes::toWeights(weights));
+    FeaturePlanes planes;
+    auto runMoves = [&](FeaturePlanes::Kernel kernel, std::vector<int>& picks) {
+        picks.assign(referenceMoves, -1);
+        auto begin = std::chrono::high_resolution_clock::now();
+        for (int m = 0; m < referenceMoves; ++m) {
+            const Position& position = positions[m % positionsCount];
+            const BitMask128 available = ~position.board.shotMask();
+            planes.compute(position.board, position.history, heat, 0, available);
+            float bestScore;
+            picks[m] = planes.argmax(planeWeights[m % weightsCount], available, bestScore, kernel);
+        }
+        return std::chrono::duration<double, std::milli>(
+            std::chrono::high_resolution_clock::now() - begin).count();
+    };
+    std::vector<int> scalarPicks, avxPicks;
+    double scalarMovesMs = runMoves(FeaturePlanes::Kernel::SCALAR, scalarPicks);
+    double avxMovesMs = runMoves(FeaturePlanes::Kernel::AVX2, avxPicks);
+
+    // Партии целиком: пересчет с нуля по истории против FeatureTracker,
+    // стоимость хода отдельно для начала (до 20 выстрелов) и конца партии (от 60)
+    const int gamesCount = 200;
+    const int earlyMoves = 20, lateMoves = 60;
+    double scratchMs[2] = {0.0, 0.0}, trackerMs[2] = {0.0, 0.0};
+    int phaseMoves[2] = {0, 0};
+    int trackerMismatches = 0;
+    FeatureTracker tracker;
+    FeaturePlanes scratchPlanes;
+
+    // Специализированная оценка (FeatureScorer) против полной суммы 20 признаков:
+    // на тех же весах и на разреженных, где половина весов обнулена
+    std::vector<FeaturePlanes::Weights> sparseWeights;
+    std::vector<FeatureScorer> denseScorers, sparseScorers;
+    std::bernoulli_distribution dropWeight(0.5);
+    for (const auto& weights : weightSets) {
+        std::vector<double> sparse = weights;
+        for (double& w : sparse) {
+            if (dropWeight(engine)) w = 0.0;
+        }
+        sparseWeights.push_back(FeaturePlanes::toWeights(sparse));
+        denseScorers.emplace_back(weights);
+        sparseScorers.emplace_back(sparse);
+    }
+    double fullMoveMs[2] = {0.0, 0.0}, scorerMoveMs[2] = {0.0, 0.0};
+    size_t scorerFeatures[2] = {0, 0};
+    int scorerMismatches[2] = {0, 0};
+    int gameMoves = 0;
+    FeaturePlanes scorerPlanes;
+    for (int g = 0; g < gamesCount; ++g) {
+        Board board;
+        Fleet fleet;
+        while (!fleet.createStandardFleet(rng)) {}
+        board.placeFleet(fleet);
+        std::array<int, 100> order;
+        std::iota(order.begin(), order.end(), 0);
+        std::shuffle(order.begin(), order.end(), engine);
+        std::vector<std::pair<Cell, ShotResult>> history;
+        tracker.reset(board.shipMask());
+        for (int i = 0; i < 100 && !board.allShipsSunk(); ++i) {
+            const BitMask128 available = ~board.shotMask();
+            const int phase = i < earlyMoves ? 0 : (i >= lateMoves ? 1 : -1);
+
+            auto begin = std::chrono::high_resolution_clock::now();
+            scratchPlanes.compute(board, history, heat, 0, available);
+            auto middle = std::chrono::high_resolution_clock::now();
+            planes.compute(tracker, heat, 0, available);
+            auto end = std::chrono::high_resolution_clock::now();
+            if (phase >= 0) {
+                scratchMs[phase] += std::chrono::duration<double, std::milli>(middle - begin).count();
+                trackerMs[phase] += std::chrono::duration<double, std::milli>(end - middle).count();
+                ++phaseMoves[phase];
+            }
+            float scratchBest, trackerBest;
+            const auto& weights = planeWeights[g % weightsCount];
+            trackerMismatches += scratchPlanes.argmax(weights, available, scratchBest)
+                              != planes.argmax(weights, available, trackerBest);
+
+            for (int sparse = 0; sparse < 2; ++sparse) {
+                const auto& fullWeights = (sparse ? sparseWeights : planeWeights)[g % weightsCount];
+                const FeatureScorer& scorer = (sparse ? sparseScorers : denseScorers)[g % weightsCount];
+                float fullBest, scorerBest;
+                auto moveBegin = std::chrono::high_resolution_clock::now();
+                planes.compute(tracker, heat, i, available);
+                const int fullPick = planes.argmax(fullWeights, available, fullBest);
+                auto moveMiddle = std::chrono::high_resolution_clock::now();
+                scorerPlanes.compute(tracker, heat, i, available, scorer.features());
+                const int scorerPick = scorer.argmax(scorerPlanes, i, available, scorerBest);
+                auto moveEnd = std::chrono::high_resolution_clock::now();
+                fullMoveMs[sparse] += std::chrono::duration<double, std::milli>(moveMiddle - moveBegin).count();
+                scorerMoveMs[sparse] += std::chrono::duration<double, std::milli>(moveEnd - moveMiddle).count();
+                scorerFeatures[sparse] += scorer.activeCount();
+                scorerMismatches[sparse] += fullPick != scorerPick;
+            }
+            ++gameMoves;
+
+            const int x = order[i] % 10, y = order[i] / 10;
+            const bool hit = board.shoot(x, y);
+            const bool sunk = hit && board.wasShipSunkAt(x, y);
+            const ShotResult result = hit ? (sunk ? ShotResult::KILL : ShotResult::HIT) : ShotResult::MISS;
+            history.push_back({Cell{x, y}, result});
+            tracker.observe(x, y, result);
+        }
+    }
+
+    // Только ядро: плоскости посчитаны заранее, оцениваются все наборы весов
+    std::vector<FeaturePlanes> precomputed(positionsCount / 10);
+    for (size_t p = 0; p < precomputed.size(); ++p) {
+        precomputed[p].compute(positions[p].board, positions[p].history, heat, 0, ~positions[p].board.shotMask());
+    }
+    auto runKernel = [&](FeaturePlanes::Kernel kernel, long long& checksum) {
+        checksum = 0;
+        auto begin = std::chrono::high_resolution_clock::now();
+        for (int r = 0; r < kernelRepeats; ++r) {
+            for (size_t p = 0; p < precomputed.size(); ++p) {
+                const BitMask128 available = ~positions[p].board.shotMask();
+                for (const auto& weights : planeWeights) {
+                    float bestScore;
+                    checksum += precomputed[p].argmax(weights, available, bestScore, kernel);
+                }
+            }
+        }
+        return std::chrono::duration<double, std::milli>(
+            std::chrono::high_resolution_clock::now() - begin).count();
+    };
+    long long scalarSum, avxSum;
+    double scalarKernelMs = runKernel(FeaturePlanes::Kernel::SCALAR, scalarSum);
+    double avxKernelMs = runKernel(FeaturePlanes::Kernel::AVX2, avxSum);
+    const double kernelCalls = static_cast<double>(kernelRepeats) * precomputed.size() * weightsCount;
+
+    int sameAsReference = 0, sameKernels = 0;
+    for (int m = 0; m < referenceMoves; ++m) {
+        sameAsReference += scalarPicks[m] == referencePicks[m];
+        sameKernels += scalarPicks[m] == avxPicks[m];
+    }
+
+    std::cout << "Позиций: " << positionsCount << ", наборов весов: " << weightsCount
+              << ", AVX2: " << (FeaturePlanes::hasAvx2() ? "есть" : "нет (используется скалярное ядро)") << std::endl;
+    std::cout << std::fixed << std::setprecision(1);
+    std::cout << "Ход целиком (признаки + выбор клетки), ходов/с:" << std::endl;
+    std::cout << "  Features по клеткам (double): " << referenceMoves / referenceMs * 1000.0 << std::endl;
+    std::cout << "  Плоскости + скалярное ядро:   " << referenceMoves / scalarMovesMs * 1000.0
+              << " (" << referenceMs / scalarMovesMs << "x)" << std::endl;
+    std::cout << "  Плоскости + AVX2:             " << referenceMoves / avxMovesMs * 1000.0
+              << " (" << referenceMs / avxMovesMs << "x)" << std::endl;
+    std::cout << "Только взвешенная сумма и argmax, млн оценок/с:" << std::endl;
+    std::cout << "  Скалярное ядро: " << kernelCalls / scalarKernelMs / 1000.0 << std::endl;
+    std::cout << "  AVX2:           " << kernelCalls / avxKernelMs / 1000.0
+              << " (" << scalarKernelMs / avxKernelMs << "x)" << std::endl;
+    std::cout << "Выбор совпал с прежним путем: " << sameAsReference << " из " << referenceMoves
+              << " (расхождения - округление float при почти равных оценках)" << std::endl;
+    std::cout << "Ядра совпали: " << sameKernels << " из " << referenceMoves
+              << (scalarSum == avxSum ? ", контрольные суммы равны" : ", контрольные суммы различаются") << std::endl;
+    std::cout << "Признаки за ход в партии (" << gamesCount << " партий), мкс:" << std::endl;
+    const char* phaseNames[2] = {"  Первые 20 выстрелов: ", "  После 60 выстрелов:  "};
+    for (int phase = 0; phase < 2; ++phase) {
+        const double scratchUs = scratchMs[phase] * 1000.0 / std::max(phaseMoves[phase], 1);
+        const double trackerUs = trackerMs[phase] * 1000.0 / std::max(phaseMoves[phase], 1);
+        std::cout << phaseNames[phase] << "с нуля " << scratchUs << ", FeatureTracker " << trackerUs
+                  << " (" << scratchUs / trackerUs << "x)" << std::endl;
+    }
+    std::cout << "Выбор FeatureTracker и пересчета с нуля различается: " << trackerMismatches << " раз" << std::endl;
+    std::cout << "Ход в партии с FeatureTracker, мкс (полная сумма -> FeatureScorer, epsilon "
+              << std::defaultfloat << FeatureScorer::DEFAULT_EPSILON << std::fixed << "):" << std::endl;
+    const char* weightNames[2] = {"  Все веса:             ", "  Половина весов равна 0: "};
+    for (int sparse = 0; sparse < 2; ++sparse) {
+        const double fullUs = fullMoveMs[sparse] * 1000.0 / gameMoves;
+        const double scorerUs = scorerMoveMs[sparse] * 1000.0 / gameMoves;
+        std::cout << weightNames[sparse] << fullUs << " -> " << scorerUs << " (" << fullUs / scorerUs
+                  << "x), признаков в сумме: " << static_cast<double>(scorerFeatures[sparse]) / gameMoves
+                  << ", выбор различается: " << scorerMismatches[sparse] << " из " << gameMoves << std::endl;
+    }
+}
+
+/**
+ * @brief Бенчмарк оценки поколения DecisionGA: по одной хромосоме против lockstep
+ *
+ * Запускает DecisionGA на пуле из trainDecision. Каждое поколение оценивается
+ * обоими способами: копии хромосом - по одной (FeatureBasedStrategy), сами
+ * хромосомы - в режиме lockstep, по которому идет эволюция. Отладочный вывод
+ * стратегии в std::cerr на время оценки по одной отключается, чтобы сравнивать
+ * только вычисления. Отдельно проверяется, что при нулевом весе RandNoise оба
+ * способа дают одинаковое число выстрелов.
+ */
+void testLockstepBenchmark() {
+    std::cout << "\n===== Бенчмарк оценки поколения DecisionGA (lockstep) =====\n" << std::endl;
+
+    const int populationSize = 150;
+    const int generations = 5;
+
+    // Пул как в trainDecision без файла расстановок
+    PlacementPool pool;
+    PlacementGenerator generator(50);
+    RNG rng;
+    for (Bias bias : {Bias::RANDOM, Bias::EDGE, Bias::CORNER, Bias::CENTER}) {
+        for (int i = 0; i < 12; ++i) {
+            pool.addPlacement(generator.generate(bias, rng));
+        }
+    }
+
+    DecisionEvaluator evaluator;
+    double sequentialMs = 0.0, lockstepMs = 0.0;
+    std::vector<DecisionChromosome> firstGeneration;
+    DecisionGA dga(populationSize, 0.8, 0.2, 3, 3, 0.2, 0.01, 5.0);
+    dga.setPopulationFitness([&](const std::vector<DecisionChromosome*>& chromosomes, const PlacementPool& pool) {
+        std::vector<DecisionChromosome> copies;
+        for (const DecisionChromosome* chromosome : chromosomes) copies.push_back(*chromosome);
+        if (firstGeneration.empty()) firstGeneration = copies;
+
+        std::streambuf* log = std::cerr.rdbuf(nullptr);
+        auto start = std::chrono::high_resolution_clock::now();
+        for (DecisionChromosome& copy : copies) evaluator.evaluate(copy, pool);
+        auto middle = std::chrono::high_resolution_clock::now();
+        std::cerr.rdbuf(log);
+        evaluator.evaluateLockstep(chromosomes, pool);
+        auto end = std::chrono::high_resolution_clock::now();
+        sequentialMs = std::chrono::duration<double, std::milli>(middle - start).count();
+        lockstepMs = std::chrono::duration<double, std::milli>(end - middle).count();
+    });
+    auto unused = [](DecisionChromosome&, const PlacementPool&) {};
+
+    std::cout << "Популяция: " << populationSize << ", расстановок на хромосому: "
+              << std::min<size_t>(DecisionEvaluator::DEFAULT_TRIALS, pool.size()) << std::endl;
+    std::cout << std::fixed;
+    double totalSequential = 0.0, totalLockstep = 0.0;
+    for (int gen = 0; gen <= generations; ++gen) {
+        evaluator.resetStats();
+        auto start = std::chrono::high_resolution_clock::now();
+        if (gen == 0) {
+            dga.initialize(unused, pool);
+        } else {
+            dga.evolveOneGeneration(unused, pool);
+        }
+        // Поколение целиком в режиме lockstep и то же поколение с оценкой по одной
+        const double generationMs = std::chrono::duration<double, std::milli>(
+            std::chrono::high_resolution_clock::now() - start).count() - sequentialMs;
+        const double sequentialGenerationMs = generationMs - lockstepMs + sequentialMs;
+        totalSequential += sequentialGenerationMs;
+        totalLockstep += generationMs;
+        std::cout << "Поколение " << gen << ": общие плоскости " << std::setprecision(1)
+                  << evaluator.stats().hitRate() * 100.0 << "% ходов, поколение "
+                  << std::setprecision(0) << sequentialGenerationMs << " мс -> " << generationMs << " мс ("
+                  << std::setprecision(2) << sequentialGenerationMs / generationMs << "x), лучший фитнес "
+                  << std::setprecision(1) << dga.getBestChromosome().getFitness() << std::endl;
+    }
+    std::cout << "Всего: " << std::setprecision(0) << totalSequential << " мс -> " << totalLockstep << " мс ("
+              << std::setprecision(2) << totalSequential / totalLockstep << "x)" << std::endl;
+
+    // Проверка: без шума оба способа играют одинаково
+    std::vector<DecisionChromosome> sequential = firstGeneration;
+    for (DecisionChromosome& chromosome : sequential) {
+        std::vector<double> genes = chromosome.getGenes();
+        genes[18] = 0.0; // RandNoise
+        chromosome.setGenes(genes);
+    }
+    std::vector<DecisionChromosome> lockstep = sequential;
+    std::vector<DecisionChromosome*> pointers;
+    for (DecisionChromosome& chromosome : lockstep) pointers.push_back(&chromosome);
+    std::streambuf* log = std::cerr.rdbuf(nullptr);
+    for (DecisionChromosome& chromosome : sequential) evaluator.evaluate(chromosome, pool);
+    std::cerr.rdbuf(log);
+    evaluator.evaluateLockstep(pointers, pool);
+    int same = 0;
+    for (size_t i = 0; i < sequential.size(); ++i) {
+        same += sequential[i].getMeanShots() == lockstep[i].getMeanShots()
+             && sequential[i].getStdDevShots() == lockstep[i].getStdDevShots();
+    }
+    std::cout << "Без RandNoise результаты совпали у " << same << " из " << sequential.size() << " хромосом" << std::endl;
+}
+
+/**
+ * @brief Записывает дебютную книгу стратегии Монте-Карло в памяти
+ *
+ * Играет партии против случайных флотов стратегией с большой выборкой и
+ * книгой в режиме записи: карта каждой ранней позиции без раненых кораблей
+ * считается один раз, а затем берется из книги, поэтому все партии идут
+ * по одной и той же ветке промахов.
+ *
+ * @param depth Наибольшее число выстрелов в позициях книги
+ * @param samples Образцов на карту
+ * @param games Число партий
+ * @param rng Генератор случайных чисел
+ * @return Книга в режиме записи
+ */
+std::shared_ptr<OpeningBook> recordOpeningBook(int depth, int samples, int games, RNG& rng) {
+    auto book = std::make_shared<OpeningBook>(depth, samples);
+    MonteCarloStrategy strategy(rng, samples);
+    strategy.setThreads(0);
+    strategy.setOpeningBook(book);
+
+    for (int g = 0; g < games; ++g) {
+        Fleet fleet;
+        while (!fleet.createStandardFleet(rng)) {}
+        Board board;
+        board.placeFleet(fleet);
+        strategy.reset();
+        // Позиции глубже книги не нужны: партия прерывается
+        for (int shots = 0; shots < depth && !board.allShipsSunk(); ++shots) {
+            auto target = strategy.getNextShot(board);
+            if (target.first == -1) break;
+            bool hit = board.shoot(target.first, target.second);
+            bool sunk = hit && board.wasShipSunkAt(target.first, target.second);
+            strategy.notifyShotResult(target.first, target.second, hit, sunk, board);
+        }
+    }
+    return book;
+}
+
+/**
+ * @brief Строит дебютную книгу и сохраняет ее в файл
+ *
+ * В файл попадают позиции, встреченные хотя бы дважды (самые частые).
+ *
+ * @param outFile Файл книги
+ * @param depth Наибольшее число выстрелов в позициях книги
+ * @param samples Образцов на карту
+ * @param games Число партий
+ */
+void buildOpeningBook(const std::string& outFile, int depth, int samples, int games) {
+    std::cout << "\n===== Построение дебютной книги Монте-Карло =====\n" << std::endl;
+    std::cout << "Глубина: " << depth << ", образцов на карту: " << samples
+              << ", партий: " << games << std::endl;
+
+    RNG rng;
+    auto start = std::chrono::high_resolution_clock::now();
+    auto book = recordOpeningBook(depth, samples, games, rng);
+    auto end = std::chrono::high_resolution_clock::now();
+
+    book->save(outFile, games > 1 ? 2 : 1);
+    auto saved = OpeningBook::load(outFile);
+    std::cout << "Посчитано карт: " << book->size() << " за "
+              << std::chrono::duration<double>(end - start).count() << " с" << std::endl;
+    std::cout << "Сохранено позиций: " << (saved ? saved->size() : 0) << " ("
+              << (saved ? saved->bytes() : 0) << " байт) в " << outFile << std::endl;
+}
+
+/**
+ * @brief Генерирует маски расстановок для корпуса Монте-Карло
+ *
+ * Расстановки строит PlacementGenerator без смещения к краям или центру.
+ */
+std::vector<BitMask128> generateFleetCorpus(size_t count, RNG& rng) {
+    PlacementGenerator generator(50);
+    std::vector<BitMask128> fleets;
+    fleets.reserve(count);
+    while (fleets.size() < count) {
+        PlacementChromosome chromosome = generator.generate(Bias::RANDOM, rng);
+        if (chromosome.isValid()) {
+            fleets.push_back(chromosome.occupancyMask());
+        }
+    }
+    return fleets;
+}
+
+/**
+ * @brief Строит корпус расстановок и сохраняет его в файл
+ *
+ * @param outFile Файл корпуса
+ * @param count Количество расстановок
+ */
+void buildFleetCorpus(const std::string& outFile, size_t count) {
+    std::cout << "\n===== Построение корпуса расстановок Монте-Карло =====\n" << std::endl;
+    std::cout << "Расстановок: " << count << std::endl;
+
+    RNG rng;
+    auto start = std::chrono::high_resolution_clock::now();
+    FleetCorpus corpus(generateFleetCorpus(count, rng));
+    auto end = std::chrono::high_resolution_clock::now();
+
+    corpus.save(outFile);
+    auto saved = FleetCorpus::load(outFile);
+    std::cout << "Сгенерировано за " << std::chrono::duration<double>(end - start).count() << " с" << std::endl;
+    std::cout << "Сохранено расстановок: " << (saved ? saved->size() : 0) << " ("
+              << (saved ? saved->bytes() : 0) << " байт) в " << outFile << std::endl;
+}
+
+/**
+ * @brief Записывает пары "наблюдение - карта" из партий стратегии Монте-Карло
+ *
+ * Пара записывается на каждом ходу, где стратегия строила карту (ходы из
+ * очереди добивания карту не строят).
+ *
+ * @param games Число партий
+ * @param samples Образцов на карту
+ * @param rng Генератор случайных чисел
+ */
+std::vector<SurrogateModel::Sample> recordSurrogateSamples(int games, int samples, RNG& rng) {
+    auto builds = [](const HeatmapStats& stats) {
+        return stats.sampled + stats.exact + stats.target + stats.chain +
+               stats.book + stats.table + stats.library + stats.surrogate;
+    };
+
+    std::vector<SurrogateModel::Sample> result;
+    MonteCarloStrategy strategy(rng, samples);
+    for (int g = 0; g < games; ++g) {
+        Fleet fleet;
+        while (!fleet.createStandardFleet(rng)) {}
+        Board board;
+        board.placeFleet(fleet);
+        strategy.reset();
+        RemainingFleet remaining;
+        for (int shots = 0; shots < 100 && !board.allShipsSunk(); ++shots) {
+            SurrogateModel::Sample sample;
+            sample.obs = SurrogateModel::Observation::from(board, remaining);
+            const long long before = builds(strategy.getHeatmapStats());
+            auto target = strategy.getNextShot(board);
+            if (target.first == -1) break;
+            if (builds(strategy.getHeatmapStats()) > before) {
+                sample.heat = strategy.getHeatmap();
+                result.push_back(sample);
+            }
+            bool hit = board.shoot(target.first, target.second);
+            bool sunk = hit && board.lastSunk().any();
+            strategy.notifyShotResult(target.first, target.second, hit, sunk, board);
+            remaining.update(board.lastSunk());
+        }
+    }
+    return result;
+}
+
+/**
+ * @brief Обучает модель-заменитель стратегии Монте-Карло и сохраняет ее в файл
+ *
+ * Пятая часть партий откладывается для проверки: на отложенных позициях
+ * сравнивается выбор модели и настоящей стратегии, затем на тех же флотах
+ * сравниваются целые партии (число выстрелов и время).
+ *
+ * @param outFile Файл модели
+ * @param games Число партий
+ * @param samples Образцов на карту у обучающей стратегии
+ */
+void buildSurrogate(const std::string& outFile, int games, int samples) {
+    std::cout << "\n===== Обучение заменителя Монте-Карло =====\n" << std::endl;
+    std::cout << "Партий: " << games << ", образцов на карту: " << samples << std::endl;
+
+    RNG rng;
+    const int heldOutGames = std::max(1, games / 5);
+    auto start = std::chrono::high_resolution_clock::now();
+    auto train = recordSurrogateSamples(std::max(1, games - heldOutGames), samples, rng);
+    auto heldOut = recordSurrogateSamples(heldOutGames, samples, rng);
+    auto end = std::chrono::high_resolution_clock::now();
+    std::cout << "Записано позиций: " << train.size() << " для обучения, " << heldOut.size()
+              << " для проверки за " << std::chrono::duration<double>(end - start).count() << " с" << std::endl;
+
+    SurrogateModel model = SurrogateModel::fit(train);
+    model.save(outFile);
+    auto saved = SurrogateModel::load(outFile);
+    std::cout << "Веса сохранены в " << outFile << (saved ? "" : " (ОШИБКА ЧТЕНИЯ)") << std::endl;
+
+    auto report = [](const char* label, const SurrogateModel::Agreement& agreement) {
+        std::cout << label << "выбор совпал с МК в " << (100.0 * agreement.top1)
+                  << "% позиций, доля максимума карты МК " << (100.0 * agreement.heatRatio)
+                  << "% (" << agreement.states << " позиций)" << std::endl;
+    };
+    std::cout << std::fixed << std::setprecision(1);
+    report("Без обучения: ", SurrogateModel().agreement(heldOut));
+    report("Обучение:     ", model.agreement(train));
+    report("Проверка:     ", model.agreement(heldOut));
+
+    // Целые партии на одних и тех же флотах: настоящая стратегия против заменителя
+    std::vector<Fleet> fleets(heldOutGames);
+    for (Fleet& fleet : fleets) {
+        while (!fleet.createStandardFleet(rng)) {}
+    }
+    auto playGames = [&](MonteCarloStrategy& strategy, double& ms) {
+        long long totalShots = 0;
+        auto gamesStart = std::chrono::high_resolution_clock::now();
+        for (const Fleet& fleet : fleets) {
+            Board board;
+            board.placeFleet(fleet);
+            strategy.reset();
+            for (int shots = 0; shots < 100 && !board.allShipsSunk(); ++shots) {
+                auto target = strategy.getNextShot(board);
+                if (target.first == -1) break;
+                bool hit = board.shoot(target.first, target.second);
+                bool sunk = hit && board.lastSunk().any();
+                strategy.notifyShotResult(target.first, target.second, hit, sunk, board);
+                ++totalShots;
+            }
+        }
+        ms = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - gamesStart).count();
+        return static_cast<double>(totalShots) / fleets.size();
+    };
+    MonteCarloStrategy real(rng, samples);
+    SurrogateStrategy surrogate(rng, std::make_shared<SurrogateModel>(model));
+    double realMs = 0.0, surrogateMs = 0.0;
+    double realShots = playGames(real, realMs);
+    double surrogateShots = playGames(surrogate, surrogateMs);
+    std::cout << std::setprecision(2);
+    std::cout << "Партии МК:         " << realShots << " выстрелов, " << (realMs / fleets.size()) << " мс/партия" << std::endl;
+    std::cout << "Партии заменителя: " << surrogateShots << " выстрелов, " << (surrogateMs / fleets.size()) << " мс/партия" << std::endl;
+    std::cout << "Ускорение: " << (realMs / std::max(surrogateMs, 1e-9)) << "x" << std::endl;
+}
+
+/**
+ * @brief Бенчмарк стратегии Монте-Карло
+ *
+ * Сравнивает на одних и тех же флотах: генератор расстановок с отказами
+ * против табличного, инкремент тепловой карты по клеткам против побитово-срезанных
+ * счетчиков, пересчет выборки на каждом ходу против фильтра частиц,
+ * независимую выборку против цепи Маркова, карты из дебютной книги и общей таблицы
+ * карт против выборки, фильтр корпуса расстановок против генерации,
+ * полную выборку против досрочной остановки,
+ * последовательную выборку против параллельной.
+ */
+void testMonteCarloBenchmark() {
+    std::cout << "\n===== Бенчмарк Монте-Карло =====\n" << std::endl;
+    // Разделы сравнивают генераторы выборки: дебютная книга, таблица карт
+    // и корпус расстановок по умолчанию отключаются
+    MonteCarloStrategy::setDefaultOpeningBook(nullptr);
+    MonteCarloStrategy::setDefaultTranspositionTable(nullptr);
+    MonteCarloStrategy::setDefaultFleetCorpus(nullptr);
+
+    const int gamesCount = 30;
+    const int samples = 1000;
+    RNG rng;
+
+    std::vector<Fleet> fleets;
+    fleets.reserve(gamesCount);
+    for (int g = 0; g < gamesCount; ++g) {
+        Fleet fleet;
+        while (!fleet.createStandardFleet(rng)) {}
+        fleets.push_back(fleet);
+    }
+
+    // Играет первые games партий; возвращает число выстрелов, trace - хеш их последовательности.
+    // byCells - флот ставится по клеткам, как в ShooterPool (попадания не приводят к потоплению)
+    double worstMoveMs = 0.0; // Самое долгое построение карты в последнем вызове playGames
+    auto playGames = [&](MonteCarloStrategy& strategy, int games, uint64_t& trace, bool byCells = false) {
+        long long totalShots = 0;
+        trace = 0;
+        worstMoveMs = 0.0;
+        for (int g = 0; g < games; ++g) {
+            Board board;
+            if (byCells) {
+                for (const auto& ship : fleets[g].getShips()) {
+                    for (const auto& cell : ship.getCells()) {
+                        board.placeShip(cell.first, cell.second);
+                    }
+                }
+            } else {
+                board.placeFleet(fleets[g]);
+            }
+            strategy.reset();
+            int shots = 0;
+            while (!board.allShipsSunk() && shots < 100) {
+                auto target = strategy.getNextShot(board);
+                if (target.first == -1) break;
+                bool hit = board.shoot(target.first, target.second);
+                bool sunk = hit && board.wasShipSunkAt(target.first, target.second);
+                strategy.notifyShotResult(target.first, target.second, hit, sunk, board);
+                worstMoveMs = std::max(worstMoveMs, strategy.getLastMoveStats().ms);
+                trace = trace * 31 + target.second * 10 + target.first;
+                ++shots;
+            }
+            totalShots += shots;
+        }
+        return totalShots;
+    };
+
+    auto elapsedMs = [](std::chrono::high_resolution_clock::time_point start) {
+        auto end = std::chrono::high_resolution_clock::now();
+        return std::chrono::duration<double, std::milli>(end - start).count();
+    };
+
+    std::cout << std::fixed << std::setprecision(2);
+    std::cout << "Партий: " << gamesCount << ", образцов: " << samples << std::endl;
+
+    // Генератор расстановок: доля принятых флотов и позиций, скорость выборки
+    auto runSampler = [&](MonteCarloStrategy::Sampler sampler, const char* label) {
+        MonteCarloStrategy strategy(rng, samples);
+        strategy.setSampler(sampler);
+        strategy.setExact(false);
+        strategy.setStopping(0.0);
+        uint64_t trace;
+        auto start = std::chrono::high_resolution_clock::now();
+        long long totalShots = playGames(strategy, gamesCount, trace);
+        double ms = elapsedMs(start);
+        const SamplerStats& stats = strategy.getSamplerStats();
+        std::cout << label << ms << " мс, флотов принято "
+                  << (100.0 * stats.accepted / std::max(1LL, stats.attempts)) << "%, позиций принято "
+                  << (100.0 * stats.placed / std::max(1LL, stats.draws)) << "%, "
+                  << (stats.accepted / ms) << " тыс. образцов/с, выстрелов в среднем "
+                  << (static_cast<double>(totalShots) / gamesCount) << std::endl;
+        return ms;
+    };
+
+    std::cout << "\nГенератор расстановок (пересчет на каждом ходу)" << std::endl;
+    double rejectionMs = runSampler(MonteCarloStrategy::Sampler::REJECTION, "С отказами: ");
+    double tableMs = runSampler(MonteCarloStrategy::Sampler::TABLE, "Табличный:  ");
+    std::cout << "Ускорение: " << (rejectionMs / tableMs) << "x" << std::endl;
+
+    // Накопление тепловой карты: инкремент по клеткам против побитово-срезанных счетчиков
+    const int maskCount = 2000;
+    const int maskPasses = 200;
+    std::vector<BitMask128> masks;
+    masks.reserve(maskCount);
+    for (int i = 0; i < maskCount; ++i) {
+        Fleet fleet;
+        while (!fleet.createStandardFleet(rng)) {}
+        Board board;
+        board.placeFleet(fleet);
+        masks.push_back(board.shipMask());
+    }
+
+    std::array<int, BitMask128::CELLS> scalarHeat{};
+    auto start = std::chrono::high_resolution_clock::now();
+    for (int pass = 0; pass < maskPasses; ++pass) {
+        for (const BitMask128& mask : masks) {
+            BitMask128 bits = mask;
+            while (bits.any()) {
+                ++scalarHeat[bits.popLowest()];
+            }
+        }
+    }
+    double scalarMs = elapsedMs(start);
+
+    std::array<int, BitMask128::CELLS> slicedHeat{};
+    start = std::chrono::high_resolution_clock::now();
+    BitSlicedCounter counter;
+    for (int pass = 0; pass < maskPasses; ++pass) {
+        for (const BitMask128& mask : masks) {
+            counter.add(mask);
+        }
+    }
+    counter.addTo(slicedHeat);
+    double slicedMs = elapsedMs(start);
+
+    // Выбор клетки: поиск максимума с проверкой условий против маскированного argmax
+    const int argmaxRounds = 200000;
+    std::vector<BitMask128> allowedMasks;
+    allowedMasks.reserve(64);
+    for (int i = 0; i < 64; ++i) {
+        allowedMasks.push_back(~masks[i]);
+    }
+    long long scalarSum = 0, maskedSum = 0;
+    start = std::chrono::high_resolution_clock::now();
+    for (int r = 0; r < argmaxRounds; ++r) {
+        const BitMask128& allowed = allowedMasks[r & 63];
+        int best = -1, bestValue = -1;
+        for (int idx = 0; idx < BitMask128::CELLS; ++idx) {
+            if (allowed.test(idx) && scalarHeat[idx] > bestValue) {
+                bestValue = scalarHeat[idx];
+                best = idx;
+            }
+        }
+        scalarSum += best;
+    }
+    double scalarArgmaxMs = elapsedMs(start);
+    start = std::chrono::high_resolution_clock::now();
+    for (int r = 0; r < argmaxRounds; ++r) {
+        maskedSum += HeatmapOps::maskedArgmax(scalarHeat, allowedMasks[r & 63]);
+    }
+    double maskedArgmaxMs = elapsedMs(start);
+
+    long long accumulated = static_cast<long long>(maskCount) * maskPasses;
+    std::cout << "\nТепловая карта (" << accumulated << " масок, " << argmaxRounds << " выборов клетки)" << std::endl;
+    std::cout << "Результаты совпадают: "
+              << (scalarHeat == slicedHeat && scalarSum == maskedSum ? "Да" : "Нет") << std::endl;
+    std::cout << "Инкремент по клеткам:   " << scalarMs << " мс ("
+              << (accumulated / scalarMs / 1000.0) << " млн масок/с)" << std::endl;
+    std::cout << "Побитовые срезы:        " << slicedMs << " мс ("
+              << (accumulated / slicedMs / 1000.0) << " млн масок/с)" << std::endl;
+    std::cout << "Ускорение: " << (scalarMs / slicedMs) << "x" << std::endl;
+    std::cout << "Argmax с условиями:     " << scalarArgmaxMs << " мс" << std::endl;
+    std::cout << "Маскированный argmax:   " << maskedArgmaxMs << " мс" << std::endl;
+    std::cout << "Ускорение: " << (scalarArgmaxMs / maskedArgmaxMs) << "x" << std::endl;
+
+    // Гибрид: точный перебор, когда согласованных расстановок немного
+    auto runExact = [&](bool exact) {
+        MonteCarloStrategy strategy(rng, samples);
+        strategy.setExact(exact);
+        uint64_t trace;
+        auto start = std::chrono::high_resolution_clock::now();
+        long long totalShots = playGames(strategy, gamesCount, trace);
+        double ms = elapsedMs(start);
+        const HeatmapStats& stats = strategy.getHeatmapStats();
+        std::cout << (exact ? "Гибрид:         " : "Только выборка: ") << ms << " мс, карт: выборкой "
+                  << stats.sampled << ", перебором " << stats.exact << ", добивание " << stats.target
+                  << ", выстрелов в среднем " << (static_cast<double>(totalShots) / gamesCount) << std::endl;
+        return ms;
+    };
+
+    std::cout << "\nТочный перебор на позднем этапе" << std::endl;
+    double sampledMs = runExact(false);
+    double hybridMs = runExact(true);
+    std::cout << "Ускорение: " << (sampledMs / hybridMs) << "x" << std::endl;
+
+    // Фильтр частиц: выборка сохраняется между ходами
+    auto runIncremental = [&](bool incremental) {
+        MonteCarloStrategy strategy(rng, samples);
+        strategy.setIncremental(incremental);
+        strategy.setStopping(0.0);
+        uint64_t trace;
+        auto start = std::chrono::high_resolution_clock::now();
+        long long totalShots = playGames(strategy, gamesCount, trace);
+        double ms = elapsedMs(start);
+
+        std::cout << (incremental ? "Фильтр частиц: " : "Пересчет:      ")
+                  << ms << " мс, " << (ms / totalShots) << " мс/ход, "
+                  << "выстрелов в среднем " << (static_cast<double>(totalShots) / gamesCount)
+                  << ", образцов на ход " << (static_cast<double>(strategy.getSamplesDrawn()) / totalShots);
+        if (incremental) {
+            std::cout << ", отброшено на ход "
+                      << (static_cast<double>(strategy.getSamplesDropped()) / totalShots);
+        }
+        std::cout << std::endl;
+        return ms;
+    };
+
+    std::cout << "\nПересчет против фильтра частиц" << std::endl;
+    double fullMs = runIncremental(false);
+    double incrementalMs = runIncremental(true);
+    std::cout << "Ускорение: " << (fullMs / incrementalMs) << "x" << std::endl;
+
+    // Цепь Маркова: попадания копятся без потоплений, и почти все независимые
+    // образцы отвергаются; качество карты - эффективные образцы на миллисекунду
+    const int chainGames = 10;
+    auto runChain = [&](bool chain) {
+        MonteCarloStrategy strategy(rng, samples);
+        strategy.setIncremental(true);
+        strategy.setChain(chain);
+        strategy.setStopping(0.0);
+        uint64_t trace;
+        auto start = std::chrono::high_resolution_clock::now();
+        long long totalShots = playGames(strategy, chainGames, trace, true);
+        double ms = elapsedMs(start);
+        const ChainStats& stats = strategy.getChainStats();
+        // Независимые образцы учитываются полностью, записи цепи - по оценке ESS
+        double effective = static_cast<double>(strategy.getSamplesDrawn() - stats.samples) + stats.ess;
+        std::cout << (chain ? "С цепью:        " : "Только выборка: ") << (ms / totalShots) << " мс/ход, образцов на ход "
+                  << (static_cast<double>(strategy.getSamplesDrawn()) / totalShots)
+                  << ", карт цепью " << strategy.getHeatmapStats().chain;
+        if (chain && stats.runs > 0) {
+            std::cout << ", ESS на запуск " << (stats.ess / stats.runs)
+                      << ", принято перемещений " << (100.0 * stats.moves / std::max(1LL, stats.steps)) << "%";
+        }
+        std::cout << ", эффективных образцов/мс " << (effective / ms) << std::endl;
+        return effective / ms;
+    };
+
+    std::cout << "\nЦепь Маркова на позициях без потоплений (партий: " << chainGames << ")" << std::endl;
+    double independentRate = runChain(false);
+    double chainRate = runChain(true);
+    std::cout << "Выигрыш в эффективных образцах/мс: " << (chainRate / independentRate) << "x" << std::endl;
+
+    // Дебютная книга: карты ранних позиций берутся из файла, отображенного в память
+    const int bookDepth = 8;
+    const int bookSamples = 20000;
+    const std::string bookFile = "bench_opening.book";
+    auto bookStart = std::chrono::high_resolution_clock::now();
+    recordOpeningBook(bookDepth, bookSamples, gamesCount, rng)->save(bookFile, 2);
+    double recordMs = elapsedMs(bookStart);
+    auto book = OpeningBook::load(bookFile);
+    std::remove(bookFile.c_str());
+
+    auto runBook = [&](std::shared_ptr<OpeningBook> openingBook) {
+        MonteCarloStrategy strategy(rng, samples);
+        strategy.setOpeningBook(openingBook);
+        uint64_t trace;
+        auto start = std::chrono::high_resolution_clock::now();
+        long long totalShots = playGames(strategy, gamesCount, trace);
+        double ms = elapsedMs(start);
+        std::cout << (openingBook ? "С книгой:  " : "Без книги: ") << ms << " мс, карт из книги "
+                  << strategy.getHeatmapStats().book << ", выстрелов в среднем "
+                  << (static_cast<double>(totalShots) / gamesCount) << std::endl;
+        return ms;
+    };
+
+    std::cout << "\nДебютная книга (глубина " << bookDepth << ", образцов на карту " << bookSamples
+              << ", позиций " << (book ? book->size() : 0) << ", " << (book ? book->bytes() : 0)
+              << " байт, построение " << recordMs << " мс)" << std::endl;
+    double noBookMs = runBook(nullptr);
+    double bookMs = runBook(book);
+    std::cout << "Ускорение: " << (noBookMs / bookMs) << "x" << std::endl;
+
+    // Таблица карт: стратегии, создаваемые на каждую партию, повторно играют те же флоты
+    const int tablePasses = 3;
+    auto runTable = [&](std::shared_ptr<TranspositionTable> table) {
+        long long totalShots = 0;
+        auto start = std::chrono::high_resolution_clock::now();
+        for (int pass = 0; pass < tablePasses; ++pass) {
+            MonteCarloStrategy strategy(rng, samples);
+            strategy.setTranspositionTable(table);
+            uint64_t trace;
+            totalShots += playGames(strategy, gamesCount, trace);
+        }
+        double ms = elapsedMs(start);
+        std::cout << (table ? "С таблицей:  " : "Без таблицы: ") << ms << " мс, выстрелов в среднем "
+                  << (static_cast<double>(totalShots) / (tablePasses * gamesCount)) << std::endl;
+        return ms;
+    };
+
+    std::cout << "\nТаблица карт (проходов по тем же флотам: " << tablePasses << ")" << std::endl;
+    auto table = std::make_shared<TranspositionTable>(size_t(8) << 20);
+    double uncachedMs = runTable(nullptr);
+    double cachedMs = runTable(table);
+    std::cout << table->report() << std::endl;
+    std::cout << "Ускорение: " << (uncachedMs / cachedMs) << "x" << std::endl;
+
+    // Фильтр корпуса: карта из готовых расстановок, согласованных с позицией
+    const size_t corpusSize = 500000;
+    const int corpusShots = 12;
+    const std::string corpusFile = "bench_fleets.corpus";
+    auto corpusStart = std::chrono::high_resolution_clock::now();
+    FleetCorpus(generateFleetCorpus(corpusSize, rng)).save(corpusFile);
+    double corpusBuildMs = elapsedMs(corpusStart);
+    auto corpus = FleetCorpus::load(corpusFile);
+    std::remove(corpusFile.c_str());
+
+    // Позиции охоты (карта строится, когда раненых кораблей нет): первые corpusShots
+    // промахов в случайной перестановке клеток поля на каждом флоте
+    std::vector<std::vector<int>> corpusOrders(gamesCount);
+    for (auto& order : corpusOrders) {
+        order.resize(BitMask128::CELLS);
+        std::iota(order.begin(), order.end(), 0);
+        for (int i = BitMask128::CELLS - 1; i > 0; --i) {
+            std::swap(order[i], order[rng.uniformInt(0, i)]);
+        }
+    }
+    auto runCorpus = [&](std::shared_ptr<FleetCorpus> fleetCorpus) {
+        double ms = 0.0;
+        long long served = 0;
+        for (int g = 0; g < gamesCount; ++g) {
+            Board board;
+            board.placeFleet(fleets[g]);
+            MonteCarloStrategy strategy(rng, samples);
+            strategy.setFleetCorpus(fleetCorpus);
+            strategy.setStopping(0.0);
+            const BitMask128 ships = board.shipMask();
+            int misses = 0;
+            for (int idx : corpusOrders[g]) {
+                if (misses == corpusShots) break;
+                if (ships.test(idx)) continue;
+                board.shoot(idx % 10, idx / 10);
+                strategy.notifyShotResult(idx % 10, idx / 10, false, false, board);
+                ++misses;
+            }
+            strategy.getNextShot(board);
+            ms += strategy.getLastMoveStats().ms;
+            served += strategy.getHeatmapStats().library;
+        }
+        std::cout << (fleetCorpus ? "Фильтр корпуса: " : "Генерация:      ") << (ms / gamesCount)
+                  << " мс/карта, карт из корпуса " << served << " из " << gamesCount << std::endl;
+        return ms;
+    };
+
+    std::cout << "\nФильтр корпуса (расстановок: " << (corpus ? corpus->size() : 0) << ", "
+              << (corpus ? corpus->bytes() >> 20 : 0) << " МБ, построение " << corpusBuildMs
+              << " мс; позиции после " << corpusShots << " промахов)" << std::endl;
+    double generatedMs = runCorpus(nullptr);
+    double filteredMs = runCorpus(corpus);
+    std::cout << "Ускорение: " << (generatedMs / filteredMs) << "x" << std::endl;
+
+    // Целые партии: корпус служит, пока согласованных расстановок достаточно
+    auto runCorpusGames = [&](std::shared_ptr<FleetCorpus> fleetCorpus) {
+        MonteCarloStrategy strategy(rng, samples);
+        strategy.setFleetCorpus(fleetCorpus);
+        uint64_t trace;
+        auto start = std::chrono::high_resolution_clock::now();
+        long long totalShots = playGames(strategy, gamesCount, trace);
+        double ms = elapsedMs(start);
+        const HeatmapStats& stats = strategy.getHeatmapStats();
+        std::cout << (fleetCorpus ? "С корпусом:  " : "Без корпуса: ") << ms << " мс, карт: корпусом "
+                  << stats.library << ", выборкой " << stats.sampled << ", перебором " << stats.exact
+                  << ", выстрелов в среднем " << (static_cast<double>(totalShots) / gamesCount) << std::endl;
+        return ms;
+    };
+    double plainGamesMs = runCorpusGames(nullptr);
+    double corpusGamesMs = runCorpusGames(corpus);
+    std::cout << "Ускорение партий: " << (plainGamesMs / corpusGamesMs) << "x" << std::endl;
+
+    // Досрочная остановка: последовательный тест сходимости и бюджет времени хода
+    const int stopGames = 10;
+    const int stopSamples = 5000;
+    const double moveBudgetMs = 2.0;
+    auto runStopping = [&](double z, double budgetMs, const char* label) {
+        MonteCarloStrategy strategy(rng, stopSamples);
+        strategy.setStopping(z, budgetMs);
+        uint64_t trace;
+        auto start = std::chrono::high_resolution_clock::now();
+        long long totalShots = playGames(strategy, stopGames, trace);
+        double ms = elapsedMs(start);
+        const HeatmapStats& stats = strategy.getHeatmapStats();
+        const long long builds = stats.sampled + stats.exact + stats.target + stats.chain;
+        using Stop = MonteCarloStrategy::StopReason;
+        std::cout << label << ms << " мс, худший ход " << worstMoveMs << " мс, образцов на карту "
+                  << (builds ? strategy.getSamplesDrawn() / builds : 0) << ", выстрелов в среднем "
+                  << (static_cast<double>(totalShots) / stopGames) << ", остановок: сходимость "
+                  << strategy.getStopCount(Stop::CONVERGED) << ", бюджет " << strategy.getStopCount(Stop::BUDGET)
+                  << ", квота " << strategy.getStopCount(Stop::QUOTA) << std::endl;
+        return ms;
+    };
+
+    std::cout << "\nДосрочная остановка (образцов: " << stopSamples << ", партий: " << stopGames << ")" << std::endl;
+    double allSamplesMs = runStopping(0.0, 0.0, "Все образцы:    ");
+    double convergedMs = runStopping(2.5, 0.0, "Тест сходимости: ");
+    runStopping(0.0, moveBudgetMs, "Только 2 мс:     ");
+    runStopping(2.5, moveBudgetMs, "Тест + 2 мс:     ");
+    std::cout << "Ускорение теста сходимости: " << (allSamplesMs / convergedMs) << "x" << std::endl;
+
+    // Симметрии: на пустом поле все 8 преобразований сохраняют наблюдения,
+    // поэтому каждая выборка дает 8 образцов. Ошибка карты - СКО долей клеток
+    // относительно эталонной карты по 200000 образцам без свертки.
+    const int symmetrySamples = 1000;
+    const int symmetryTrials = 100;
+    auto normalizedHeat = [](const std::array<int, 100>& heat) {
+        double total = 0.0;
+        for (int value : heat) total += value;
+        std::array<double, 100> share{};
+        for (int idx = 0; idx < 100; ++idx) share[idx] = total > 0 ? heat[idx] / total : 0.0;
+        return share;
+    };
+    Board emptyBoard(10);
+    MonteCarloStrategy reference(rng, 200000);
+    reference.setSymmetry(false);
+    reference.setStopping(0.0);
+    reference.setExact(false);
+    reference.getNextShot(emptyBoard);
+    const std::array<double, 100> referenceShare = normalizedHeat(reference.getHeatmap());
+    auto runSymmetry = [&](bool symmetry, int samples, const char* label) {
+        double error = 0.0;
+        auto start = std::chrono::high_resolution_clock::now();
+        for (int trial = 0; trial < symmetryTrials; ++trial) {
+            MonteCarloStrategy strategy(rng, samples);
+            strategy.setSymmetry(symmetry);
+            strategy.setStopping(0.0);
+            strategy.setExact(false);
+            strategy.getNextShot(emptyBoard);
+            const std::array<double, 100> share = normalizedHeat(strategy.getHeatmap());
+            double squares = 0.0;
+            for (int idx = 0; idx < 100; ++idx) {
+                squares += (share[idx] - referenceShare[idx]) * (share[idx] - referenceShare[idx]);
+            }
+            error += std::sqrt(squares / 100);
+        }
+        double ms = elapsedMs(start) / symmetryTrials;
+        std::cout << label << ms << " мс/карта, СКО x1e-4: " << (error / symmetryTrials * 1e4) << std::endl;
+        return ms;
+    };
+
+    std::cout << "\nСимметрии (образцов: " << symmetrySamples << ", карт: " << symmetryTrials << ")" << std::endl;
+    double unfoldedMs = runSymmetry(false, symmetrySamples, "Без свертки:      ");
+    double foldedMs = runSymmetry(true, symmetrySamples, "Со сверткой:      ");
+    runSymmetry(false, symmetrySamples * 8, "Без свертки, x8:  ");
+    std::cout << "Ускорение на пустом поле: " << (unfoldedMs / foldedMs) << "x" << std::endl;
+
+    // Параллельная выборка: задержка хода MC-5000 и воспроизводимость при фиксированном сиде
+    const int parallelGames = 5;
+    const int parallelSamples = 5000;
+    const int hardwareThreads = std::max(2, static_cast<int>(std::thread::hardware_concurrency()));
+    auto runThreads = [&](int threads, uint64_t& trace) {
+        RNG::initialize(2024);
+        MonteCarloStrategy strategy(rng, parallelSamples);
+        strategy.setThreads(threads);
+        strategy.setStopping(0.0); // Потоки делят полную квоту: тест сходимости не применяется
+        auto start = std::chrono::high_resolution_clock::now();
+        long long totalShots = playGames(strategy, parallelGames, trace);
+        return elapsedMs(start) / totalShots;
+    };
+
+    std::cout << "\nПараллельная выборка (образцов: " << parallelSamples
+              << ", потоков: " << hardwareThreads << ")" << std::endl;
+    uint64_t serialTrace, parallelTrace, repeatTrace;
+    double serialMs = runThreads(1, serialTrace);
+    double parallelMs = runThreads(hardwareThreads, parallelTrace);
+    runThreads(hardwareThreads, repeatTrace);
+    std::cout << "1 поток:   " << serialMs << " мс/ход" << std::endl;
+    std::cout << hardwareThreads << " потоков: " << parallelMs << " мс/ход" << std::endl;
+    std::cout << "Ускорение: " << (serialMs / parallelMs) << "x" << std::endl;
+    std::cout << "Повтор с тем же сидом совпадает: " << (parallelTrace == repeatTrace ? "Да" : "Нет") << std::endl;
+}
+
+void trainPlacement(const std::string& outFile, int customMaxGen = -1, bool useSurrogate = false) {
     std::cout << "[CLI] Запуск обучения расстановки кораблей. Вывод будет сохранен в: " << outFile << std::endl;
     
     // Инициализация логгера для placement_ga
@@ -746,8 +1924,30 @@ void trainPlacement(const std::string& outFile, int customMaxGen = -1) {
         }
     }
     
+    // Общая таблица карт Монте-Карло: стратегии, создаваемые в фитнес-функции,
+    // повторно используют карты одинаковых позиций
+    auto mcTable = std::make_shared<TranspositionTable>();
+    MonteCarloStrategy::setDefaultTranspositionTable(mcTable);
+    
+    // Заменитель Монте-Карло (--surrogate, модель из --build-surrogate): в эволюции
+    // партии против МК играет он, а финалисты перепроверяются настоящим МК
+    std::shared_ptr<const SurrogateModel> mcSurrogate;
+    if (useSurrogate) {
+        mcSurrogate = SurrogateModel::load(SurrogateModel::DEFAULT_PATH);
+        if (mcSurrogate) {
+            std::cout << "Загружен заменитель Монте-Карло: " << SurrogateModel::DEFAULT_PATH << std::endl;
+            Logger::instance().logMessage(std::string("Surrogate MC model: ") + SurrogateModel::DEFAULT_PATH);
+        } else {
+            std::cerr << "Заменитель Монте-Карло не найден (" << SurrogateModel::DEFAULT_PATH
+                      << "), μ3 считается настоящим Монте-Карло" << std::endl;
+        }
+    }
+    const std::string mcSource = mcSurrogate ? "заменитель" : "Монте-Карло";
+    
     // Определяем фитнес-функцию для хромосомы расстановки
-    auto fitnessFunction = [](PlacementChromosome& chrom) -> double {
+    // (fitnessSurrogate == nullptr - партии против настоящего Монте-Карло)
+    std::shared_ptr<const SurrogateModel> fitnessSurrogate = mcSurrogate;
+    auto fitnessFunction = [&fitnessSurrogate](PlacementChromosome& chrom) -> double {
         if (!chrom.isValid()) {
             return -1000.0; // Большой штраф за невалидность
         }
@@ -761,7 +1961,12 @@ void trainPlacement(const std::string& outFile, int customMaxGen = -1) {
         // Создаем стратегии для тестирования
         RandomStrategy random_shooter;
         CheckerboardStrategy checker_shooter;
-        MonteCarloStrategy monte_shooter(100); // Используем небольшое количество симуляций для скорости
+        std::unique_ptr<MonteCarloStrategy> monte_shooter;
+        if (fitnessSurrogate) {
+            monte_shooter = std::make_unique<SurrogateStrategy>(fitnessSurrogate);
+        } else {
+            monte_shooter = std::make_unique<MonteCarloStrategy>(100); // Используем небольшое количество симуляций для скорости
+        }
         
         int totalTrials = 10; // Для каждой стратегии
         double totalMeanShots = 0;
@@ -814,13 +2019,13 @@ void trainPlacement(const std::string& outFile, int customMaxGen = -1) {
         for (int i = 0; i < totalTrials; ++i) {
             Board board;
             if (!board.placeFleet(*fleet)) return -900.0;
-            monte_shooter.reset(); 
+            monte_shooter->reset(); 
             int shots = 0;
             while (!board.allShipsSunk() && shots < 100) {
-                auto shot = monte_shooter.getNextShot(board);
+                auto shot = monte_shooter->getNextShot(board);
                 bool hit = board.shoot(shot.first, shot.second);
                 bool sunk = hit && board.wasShipSunkAt(shot.first, shot.second);
-                monte_shooter.notifyShotResult(shot.first, shot.second, hit, sunk, board);
+                monte_shooter->notifyShotResult(shot.first, shot.second, hit, sunk, board);
                 shots++;
             }
             currentStrategyTotalShotsMC += shots;
@@ -889,8 +2094,10 @@ void trainPlacement(const std::string& outFile, int customMaxGen = -1) {
             "Поколение " + std::to_string(gen) + 
             ": Random=" + std::to_string(bestChromosome.getMeanShotsRandom()) +
             ", Checker=" + std::to_string(bestChromosome.getMeanShotsCheckerboard()) +
-            ", MC=" + std::to_string(bestChromosome.getMeanShotsMC())
+            ", MC=" + std::to_string(bestChromosome.getMeanShotsMC()) +
+            " (μ3: " + mcSource + ")"
         );
+        Logger::instance().logMessage(mcTable->report());
         
         // Периодически сохраняем состояние
         if (gen % saveInterval == 0) {
@@ -918,6 +2125,26 @@ void trainPlacement(const std::string& outFile, int customMaxGen = -1) {
         [](const PlacementChromosome& a, const PlacementChromosome& b) {
             return a.getFitness() > b.getFitness();
         });
+    
+    // Финалисты, отобранные заменителем, перепроверяются настоящей стратегией Монте-Карло
+    if (mcSurrogate) {
+        const int finalists = std::min(10, static_cast<int>(sortedPopulation.size()));
+        std::cout << "Проверка " << finalists << " финалистов настоящим Монте-Карло..." << std::endl;
+        fitnessSurrogate = nullptr;
+        for (int i = 0; i < finalists; ++i) {
+            fitnessFunction(sortedPopulation[i]);
+        }
+        std::sort(sortedPopulation.begin(), sortedPopulation.begin() + finalists,
+            [](const PlacementChromosome& a, const PlacementChromosome& b) {
+                return a.getFitness() > b.getFitness();
+            });
+        if (finalists > 0) {
+            bestChromosome = sortedPopulation.front();
+            Logger::instance().logMessage(
+                "Проверка финалистов: лучший фитнес " + std::to_string(bestChromosome.getFitness()) +
+                ", MC=" + std::to_string(bestChromosome.getMeanShotsMC()));
+        }
+    }
     int topSize = std::min(50, static_cast<int>(sortedPopulation.size()));
     topChromosomes.assign(sortedPopulation.begin(), sortedPopulation.begin() + topSize);
     
@@ -962,10 +2189,14 @@ void trainPlacement(const std::string& outFile, int customMaxGen = -1) {
     std::cout << "\nДля продолжения эволюции с текущими настройками запустите команду:" << std::endl;
     std::cout << "  battleship_ga.exe --train-placement " << outFile << " [новое_число_поколений]" << std::endl;
     
+    std::cout << "\n" << mcTable->report() << std::endl;
+    Logger::instance().logMessage(mcTable->report());
+    MonteCarloStrategy::setDefaultTranspositionTable(nullptr);
+    
     Logger::instance().close(); // Закрываем логгер
 }
 
-void trainDecision(const std::string& placementsFile, const std::string& outFile) {
+void trainDecision(const std::string& placementsFile, const std::string& outFile, bool lockstep = false) {
     std::cout << "[CLI] Запуск обучения стратегии стрельбы. Вход: " << placementsFile << " → " << outFile << std::endl;
     
     // Инициализация логгера для decision_ga
@@ -1047,9 +2278,8 @@ void trainDecision(const std::string& placementsFile, const std::string& outFile
     std::map<std::string, double> strategyStats;
     std::vector<DecisionChromosome> topChromosomes;
     
-    // Создаём объект лучшей хромосомы с пустым вектором весов
-    // для совместимости с компилятором
-    DecisionChromosome bestChromosome({});
+    // Лучшая хромосома (заполняется после оценки начальной популяции)
+    DecisionChromosome bestChromosome;
     
     // Если продолжаем предыдущую эволюцию
     if (continuePrevious) {
@@ -1069,81 +2299,23 @@ void trainDecision(const std::string& placementsFile, const std::string& outFile
         }
     }
     
-    // Определяем фитнес-функцию для стратегии стрельбы
-    auto fitnessFunction = [](DecisionChromosome& chromosome, const PlacementPool& pool) {
-        if (pool.empty()) {
-            throw std::runtime_error("Пул расстановок пуст");
-        }
-        
-        // Создаем стратегию на основе хромосомы
-        FeatureBasedStrategy strategy(chromosome.getGenes());
-        
-        // Проводим симуляции против различных расстановок из пула
-        int totalShots = 0;
-        int numTrials = 0;
-        std::vector<int> allShots;
-        
-        // Ограничим количество испытаний для скорости
-        const int maxTrials = std::min(30, static_cast<int>(pool.size()));
-        
-        for (int i = 0; i < maxTrials; ++i) {
-            const auto& placement = pool.getPlacement(i);
-            auto fleet = placement.decodeFleet();
-            
-            if (!fleet || !fleet->isValid()) {
-                continue; // Пропускаем невалидные расстановки
-            }
-            
-            Board board(10);
-            for (const auto& ship : fleet->getShips()) {
-                for (const auto& cell : ship.getOccupiedCells()) {
-                    board.placeShip(cell.first, cell.second);
-                }
-            }
-            
-            strategy.reset(); // Сбрасываем стратегию перед новой симуляцией
-            int shots = 0;
-            int maxShots = 200; // Предел для предотвращения бесконечного цикла
-            
-            while (!board.allShipsSunk() && shots < maxShots) {
-                auto shot = strategy.getNextShot(board);
-                bool hit = board.shoot(shot.first, shot.second);
-                bool sunk = hit && board.wasShipSunkAt(shot.first, shot.second);
-                strategy.notifyShotResult(shot.first, shot.second, hit, sunk, board);
-                shots++;
-            }
-            
-            if (shots < maxShots) {
-                totalShots += shots;
-                allShots.push_back(shots);
-                numTrials++;
-            }
-        }
-        
-        if (numTrials == 0) {
-            throw std::runtime_error("Нет успешных симуляций");
-        }
-        
-        // Вычисляем среднее и стандартное отклонение
-        double meanShots = static_cast<double>(totalShots) / numTrials;
-        
-        double sumSquares = 0.0;
-        for (int shots : allShots) {
-            sumSquares += (shots - meanShots) * (shots - meanShots);
-        }
-        double stdDevShots = std::sqrt(sumSquares / numTrials);
-        
-        // Обновляем статистику в хромосому
-        chromosome.setMeanShots(meanShots);
-        chromosome.setStdDevShots(stdDevShots);
-        
-        // Вычисляем фитнес
-        double fitness = Fitness::calculateDecisionFitness(meanShots, stdDevShots);
-        chromosome.setFitness(fitness);
-        
-        return;
+    // Определяем фитнес-функцию для стратегии стрельбы: хромосома играет
+    // FeatureBasedStrategy против первых 30 расстановок пула
+    DecisionEvaluator evaluator;
+    auto fitnessFunction = [&evaluator](DecisionChromosome& chromosome, const PlacementPool& pool) {
+        evaluator.evaluate(chromosome, pool);
     };
     
+    // С --lockstep поколение оценивается целиком: партии всех хромосом на одной
+    // расстановке идут ход в ход, плоскости признаков общие для одинаковых историй
+    if (lockstep) {
+        std::cout << "Оценка поколений: lockstep" << std::endl;
+        dga.setPopulationFitness([&evaluator](const std::vector<DecisionChromosome*>& chromosomes,
+                                              const PlacementPool& pool) {
+            evaluator.evaluateLockstep(chromosomes, pool);
+        });
+    }
+    
     // Если начинаем новую эволюцию
     if (!continuePrevious) {
         std::cout << "Начинаем эволюцию генетического алгоритма стратегии стрельбы..." << std::endl;
@@ -1172,7 +2344,11 @@ void trainDecision(const std::string& placementsFile, const std::string& outFile
         std::cout << "Поколение " << gen << "..." << std::flush;
         
         // Эволюция на одно поколение
+        evaluator.resetStats();
+        auto genStart = std::chrono::high_resolution_clock::now();
         dga.evolveOneGeneration(fitnessFunction, pool);
+        double genSeconds = std::chrono::duration<double>(
+            std::chrono::high_resolution_clock::now() - genStart).count();
         bestChromosome = dga.getBestChromosome();
         
         // Сохраняем лучшую хромосому текущего поколения
@@ -1186,8 +2362,20 @@ void trainDecision(const std::string& placementsFile, const std::string& outFile
         std::cout << " [Лучший фитнес: " << bestFit << ", Средний: " << avgFit 
                   << ", σ: " << currentSigma << "]" << std::endl;
         
+        // Время поколения и, в режиме lockstep, доля ходов с общими плоскостями признаков
+        std::ostringstream cacheInfo;
+        cacheInfo << "Поколение " << gen << ": ";
+        if (lockstep) {
+            cacheInfo << "общие плоскости признаков " << std::fixed << std::setprecision(1)
+                      << evaluator.stats().hitRate() * 100.0 << "% ходов (" << evaluator.stats().hits
+                      << " из " << evaluator.stats().lookups << "), ";
+        }
+        cacheInfo << "время поколения " << std::fixed << std::setprecision(2) << genSeconds << " с";
+        std::cout << cacheInfo.str() << std::endl;
+        
         // Логируем информацию о поколении
         Logger::instance().logDecisionGen(gen, bestFit, avgFit, currentSigma);
+        Logger::instance().logMessage(cacheInfo.str());
         
         // Обновляем статистику по стратегии
         strategyStats["Mean Shots"] = bestChromosome.getMeanShots();
@@ -1502,6 +2690,8 @@ void testStrategiesAdvanced() {
                 board.placeFleet(*fleet);
                 
                 MonteCarloStrategy strategy(rng, 5000);
+                strategy.setIncremental(true);
+                strategy.setThreads(0);
                 int shots = 0;
                 
                 while (!board.allShipsSunk() && shots < 100) {
@@ -1672,29 +2862,80 @@ int main(int argc, char** argv) {
         std::cout << "Запуск: " << runId << std::endl;
         Logger::instance().open(runId);
         
+        // Общие флаги (в любом месте командной строки) убираются из argv до разбора режимов:
+        // --book <file> - дебютная книга Монте-Карло для всех стратегий,
+        // --corpus <file> - фильтр корпуса расстановок во всех стратегиях
+        std::string bookFile;
+        std::string corpusFile;
+        int argCount = 1;
+        for (int i = 1; i < argc; ++i) {
+            const std::string arg = argv[i];
+            if (arg == "--book" && i + 1 < argc) {
+                bookFile = argv[++i];
+            } else if (arg == "--corpus" && i + 1 < argc) {
+                corpusFile = argv[++i];
+            } else {
+                argv[argCount++] = argv[i];
+            }
+        }
+        argc = argCount;
+        
+        if (!bookFile.empty()) {
+            auto book = OpeningBook::load(bookFile);
+            if (!book) {
+                std::cerr << "Ошибка: не удалось загрузить дебютную книгу " << bookFile << std::endl;
+                Logger::instance().close();
+                return 1;
+            }
+            MonteCarloStrategy::setDefaultOpeningBook(book);
+            std::ostringstream bookInfo;
+            bookInfo << "Дебютная книга: " << bookFile << " (" << book->size() << " позиций, глубина "
+                     << book->depth() << ", образцов на карту " << book->samples() << ")";
+            std::cout << bookInfo.str() << std::endl;
+            Logger::instance().logMessage(bookInfo.str());
+        }
+        if (!corpusFile.empty()) {
+            auto corpus = FleetCorpus::load(corpusFile);
+            if (!corpus) {
+                std::cerr << "Ошибка: не удалось загрузить корпус расстановок " << corpusFile << std::endl;
+                Logger::instance().close();
+                return 1;
+            }
+            MonteCarloStrategy::setDefaultFleetCorpus(corpus);
+            std::ostringstream corpusInfo;
+            corpusInfo << "Корпус расстановок: " << corpusFile << " (" << corpus->size() << " расстановок)";
+            std::cout << corpusInfo.str() << std::endl;
+            Logger::instance().logMessage(corpusInfo.str());
+        }
+        
         // --- CLI режимы ---------------------------------------------------
         if (argc >= 2) {
             std::string mode = argv[1];
             if (mode == "--train-placement") {
                 if (argc < 3) {
                     std::cerr << "Недостаточно аргументов для режима --train-placement" << std::endl;
-                    std::cerr << "Использование: --train-placement <out_file> [generations]" << std::endl;
+                    std::cerr << "Использование: --train-placement <out_file> [generations] [--surrogate]" << std::endl;
                     Logger::instance().close();
                     return 1;
                 }
                 
                 int generations = -1; // По умолчанию используется значение из кода
-                if (argc >= 4) {
+                bool useSurrogate = false; // --surrogate: μ3 по заменителю Монте-Карло
+                for (int i = 3; i < argc; ++i) {
+                    if (std::string(argv[i]) == "--surrogate") {
+                        useSurrogate = true;
+                        continue;
+                    }
                     try {
-                        generations = std::stoi(argv[3]);
+                        generations = std::stoi(argv[i]);
                     } catch (...) {
-                        std::cerr << "Ошибка: неверное количество поколений: " << argv[3] << std::endl;
+                        std::cerr << "Ошибка: неверное количество поколений: " << argv[i] << std::endl;
                         Logger::instance().close();
                         return 1;
                     }
                 }
                 
-                trainPlacement(argv[2], generations);
+                trainPlacement(argv[2], generations, useSurrogate);
                 Logger::instance().close();
                 return 0;
             } else if (mode == "--train-shooting" && argc >= 2) {
@@ -1713,7 +2954,9 @@ int main(int argc, char** argv) {
                 Logger::instance().close();
                 return 0;
             } else if (mode == "--train-decision" && argc >= 4) {
-                trainDecision(argv[2], argv[3]);
+                // --lockstep: оценка поколения целиком (DecisionEvaluator::evaluateLockstep)
+                bool lockstep = argc >= 5 && std::string(argv[4]) == "--lockstep";
+                trainDecision(argv[2], argv[3], lockstep);
                 Logger::instance().close();
                 return 0;
             } else if (mode == "--play" && argc >= 4) {
@@ -1730,6 +2973,74 @@ int main(int argc, char** argv) {
                 testPlacementGenerator();
                 Logger::instance().close();
                 return 0;
+            } else if (mode == "--bench-board") {
+                // Микробенчмарк представлений игрового поля
+                testBoardBenchmark();
+                Logger::instance().close();
+                return 0;
+            } else if (mode == "--bench-features") {
+                // Бенчмарк плоскостей признаков и ядер оценки клеток
+                testFeatureBenchmark();
+                Logger::instance().close();
+                return 0;
+            } else if (mode == "--bench-lockstep") {
+                // Бенчмарк оценки поколения DecisionGA в режиме lockstep
+                testLockstepBenchmark();
+                Logger::instance().close();
+                return 0;
+            } else if (mode == "--bench-mc") {
+                // Бенчмарк инкрементальной выборки Монте-Карло
+                testMonteCarloBenchmark();
+                Logger::instance().close();
+                return 0;
+            } else if (mode == "--build-book" && argc >= 3) {
+                // Офлайн-построение дебютной книги Монте-Карло
+                int depth = OpeningBook::DEFAULT_DEPTH;
+                int samples = OpeningBook::DEFAULT_SAMPLES;
+                int games = OpeningBook::DEFAULT_GAMES;
+                try {
+                    if (argc >= 4) depth = std::stoi(argv[3]);
+                    if (argc >= 5) samples = std::stoi(argv[4]);
+                    if (argc >= 6) games = std::stoi(argv[5]);
+                } catch (...) {
+                    std::cerr << "Ошибка: неверные параметры книги" << std::endl;
+                    std::cerr << "Использование: --build-book <out_file> [depth] [samples] [games]" << std::endl;
+                    Logger::instance().close();
+                    return 1;
+                }
+                buildOpeningBook(argv[2], depth, samples, games);
+                Logger::instance().close();
+                return 0;
+            } else if (mode == "--build-corpus" && argc >= 3) {
+                // Офлайн-построение корпуса расстановок для фильтра Монте-Карло
+                size_t count = FleetCorpus::DEFAULT_SIZE;
+                try {
+                    if (argc >= 4) count = std::stoul(argv[3]);
+                } catch (...) {
+                    std::cerr << "Ошибка: неверный размер корпуса" << std::endl;
+                    std::cerr << "Использование: --build-corpus <out_file> [count]" << std::endl;
+                    Logger::instance().close();
+                    return 1;
+                }
+                buildFleetCorpus(argv[2], count);
+                Logger::instance().close();
+                return 0;
+            } else if (mode == "--build-surrogate" && argc >= 3) {
+                // Обучение модели-заменителя стратегии Монте-Карло
+                int games = SurrogateModel::DEFAULT_GAMES;
+                int samples = SurrogateModel::DEFAULT_SAMPLES;
+                try {
+                    if (argc >= 4) games = std::stoi(argv[3]);
+                    if (argc >= 5) samples = std::stoi(argv[4]);
+                } catch (...) {
+                    std::cerr << "Ошибка: неверные параметры обучения заменителя" << std::endl;
+                    std::cerr << "Использование: --build-surrogate <out_file> [games] [samples]" << std::endl;
+                    Logger::instance().close();
+                    return 1;
+                }
+                buildSurrogate(argv[2], games, samples);
+                Logger::instance().close();
+                return 0;
             } else if (mode == "--test-strategies") {
                 // Новый режим для расширенного тестирования стратегий
                 testStrategiesAdvanced();
@@ -1762,15 +3073,25 @@ int main(int argc, char** argv) {
             } else {
                 std::cerr << "Неизвестный режим или недостаточно аргументов." << std::endl;
                 std::cerr << "Доступные режимы:" << std::endl;
-                std::cerr << "  --train-placement <out_file> [generations]" << std::endl;
+                std::cerr << "  --train-placement <out_file> [generations] [--surrogate]" << std::endl;
                 std::cerr << "  --train-shooting  [generations]" << std::endl;
-                std::cerr << "  --train-decision  <placements_file> <out_file>" << std::endl;
+                std::cerr << "  --train-decision  <placements_file> <out_file> [--lockstep]" << std::endl;
                 std::cerr << "  --play            <weights_file> <placements_file>" << std::endl;
                 std::cerr << "  --test-diversity" << std::endl;
                 std::cerr << "  --test-generator" << std::endl;
                 std::cerr << "  --test-strategies" << std::endl;
+                std::cerr << "  --bench-board" << std::endl;
+                std::cerr << "  --bench-mc" << std::endl;
+                std::cerr << "  --bench-features" << std::endl;
+                std::cerr << "  --bench-lockstep" << std::endl;
+                std::cerr << "  --build-book      <out_file> [depth] [samples] [games]" << std::endl;
+                std::cerr << "  --build-corpus    <out_file> [count]" << std::endl;
+                std::cerr << "  --build-surrogate <out_file> [games] [samples]" << std::endl;
                 std::cerr << "  --save-state      <state_file>" << std::endl;
                 std::cerr << "  --load-state      <state_file>" << std::endl;
+                std::cerr << "Общие флаги:" << std::endl;
+                std::cerr << "  --book            <book_file>" << std::endl;
+                std::cerr << "  --corpus          <corpus_file>" << std::endl;
                 Logger::instance().close();
                 return 1;
             }
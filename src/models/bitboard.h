@@ -0,0 +1,169 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+
+/**
+ * @struct BitMask128
+ * @brief 128-битная маска клеток игрового поля 10x10.
+ *
+ * Клетка (x, y) соответствует биту с индексом y * 10 + x. Младшие 64 бита
+ * хранятся в lo, старшие - в hi; биты с индексами 100..127 всегда равны нулю.
+ * Все операции выполняются без ветвлений и выделения памяти, поэтому маска
+ * используется в Board и других горячих участках кода симуляции.
+ */
+struct BitMask128 {
+    static constexpr int SIDE = 10;          ///< Сторона поля
+    static constexpr int CELLS = SIDE * SIDE; ///< Количество клеток поля
+
+    uint64_t lo = 0; ///< Биты 0..63
+    uint64_t hi = 0; ///< Биты 64..127
+
+    constexpr BitMask128() = default;
+    constexpr BitMask128(uint64_t low, uint64_t high) : lo(low), hi(high) {}
+
+    /**
+     * @brief Индекс бита для клетки (x, y)
+     */
+    static constexpr int index(int x, int y) { return y * SIDE + x; }
+
+    /**
+     * @brief Маска с одним установленным битом
+     * @param idx Индекс клетки (0..99)
+     */
+    static constexpr BitMask128 bit(int idx) {
+        return idx < 64 ? BitMask128(uint64_t(1) << idx, 0)
+                        : BitMask128(0, uint64_t(1) << (idx - 64));
+    }
+
+    /**
+     * @brief Маска с одной клеткой (x, y)
+     */
+    static constexpr BitMask128 cell(int x, int y) { return bit(index(x, y)); }
+
+    /**
+     * @brief Маска всех 100 клеток поля
+     */
+    static constexpr BitMask128 full() {
+        return BitMask128(~uint64_t(0), (uint64_t(1) << (CELLS - 64)) - 1);
+    }
+
+    /**
+     * @brief Маска столбца x (все клетки с данной X-координатой)
+     */
+    static constexpr BitMask128 column(int x) {
+        BitMask128 m;
+        for (int y = 0; y < SIDE; ++y) {
+            m.set(index(x, y));
+        }
+        return m;
+    }
+
+    constexpr bool test(int idx) const {
+        return idx < 64 ? ((lo >> idx) & 1u) != 0 : ((hi >> (idx - 64)) & 1u) != 0;
+    }
+
+    constexpr void set(int idx) {
+        if (idx < 64) lo |= uint64_t(1) << idx;
+        else hi |= uint64_t(1) << (idx - 64);
+    }
+
+    constexpr void reset(int idx) {
+        if (idx < 64) lo &= ~(uint64_t(1) << idx);
+        else hi &= ~(uint64_t(1) << (idx - 64));
+    }
+
+    constexpr bool any() const { return (lo | hi) != 0; }
+    constexpr bool none() const { return (lo | hi) == 0; }
+
+    /**
+     * @brief Количество установленных битов
+     */
+    int count() const {
+#if defined(__GNUC__) || defined(__clang__)
+        return __builtin_popcountll(lo) + __builtin_popcountll(hi);
+#else
+        int c = 0;
+        for (uint64_t v = lo; v; v &= v - 1) ++c;
+        for (uint64_t v = hi; v; v &= v - 1) ++c;
+        return c;
+#endif
+    }
+
+    /**
+     * @brief Индекс младшего установленного бита (маска не должна быть пустой)
+     */
+    int lowest() const {
+#if defined(__GNUC__) || defined(__clang__)
+        return lo ? __builtin_ctzll(lo) : 64 + __builtin_ctzll(hi);
+#else
+        for (int i = 0; i < 128; ++i) {
+            if (test(i)) return i;
+        }
+        return -1;
+#endif
+    }
+
+    /**
+     * @brief Сбрасывает младший установленный бит и возвращает его индекс
+     */
+    int popLowest() {
+        int idx = lowest();
+        if (lo) lo &= lo - 1;
+        else hi &= hi - 1;
+        return idx;
+    }
+
+    constexpr BitMask128 shiftLeft(int n) const {
+        if (n == 0) return *this;
+        if (n >= 64) return BitMask128(0, lo << (n - 64));
+        return BitMask128(lo << n, (hi << n) | (lo >> (64 - n)));
+    }
+
+    constexpr BitMask128 shiftRight(int n) const {
+        if (n == 0) return *this;
+        if (n >= 64) return BitMask128(hi >> (n - 64), 0);
+        return BitMask128((lo >> n) | (hi << (64 - n)), hi >> n);
+    }
+
+    constexpr BitMask128 operator|(const BitMask128& o) const { return BitMask128(lo | o.lo, hi | o.hi); }
+    constexpr BitMask128 operator&(const BitMask128& o) const { return BitMask128(lo & o.lo, hi & o.hi); }
+    constexpr BitMask128 operator^(const BitMask128& o) const { return BitMask128(lo ^ o.lo, hi ^ o.hi); }
+    /// Дополнение в пределах поля (биты 100..127 остаются нулевыми)
+    constexpr BitMask128 operator~() const { return BitMask128(~lo, ~hi) & full(); }
+
+    constexpr BitMask128& operator|=(const BitMask128& o) { lo |= o.lo; hi |= o.hi; return *this; }
+    constexpr BitMask128& operator&=(const BitMask128& o) { lo &= o.lo; hi &= o.hi; return *this; }
+    constexpr BitMask128& operator^=(const BitMask128& o) { lo ^= o.lo; hi ^= o.hi; return *this; }
+
+    constexpr bool operator==(const BitMask128& o) const { return lo == o.lo && hi == o.hi; }
+    constexpr bool operator!=(const BitMask128& o) const { return !(*this == o); }
+    /// Сравнение как 128-битных чисел (старшее слово - hi)
+    constexpr bool operator<(const BitMask128& o) const { return hi != o.hi ? hi < o.hi : lo < o.lo; }
+
+    /**
+     * @brief Расширение маски на 8 соседних клеток (маска вместе с ореолом)
+     *
+     * Сдвиги по горизонтали маскируются крайними столбцами, чтобы биты
+     * не переносились на соседнюю строку.
+     */
+    constexpr BitMask128 dilate() const {
+        BitMask128 row = *this
+            | (*this & ~column(SIDE - 1)).shiftLeft(1)
+            | (*this & ~column(0)).shiftRight(1);
+        return (row | row.shiftLeft(SIDE) | row.shiftRight(SIDE)) & full();
+    }
+};
+
+/**
+ * @brief Хеш маски для std::unordered_set / std::unordered_map
+ */
+struct BitMask128Hash {
+    size_t operator()(const BitMask128& m) const {
+        // Перемешивание splitmix64 от обоих слов
+        uint64_t z = m.lo ^ (m.hi * 0x9E3779B97F4A7C15ULL);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        return static_cast<size_t>(z ^ (z >> 31));
+    }
+};
@@ -1,18 +1,24 @@
 #include "board.h"
 #include "fleet.h" // Для использования в placeFleet
+#include "placement_masks.h"
 #include <iostream>
 #include <iomanip>
-#include <algorithm> // для std::all_of
+#include <algorithm> // для std::max
 
 Board::Board() : m_sunkShipCells(0), m_totalShipCells(0) {
     clear();
 }
 
 void Board::clear() {
-    for (auto& row : m_grid) {
-        row.fill(CellState::SEA);
-    }
+    m_shipMask = BitMask128();
+    m_shotMask = BitMask128();
+    m_hitMask = BitMask128();
+    m_sunkMask = BitMask128();
+    m_shipId.fill(NO_SHIP);
     m_ships.clear();
+    m_shipMasks.clear();
+    m_decksLeft.clear();
+    m_lastSunk = SunkShip();
     m_sunkShipCells = 0;
     m_totalShipCells = 0;
 }
@@ -21,13 +27,14 @@ void Board::clear() {
 // Не обновляет m_ships или m_totalShipCells.
 // Используется для обратной совместимости или очень специфичных тестов.
 bool Board::placeShip(int x, int y) {
-    if (x < 0 || x >= BOARD_SIZE || y < 0 || y >= BOARD_SIZE) {
+    if (!inBounds(x, y)) {
         return false;
     }
-    if (m_grid[y][x] != CellState::SEA) { // Можно ставить только на море
+    int idx = BitMask128::index(x, y);
+    if (m_shipMask.test(idx) || m_shotMask.test(idx)) { // Можно ставить только на море
         return false;
     }
-    m_grid[y][x] = CellState::SHIP;
+    m_shipMask.set(idx);
     // В этой упрощенной версии не отслеживаем m_totalShipCells и m_ships
     return true;
 }
@@ -38,37 +45,26 @@ bool Board::placeShip(const Ship& ship) {
         return false;
     }
 
-    // 2. Проверка, что клетки не заняты и нет касаний (по правилам)
-    //    Для этого обойдем все клетки корабля и их соседей.
-    for (const auto& cell : ship.getCells()) {
-        for (int dy = -1; dy <= 1; ++dy) {
-            for (int dx = -1; dx <= 1; ++dx) {
-                int curX = cell.first + dx;
-                int curY = cell.second + dy;
-
-                if (curX >= 0 && curX < BOARD_SIZE && curY >= 0 && curY < BOARD_SIZE) {
-                    // Если это не клетка самого корабля (которую мы собираемся поставить)
-                    // и она не является морем, то это конфликт.
-                    bool isPartOfCurrentShip = false;
-                    for(const auto& ownCell : ship.getCells()){
-                        if(ownCell.first == curX && ownCell.second == curY){
-                            isPartOfCurrentShip = true;
-                            break;
-                        }
-                    }
-                    if (!isPartOfCurrentShip && m_grid[curY][curX] != CellState::SEA) {
-                        return false; // Касание или пересечение с другим кораблем
-                    }
-                }
-            }
-        }
+    // 2. Проверка, что клетки корабля и его ореола - море (по правилам корабли не касаются)
+    const PlacementMask& pm = PlacementMasks::get(ship.getX(), ship.getY(), ship.getLength(), ship.isHorizontal());
+    if (!pm.legal) {
+        return false; // Недопустимая длина корабля
     }
+    if (((pm.body | pm.halo) & (m_shipMask | m_shotMask)).any()) {
+        return false; // Касание или пересечение с другим кораблем
+    }
+    const BitMask128& body = pm.body;
     
     // 3. Размещение корабля
-    for (const auto& cell : ship.getCells()) {
-        m_grid[cell.second][cell.first] = CellState::SHIP;
+    int8_t id = static_cast<int8_t>(m_ships.size());
+    BitMask128 rest = body;
+    while (rest.any()) {
+        m_shipId[rest.popLowest()] = id;
     }
+    m_shipMask |= body;
     m_ships.push_back(ship);
+    m_shipMasks.push_back(body);
+    m_decksLeft.push_back(ship.getLength());
     m_totalShipCells += ship.getLength();
     return true;
 }
@@ -88,57 +84,50 @@ bool Board::placeFleet(const Fleet& fleet) {
 
 
 bool Board::shoot(int x, int y) {
-    if (x < 0 || x >= BOARD_SIZE || y < 0 || y >= BOARD_SIZE) {
+    m_lastSunk = SunkShip();
+    if (!inBounds(x, y)) {
         return false; // Выстрел за пределы поля
     }
 
-    CellState& currentCell = m_grid[y][x];
-
-    if (currentCell == CellState::HIT || currentCell == CellState::MISS || currentCell == CellState::SUNK) {
+    int idx = BitMask128::index(x, y);
+    if (m_shotMask.test(idx)) {
         return false; // Повторный выстрел
     }
+    m_shotMask.set(idx);
 
-    if (currentCell == CellState::SHIP) {
-        currentCell = CellState::HIT;
-        m_sunkShipCells++; // Считаем каждую подбитую палубу
-        
-        // Проверить, потоплен ли корабль, которому принадлежит эта клетка
-        for (const auto& ship : m_ships) {
-            bool hitThisShip = false;
-            for (const auto& shipCell : ship.getCells()) {
-                if (shipCell.first == x && shipCell.second == y) {
-                    hitThisShip = true;
-                    break;
-                }
-            }
-            if (hitThisShip) {
-                if (isShipSunk(ship)) {
-                    markShipAsSunk(ship);
-                }
-                break; 
-            }
-        }
-        return true; // Попадание
-    } else { // currentCell == CellState::SEA
-        currentCell = CellState::MISS;
+    if (!m_shipMask.test(idx)) {
         return false; // Промах
     }
+
+    m_hitMask.set(idx);
+    m_sunkShipCells++; // Считаем каждую подбитую палубу
+
+    // Корабль, которому принадлежит клетка, находим по таблице номеров
+    int id = m_shipId[idx];
+    if (id != NO_SHIP && --m_decksLeft[id] == 0) {
+        m_sunkMask |= m_shipMasks[id];
+        m_lastSunk.cells = m_shipMasks[id];
+        m_lastSunk.halo = m_shipMasks[id].dilate() & ~m_shipMasks[id];
+        m_lastSunk.length = m_ships[id].getLength();
+    }
+    return true; // Попадание
 }
 
 CellState Board::getCell(int x, int y) const {
-    if (x < 0 || x >= BOARD_SIZE || y < 0 || y >= BOARD_SIZE) {
+    if (!inBounds(x, y)) {
         // Можно выбросить исключение или вернуть специальное значение
         return CellState::SEA; // Для простоты вернем SEA
     }
-    return m_grid[y][x];
+    int idx = BitMask128::index(x, y);
+    if (m_sunkMask.test(idx)) return CellState::SUNK;
+    if (m_hitMask.test(idx)) return CellState::HIT;
+    if (m_shotMask.test(idx)) return CellState::MISS;
+    if (m_shipMask.test(idx)) return CellState::SHIP;
+    return CellState::SEA;
 }
 
 bool Board::isShot(int x, int y) const {
-    if (x < 0 || x >= BOARD_SIZE || y < 0 || y >= BOARD_SIZE) {
-        return false;
-    }
-    CellState state = m_grid[y][x];
-    return state == CellState::HIT || state == CellState::MISS || state == CellState::SUNK;
+    return inBounds(x, y) && m_shotMask.test(BitMask128::index(x, y));
 }
 
 bool Board::allShipsSunk() const {
@@ -157,7 +146,7 @@ void Board::print(bool showShips) const {
         std::cout << std::setw(2) << y << " ";
         for (int x = 0; x < BOARD_SIZE; ++x) {
             char symbol = ' ';
-            switch (m_grid[y][x]) {
+            switch (getCell(x, y)) {
                 case CellState::SEA:
                     symbol = '.';
                     break;
@@ -185,34 +174,15 @@ bool Board::wasShotAt(int x, int y) const {
 }
 
 bool Board::wasShipSunkAt(int x, int y) const {
-    if (x < 0 || x >= BOARD_SIZE || y < 0 || y >= BOARD_SIZE) {
-        return false;
-    }
-    return m_grid[y][x] == CellState::SUNK;
-}
-
-bool Board::isShipSunk(const Ship& ship) const {
-    for (const auto& cell : ship.getCells()) {
-        if (m_grid[cell.second][cell.first] == CellState::SHIP) {
-            return false; // Найдена неповрежденная часть корабля
-        }
-    }
-    return true; // Все части корабля либо HIT, либо уже SUNK
-}
-
-void Board::markShipAsSunk(const Ship& ship) {
-    for (const auto& cell : ship.getCells()) {
-        m_grid[cell.second][cell.first] = CellState::SUNK;
-        // Можно также обвести потопленный корабль клетками MISS, если правила это требуют
-        // Это здесь не реализовано для простоты
-    }
+    return inBounds(x, y) && m_sunkMask.test(BitMask128::index(x, y));
 }
 
 bool Board::isCellFree(int x, int y) const {
-    if (x < 0 || x >= BOARD_SIZE || y < 0 || y >= BOARD_SIZE) {
+    if (!inBounds(x, y)) {
         return false; // За пределами поля - не свободно
     }
-    return m_grid[y][x] == CellState::SEA;
+    int idx = BitMask128::index(x, y);
+    return !m_shipMask.test(idx) && !m_shotMask.test(idx);
 }
 
 bool Board::isCellFree(const Cell& cell) const {
@@ -220,9 +190,13 @@ bool Board::isCellFree(const Cell& cell) const {
 }
 
 void Board::markCell(int x, int y) {
-    if (x >= 0 && x < BOARD_SIZE && y >= 0 && y < BOARD_SIZE) {
-        // Можно добавить проверку, что клетка SEA, если нужно
-        m_grid[y][x] = CellState::SHIP; // Или другое состояние, если это общий метод
+    if (inBounds(x, y)) {
+        // Клетка становится неповрежденной палубой (как в устаревшем placeShip)
+        int idx = BitMask128::index(x, y);
+        m_shipMask.set(idx);
+        m_shotMask.reset(idx);
+        m_hitMask.reset(idx);
+        m_sunkMask.reset(idx);
     }
 }
 
@@ -231,8 +205,18 @@ void Board::markCell(const Cell& cell) {
 }
 
 void Board::clearCell(int x, int y) {
-    if (x >= 0 && x < BOARD_SIZE && y >= 0 && y < BOARD_SIZE) {
-        m_grid[y][x] = CellState::SEA;
+    if (inBounds(x, y)) {
+        int idx = BitMask128::index(x, y);
+        int id = m_shipId[idx];
+        // Неподбитая палуба корабля исчезает - у корабля становится меньше палуб
+        if (id != NO_SHIP && !m_hitMask.test(idx)) {
+            --m_decksLeft[id];
+        }
+        m_shipMask.reset(idx);
+        m_shotMask.reset(idx);
+        m_hitMask.reset(idx);
+        m_sunkMask.reset(idx);
+        m_shipId[idx] = NO_SHIP;
     }
 }
 
@@ -241,27 +225,28 @@ void Board::clearCell(const Cell& cell) {
 }
 
 bool Board::markShot(int x, int y) {
-    if (x < 0 || x >= BOARD_SIZE || y < 0 || y >= BOARD_SIZE) {
+    if (!inBounds(x, y)) {
         return false; // Клетка за пределами поля
     }
     
     // Если клетка уже отмечена как выстрел, возвращаем false
-    if (m_grid[y][x] == CellState::HIT || m_grid[y][x] == CellState::MISS || m_grid[y][x] == CellState::SUNK) {
+    int idx = BitMask128::index(x, y);
+    if (m_shotMask.test(idx)) {
         return false;
     }
     
     // Отмечаем клетку как промах (для целей проверки достаточно)
-    m_grid[y][x] = CellState::MISS;
+    m_shotMask.set(idx);
     return true;
 }
 
 // Добавляю метод для определения наибольшего оставшегося корабля
 int Board::largestRemainingShipSize() const {
     int maxLen = 0;
-    for (const auto& ship : m_ships) {
-        if (!isShipSunk(ship)) {
-            maxLen = std::max(maxLen, ship.getLength());
+    for (size_t i = 0; i < m_ships.size(); ++i) {
+        if (m_decksLeft[i] > 0) {
+            maxLen = std::max(maxLen, m_ships[i].getLength());
         }
     }
     return maxLen;
-} 
\ No newline at end of file
+}
\ No newline at end of file
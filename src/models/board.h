@@ -1,9 +1,11 @@
 #pragma once
 
 #include <array>
+#include <cstdint>
 #include "cell.h"
 #include "ship.h"
 #include "fleet.h"
+#include "bitboard.h"
 #include <vector>
 
 /**
@@ -18,14 +20,30 @@ enum class CellState {
     SUNK        ///< Клетка содержит потопленный корабль (для маркировки)
 };
 
+/**
+ * @struct SunkShip
+ * @brief Событие потопления корабля: клетки корабля, его длина и ореол.
+ *
+ * Board::shoot заполняет событие для выстрела, потопившего корабль; стратегии
+ * получают его через доску в notifyShotResult и не ищут корабль обходом поля.
+ */
+struct SunkShip {
+    BitMask128 cells; ///< Клетки потопленного корабля
+    BitMask128 halo;  ///< Соседние клетки (8-связность), где других кораблей быть не может
+    int length = 0;   ///< Длина корабля (0 - последний выстрел ничего не потопил)
+
+    bool any() const { return length > 0; }
+};
+
 /**
  * @class Board
  * @brief Класс, представляющий игровое поле в игре "Морской бой".
  * 
  * Игровое поле представляет собой двумерную сетку 10x10 клеток,
  * каждая из которых может содержать часть корабля или быть пустой.
- * Класс хранит состояние каждой клетки и предоставляет методы для
- * выстрелов и проверки состояния поля.
+ * Состояние хранится в виде 128-битных масок (корабли, выстрелы, попадания,
+ * потопленные клетки), таблицы номеров кораблей по клеткам и счетчиков
+ * оставшихся палуб, поэтому выстрел и проверка потопления выполняются за O(1).
  */
 class Board {
 public:
@@ -155,22 +173,46 @@ public:
      */
     bool wasShipSunkAt(int x, int y) const;
 
+    /**
+     * @brief Корабль, потопленный последним выстрелом shoot
+     * @return Событие потопления; пустое (length == 0), если выстрел ничего не потопил
+     */
+    const SunkShip& lastSunk() const { return m_lastSunk; }
+
     /**
      * @brief Возвращает список клеток с кораблями, по которым еще не было попаданий
      * @return Вектор пар (x, y) с координатами неповрежденных частей кораблей
      */
     std::vector<std::pair<int, int>> getRemainingShipCells() const {
         std::vector<std::pair<int, int>> result;
-        for (int y = 0; y < BOARD_SIZE; ++y) {
-            for (int x = 0; x < BOARD_SIZE; ++x) {
-                if (getCell(x, y) == CellState::SHIP) {
-                    result.emplace_back(x, y);
-                }
-            }
+        BitMask128 rest = m_shipMask & ~m_shotMask;
+        while (rest.any()) {
+            int idx = rest.popLowest();
+            result.emplace_back(idx % BOARD_SIZE, idx / BOARD_SIZE);
         }
         return result;
     }
 
+    /**
+     * @brief Маска клеток с кораблями (включая подбитые)
+     */
+    const BitMask128& shipMask() const { return m_shipMask; }
+
+    /**
+     * @brief Маска обстрелянных клеток
+     */
+    const BitMask128& shotMask() const { return m_shotMask; }
+
+    /**
+     * @brief Маска клеток с попаданиями (включая потопленные)
+     */
+    const BitMask128& hitMask() const { return m_hitMask; }
+
+    /**
+     * @brief Маска клеток потопленных кораблей
+     */
+    const BitMask128& sunkMask() const { return m_sunkMask; }
+
     /**
      * @brief Отметить выстрел по клетке для проверочной доски (не для реальной игры)
      * @param x X-координата клетки
@@ -186,13 +228,22 @@ public:
     int largestRemainingShipSize() const;
 
 private:
-    std::array<std::array<CellState, BOARD_SIZE>, BOARD_SIZE> m_grid;
-    std::vector<Ship> m_ships; // Храним размещенные корабли
+    static constexpr int8_t NO_SHIP = -1; ///< Клетка не принадлежит полноценному кораблю
+
+    BitMask128 m_shipMask;  // Клетки с кораблями
+    BitMask128 m_shotMask;  // Обстрелянные клетки (HIT, MISS, SUNK)
+    BitMask128 m_hitMask;   // Клетки с попаданиями по кораблям
+    BitMask128 m_sunkMask;  // Клетки потопленных кораблей
+    std::array<int8_t, BOARD_SIZE * BOARD_SIZE> m_shipId; // Номер корабля в m_ships для каждой клетки
+    std::vector<Ship> m_ships;             // Храним размещенные корабли
+    std::vector<BitMask128> m_shipMasks;   // Маски клеток каждого корабля (параллельно m_ships)
+    std::vector<int> m_decksLeft;          // Количество неподбитых палуб каждого корабля
+    SunkShip m_lastSunk;                   // Корабль, потопленный последним выстрелом
     int m_sunkShipCells;       // Общее количество потопленных палуб (для allShipsSunk)
     int m_totalShipCells;      // Общее количество палуб всех размещенных кораблей
 
-    // Вспомогательная функция для проверки, потоплен ли корабль
-    bool isShipSunk(const Ship& ship) const;
-    // Вспомогательная функция для обновления состояния клеток потопленного корабля
-    void markShipAsSunk(const Ship& ship);
-}; 
\ No newline at end of file
+    // Проверка координат на принадлежность полю
+    static bool inBounds(int x, int y) {
+        return x >= 0 && x < BOARD_SIZE && y >= 0 && y < BOARD_SIZE;
+    }
+};
\ No newline at end of file
@@ -1,5 +1,6 @@
 #include "fleet.h"
 #include "board.h"
+#include "placement_masks.h"
 #include "../utils/rng.h"
 #include <algorithm>
 #include <stdexcept>
@@ -36,6 +37,16 @@ bool Fleet::isValid(int boardSize) const {
     if (m_ships.empty()) {
         return true; 
     }
+    // Для стандартного поля 10x10 проверяем по таблице масок: одна операция AND на корабль
+    if (boardSize == BitMask128::SIDE) {
+        FleetMask mask;
+        for (const auto& ship : m_ships) {
+            if (!mask.tryAdd(ship.getX(), ship.getY(), ship.getLength(), ship.isHorizontal())) {
+                return false; // Выход за поле, пересечение или касание
+            }
+        }
+        return true;
+    }
     for (const auto& ship : m_ships) {
         if (!ship.isWithinBounds(boardSize)) {
             // std::cout << "Ship out of bounds: (" << ship.getX() << "," << ship.getY() << ") len=" << ship.getLength() << " vert=" << ship.getIsVertical() << " board=" << boardSize << std::endl;
@@ -0,0 +1,160 @@
+#pragma once
+
+#include "bitboard.h"
+#include <array>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+/**
+ * @class BitSlicedCounter
+ * @brief Побитово-срезанные ("вертикальные") счетчики клеток для сумм масок.
+ *
+ * Счетчик каждой из 100 клеток хранится в двоичном виде поперек плоскостей:
+ * бит p счетчика клетки idx - это бит idx маски planes[p]. Добавление маски
+ * обновляет все клетки сразу операциями над 128-битными словами.
+ *
+ * Маски копятся пачками по 8 и сворачиваются схемой Харли-Сила: семь
+ * сумматоров с сохранением переноса (CSA) обновляют плоскости 1, 2 и 4,
+ * и лишь перенос веса 8 распространяется по старшим плоскостям. Так на
+ * образец приходится около десятка логических операций вместо
+ * инкремента каждой клетки.
+ */
+class BitSlicedCounter {
+public:
+    static constexpr int PLANES = 31; ///< Разрядность счетчиков (до 2^31 - 1, помещается в int)
+
+    /**
+     * @brief Добавляет маску (каждая ее клетка увеличивается на 1)
+     */
+    void add(const BitMask128& mask) {
+        m_pending[m_pendingCount++] = mask;
+        if (m_pendingCount == PENDING) {
+            foldPending();
+        }
+    }
+
+    /**
+     * @brief Добавляет маску с весом 2^plane
+     */
+    void addAt(BitMask128 carry, int plane) {
+        for (int p = plane; carry.any() && p < PLANES; ++p) {
+            BitMask128 next = m_planes[p] & carry;
+            m_planes[p] ^= carry;
+            carry = next;
+        }
+    }
+
+    /**
+     * @brief Переносит суммы в обычные счетчики: out[idx] += count(idx)
+     */
+    template <typename Int>
+    void addTo(std::array<Int, BitMask128::CELLS>& out) {
+        flush();
+        for (int p = 0; p < PLANES; ++p) {
+            BitMask128 bits = m_planes[p];
+            const Int weight = static_cast<Int>(1) << p;
+            while (bits.any()) {
+                out[bits.popLowest()] += weight;
+            }
+        }
+    }
+
+    /**
+     * @brief Обнуляет все счетчики
+     */
+    void clear() {
+        m_planes.fill(BitMask128());
+        m_pendingCount = 0;
+    }
+
+private:
+    static constexpr int PENDING = 8;
+
+    std::array<BitMask128, PLANES> m_planes{};   ///< m_planes[p] - бит p счетчиков
+    std::array<BitMask128, PENDING> m_pending{}; ///< Маски, ожидающие свертки
+    int m_pendingCount = 0;
+
+    /// Сумматор с сохранением переноса: a + b + c = 2 * high + low
+    static void csa(BitMask128& high, BitMask128& low,
+                    const BitMask128& a, const BitMask128& b, const BitMask128& c) {
+        const BitMask128 u = a ^ b;
+        high = (a & b) | (u & c);
+        low = u ^ c;
+    }
+
+    void foldPending() {
+        BitMask128& ones = m_planes[0];
+        BitMask128& twos = m_planes[1];
+        BitMask128& fours = m_planes[2];
+        BitMask128 twosA, twosB, foursA, foursB, eights;
+        csa(twosA, ones, ones, m_pending[0], m_pending[1]);
+        csa(twosB, ones, ones, m_pending[2], m_pending[3]);
+        csa(foursA, twos, twos, twosA, twosB);
+        csa(twosA, ones, ones, m_pending[4], m_pending[5]);
+        csa(twosB, ones, ones, m_pending[6], m_pending[7]);
+        csa(foursB, twos, twos, twosA, twosB);
+        csa(eights, fours, fours, foursA, foursB);
+        addAt(eights, 3);
+        m_pendingCount = 0;
+    }
+
+    void flush() {
+        for (int i = 0; i < m_pendingCount; ++i) {
+            addAt(m_pending[i], 0);
+        }
+        m_pendingCount = 0;
+    }
+};
+
+namespace HeatmapOps {
+
+/**
+ * @brief Индекс максимального значения среди разрешенных клеток
+ *
+ * При равенстве выбирается клетка с меньшим индексом (первая в порядке
+ * обхода по строкам). Циклы без ветвлений рассчитаны на автовекторизацию:
+ * запрещенные клетки заменяются на -1, затем ищется максимум и его позиция.
+ *
+ * @param values Значения клеток (неотрицательные)
+ * @param allowed Маска разрешенных клеток
+ * @return Индекс клетки или -1, если разрешенных клеток нет
+ */
+inline int maskedArgmax(const std::array<int, BitMask128::CELLS>& values, const BitMask128& allowed) {
+    std::array<int, BitMask128::CELLS> masked;
+    for (int i = 0; i < 64; ++i) {
+        const int keep = -static_cast<int>((allowed.lo >> i) & 1u);
+        masked[i] = (values[i] & keep) | ~keep;
+    }
+    for (int i = 64; i < BitMask128::CELLS; ++i) {
+        const int keep = -static_cast<int>((allowed.hi >> (i - 64)) & 1u);
+        masked[i] = (values[i] & keep) | ~keep;
+    }
+
+    int best = -1;
+    for (int i = 0; i < BitMask128::CELLS; ++i) {
+        best = std::max(best, masked[i]);
+    }
+    if (best < 0) return -1;
+
+    int index = BitMask128::CELLS;
+    for (int i = BitMask128::CELLS - 1; i >= 0; --i) {
+        index = masked[i] == best ? i : index;
+    }
+    return index;
+}
+
+/**
+ * @brief Переводит карту в 16-битные значения, нормированные к максимуму 65535
+ *
+ * Формат хранения карт в дебютной книге и таблице карт.
+ */
+inline void quantize(const std::array<int, BitMask128::CELLS>& heat, std::array<uint16_t, BitMask128::CELLS>& out) {
+    const int maxHeat = std::max(1, *std::max_element(heat.begin(), heat.end()));
+    for (int idx = 0; idx < BitMask128::CELLS; ++idx) {
+        const double scaled = std::max(0, heat[idx]) * 65535.0 / maxHeat;
+        out[idx] = static_cast<uint16_t>(std::lround(scaled));
+    }
+}
+
+} // namespace HeatmapOps
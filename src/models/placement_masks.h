@@ -0,0 +1,118 @@
+#pragma once
+
+#include "bitboard.h"
+#include <array>
+
+/**
+ * @struct PlacementMask
+ * @brief Маски одной позиции корабля: клетки корпуса и окружающий их ореол.
+ */
+struct PlacementMask {
+    BitMask128 body;    ///< Клетки корабля
+    BitMask128 halo;    ///< Соседние клетки (8-связность) без клеток самого корабля
+    bool legal = false; ///< Корабль целиком помещается на поле 10x10
+};
+
+/**
+ * @brief Таблица масок всех позиций кораблей, вычисляемая на этапе компиляции.
+ *
+ * Для каждой пары (x, y), длины 1..MAX_SHIP_LENGTH и ориентации хранится
+ * PlacementMask. Проверка "корабль помещается и не касается других" сводится
+ * к одной операции AND с накопленной маской флота (см. FleetMask).
+ */
+namespace PlacementMasks {
+
+constexpr int MAX_SHIP_LENGTH = 4;
+constexpr int ENTRIES = MAX_SHIP_LENGTH * 2 * BitMask128::CELLS;
+
+/**
+ * @brief Индекс позиции в таблице (аргументы должны быть в допустимых пределах)
+ */
+constexpr int slot(int x, int y, int len, bool horizontal) {
+    return ((len - 1) * 2 + (horizontal ? 1 : 0)) * BitMask128::CELLS + BitMask128::index(x, y);
+}
+
+constexpr PlacementMask makeEntry(int x, int y, int len, bool horizontal) {
+    PlacementMask m;
+    int endX = x + (horizontal ? len - 1 : 0);
+    int endY = y + (horizontal ? 0 : len - 1);
+    if (endX >= BitMask128::SIDE || endY >= BitMask128::SIDE) {
+        return m; // Корабль выходит за поле
+    }
+    for (int i = 0; i < len; ++i) {
+        m.body.set(BitMask128::index(x + (horizontal ? i : 0), y + (horizontal ? 0 : i)));
+    }
+    m.halo = m.body.dilate() & ~m.body;
+    m.legal = true;
+    return m;
+}
+
+constexpr std::array<PlacementMask, ENTRIES> buildTable() {
+    std::array<PlacementMask, ENTRIES> table{};
+    for (int len = 1; len <= MAX_SHIP_LENGTH; ++len) {
+        for (int hor = 0; hor <= 1; ++hor) {
+            for (int y = 0; y < BitMask128::SIDE; ++y) {
+                for (int x = 0; x < BitMask128::SIDE; ++x) {
+                    table[slot(x, y, len, hor == 1)] = makeEntry(x, y, len, hor == 1);
+                }
+            }
+        }
+    }
+    return table;
+}
+
+inline constexpr std::array<PlacementMask, ENTRIES> TABLE = buildTable();
+inline constexpr PlacementMask ILLEGAL{};
+
+/**
+ * @brief Маски позиции корабля; для позиций вне поля возвращает запись с legal == false
+ * @param x X-координата начала корабля
+ * @param y Y-координата начала корабля
+ * @param len Длина корабля
+ * @param horizontal Ориентация (true - горизонтальная, false - вертикальная)
+ */
+constexpr const PlacementMask& get(int x, int y, int len, bool horizontal) {
+    if (x < 0 || x >= BitMask128::SIDE || y < 0 || y >= BitMask128::SIDE ||
+        len < 1 || len > MAX_SHIP_LENGTH) {
+        return ILLEGAL;
+    }
+    return TABLE[slot(x, y, len, horizontal)];
+}
+
+} // namespace PlacementMasks
+
+/**
+ * @struct FleetMask
+ * @brief Накопитель масок флота для проверки правил расстановки.
+ *
+ * Корабль можно добавить, если его корпус не пересекается с blocked -
+ * объединением корпусов и ореолов уже добавленных кораблей.
+ */
+struct FleetMask {
+    BitMask128 body;    ///< Клетки всех добавленных кораблей
+    BitMask128 blocked; ///< Клетки кораблей вместе с их ореолами
+
+    bool fits(const PlacementMask& m) const {
+        return m.legal && (m.body & blocked).none();
+    }
+
+    bool fits(int x, int y, int len, bool horizontal) const {
+        return fits(PlacementMasks::get(x, y, len, horizontal));
+    }
+
+    void add(const PlacementMask& m) {
+        body |= m.body;
+        blocked |= m.body | m.halo;
+    }
+
+    /**
+     * @brief Добавляет корабль, если он помещается по правилам
+     * @return true, если корабль добавлен
+     */
+    bool tryAdd(int x, int y, int len, bool horizontal) {
+        const PlacementMask& m = PlacementMasks::get(x, y, len, horizontal);
+        if (!fits(m)) return false;
+        add(m);
+        return true;
+    }
+};
@@ -0,0 +1,71 @@
+#pragma once
+
+#include "board.h"
+#include "fleet.h"
+#include <algorithm>
+#include <vector>
+
+/**
+ * @class RemainingFleet
+ * @brief Непотопленные корабли противника с точки зрения стреляющего.
+ *
+ * Обновляется по событиям потопления (SunkShip) за O(1): вычеркивает длину
+ * потопленного корабля и накапливает маски потопленных клеток и их ореолов.
+ * Заменяет в стратегиях повторный поиск потопленных кораблей обходом поля.
+ */
+class RemainingFleet {
+public:
+    RemainingFleet() { reset(); }
+
+    /**
+     * @brief Возвращает стандартный флот в начальное состояние
+     */
+    void reset() {
+        m_lengths.assign(Fleet::standardShipLengths.begin(), Fleet::standardShipLengths.end());
+        m_sunk = BitMask128();
+        m_halo = BitMask128();
+    }
+
+    /**
+     * @brief Учитывает потопленный корабль
+     * @param ship Событие потопления (пустое событие игнорируется)
+     * @return true, если корабль такой длины еще оставался во флоте
+     */
+    bool update(const SunkShip& ship) {
+        if (!ship.any()) return false;
+        m_sunk |= ship.cells;
+        m_halo = (m_halo | ship.halo) & ~m_sunk;
+        auto it = std::find(m_lengths.begin(), m_lengths.end(), ship.length);
+        if (it == m_lengths.end()) return false;
+        m_lengths.erase(it);
+        return true;
+    }
+
+    /**
+     * @brief Длины непотопленных кораблей (по убыванию)
+     */
+    const std::vector<int>& lengths() const { return m_lengths; }
+
+    bool empty() const { return m_lengths.empty(); }
+    size_t size() const { return m_lengths.size(); }
+
+    /**
+     * @brief Длина наибольшего непотопленного корабля или 0, если флот потоплен
+     */
+    int largest() const { return m_lengths.empty() ? 0 : m_lengths.front(); }
+
+    /**
+     * @brief Маска клеток потопленных кораблей
+     */
+    const BitMask128& sunkCells() const { return m_sunk; }
+
+    /**
+     * @brief Маска ореолов потопленных кораблей (клетки, где кораблей быть не может)
+     */
+    const BitMask128& halo() const { return m_halo; }
+
+private:
+    std::vector<int> m_lengths; ///< Длины непотопленных кораблей (по убыванию)
+    BitMask128 m_sunk;          ///< Клетки потопленных кораблей
+    BitMask128 m_halo;          ///< Ореолы потопленных кораблей
+};
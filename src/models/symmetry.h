@@ -0,0 +1,123 @@
+#pragma once
+
+#include "bitboard.h"
+#include <array>
+#include <cstdint>
+#include <initializer_list>
+
+/**
+ * @brief Симметрии квадратного поля 10x10 (группа диэдра из 8 элементов).
+ *
+ * Преобразование t (0..7) задается битами: бит 2 - транспонирование (x <-> y),
+ * бит 0 - отражение по X, бит 1 - отражение по Y. Против симметричных стрелков
+ * (Random, Checkerboard, Monte-Carlo) симметричные расстановки имеют одинаковый
+ * ожидаемый фитнес, поэтому их удобно сравнивать по канонической маске.
+ */
+namespace BoardSymmetry {
+
+constexpr int COUNT = 8;
+
+/**
+ * @brief Индекс клетки после преобразования t
+ */
+constexpr int transformIndex(int t, int idx) {
+    int x = idx % BitMask128::SIDE;
+    int y = idx / BitMask128::SIDE;
+    if (t & 4) { int tmp = x; x = y; y = tmp; }
+    if (t & 1) x = BitMask128::SIDE - 1 - x;
+    if (t & 2) y = BitMask128::SIDE - 1 - y;
+    return BitMask128::index(x, y);
+}
+
+constexpr std::array<std::array<uint8_t, BitMask128::CELLS>, COUNT> buildTable() {
+    std::array<std::array<uint8_t, BitMask128::CELLS>, COUNT> table{};
+    for (int t = 0; t < COUNT; ++t) {
+        for (int idx = 0; idx < BitMask128::CELLS; ++idx) {
+            table[t][idx] = static_cast<uint8_t>(transformIndex(t, idx));
+        }
+    }
+    return table;
+}
+
+inline constexpr std::array<std::array<uint8_t, BitMask128::CELLS>, COUNT> TABLE = buildTable();
+
+/**
+ * @brief Применяет преобразование t к маске (перебором установленных битов)
+ */
+inline BitMask128 apply(BitMask128 mask, int t) {
+    BitMask128 out;
+    const auto& map = TABLE[t];
+    while (mask.any()) {
+        out.set(map[mask.popLowest()]);
+    }
+    return out;
+}
+
+/**
+ * @brief Каноническая форма маски: минимальная из 8 симметричных масок
+ *
+ * Для корректной расстановки маска клеток кораблей однозначно задает
+ * расстановку (с точностью до перестановки кораблей одной длины), поэтому
+ * каноническая маска служит 128-битным ключом класса симметричных расстановок.
+ */
+inline BitMask128 canonical(const BitMask128& mask) {
+    BitMask128 best = mask;
+    for (int t = 1; t < COUNT; ++t) {
+        BitMask128 candidate = apply(mask, t);
+        if (candidate < best) {
+            best = candidate;
+        }
+    }
+    return best;
+}
+
+/**
+ * @brief Преобразования, переводящие в себя каждую из масок
+ *
+ * @return Бит t установлен, если apply(mask, t) == mask для всех масок
+ *         (бит 0 - тождественное преобразование - установлен всегда)
+ */
+inline uint8_t stabilizer(std::initializer_list<BitMask128> masks) {
+    uint8_t group = 1;
+    for (int t = 1; t < COUNT; ++t) {
+        bool invariant = true;
+        for (const BitMask128& mask : masks) {
+            if (apply(mask, t) != mask) {
+                invariant = false;
+                break;
+            }
+        }
+        if (invariant) group |= static_cast<uint8_t>(1u << t);
+    }
+    return group;
+}
+
+/**
+ * @brief Число преобразований в группе (установленных битов)
+ */
+constexpr int groupSize(uint8_t group) {
+    int size = 0;
+    for (int t = 0; t < COUNT; ++t) size += (group >> t) & 1;
+    return size;
+}
+
+/**
+ * @brief Сворачивает карту по группе: каждая клетка получает сумму значений своих образов
+ *
+ * Если группа сохраняет наблюдения, свернутая карта совпадает с картой выборки,
+ * в которой каждый образец дополнен всеми своими симметричными образами.
+ */
+template <typename Int>
+inline void fold(std::array<Int, BitMask128::CELLS>& heat, uint8_t group) {
+    std::array<Int, BitMask128::CELLS> folded{};
+    for (int t = 0; t < COUNT; ++t) {
+        if (!((group >> t) & 1)) continue;
+        const auto& map = TABLE[t];
+        for (int idx = 0; idx < BitMask128::CELLS; ++idx) {
+            folded[idx] += heat[map[idx]];
+        }
+    }
+    heat = folded;
+}
+
+} // namespace BoardSymmetry
@@ -70,7 +70,7 @@ bool Game::step() {
     }
     
     bool hit1 = board2.shoot(shot1.first, shot1.second);
-    bool sunk1 = hit1 && board2.wasShipSunkAt(shot1.first, shot1.second);
+    bool sunk1 = hit1 && board2.lastSunk().any();
     player1Shots++;
     
     strategy1->notifyShotResult(shot1.first, shot1.second, hit1, sunk1, board2);
@@ -90,7 +90,7 @@ bool Game::step() {
     }
     
     bool hit2 = board1.shoot(shot2.first, shot2.second);
-    bool sunk2 = hit2 && board1.wasShipSunkAt(shot2.first, shot2.second);
+    bool sunk2 = hit2 && board1.lastSunk().any();
     player2Shots++;
     
     strategy2->notifyShotResult(shot2.first, shot2.second, hit2, sunk2, board1);
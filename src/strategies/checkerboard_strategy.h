@@ -1,13 +1,13 @@
 #pragma once
 
 #include "strategy.h"
+#include "../models/remaining_fleet.h"
 #include "../utils/rng.h"
 #include <string>
 #include <vector>
 #include <utility>
 #include <queue>
 #include <algorithm>
-#include <set>
 
 /**
  * @brief Стратегия шахматной доски с добиванием (Hunt-Target)
@@ -32,7 +32,7 @@ private:
     std::queue<std::pair<int, int>> targetQueue; ///< Очередь клеток для добивания
     RNG m_rng;                                  ///< Генератор случайных чисел
     bool preferEvenParity;                      ///< Предпочтение четной четности (черные клетки)
-    std::set<std::pair<int, int>> excludedCells; ///< Клетки, исключенные из стрельбы (вокруг потопленных кораблей)
+    RemainingFleet m_fleet;                     ///< Потопленные корабли; их ореолы исключены из стрельбы
     
     // Направления для проверки соседних клеток (вверх, вправо, вниз, влево)
     std::vector<std::pair<int, int>> directions = {
@@ -71,7 +71,18 @@ private:
     bool isAvailableCell(int x, int y) const {
         return isValidCell(x, y) && 
                std::find(shots.begin(), shots.end(), std::make_pair(x, y)) == shots.end() &&
-               excludedCells.find(std::make_pair(x, y)) == excludedCells.end();
+               !isExcluded(x, y);
+    }
+    
+    /**
+     * @brief Проверяет, лежит ли клетка в ореоле потопленного корабля
+     * 
+     * @param x X-координата клетки
+     * @param y Y-координата клетки
+     * @return true, если в клетке не может быть корабля
+     */
+    bool isExcluded(int x, int y) const {
+        return isValidCell(x, y) && m_fleet.halo().test(BitMask128::index(x, y));
     }
     
     /**
@@ -115,12 +126,12 @@ private:
         if (isVertical) {
             // Проверка сверху
             if (isValidCell(minX, minY - 1) && !board.wasShotAt(minX, minY - 1) &&
-                excludedCells.find(std::make_pair(minX, minY - 1)) == excludedCells.end()) {
+                !isExcluded(minX, minY - 1)) {
                 targetQueue.push({minX, minY - 1});
             }
             // Проверка снизу
             if (isValidCell(minX, maxY + 1) && !board.wasShotAt(minX, maxY + 1) &&
-                excludedCells.find(std::make_pair(minX, maxY + 1)) == excludedCells.end()) {
+                !isExcluded(minX, maxY + 1)) {
                 targetQueue.push({minX, maxY + 1});
             }
         } 
@@ -128,12 +139,12 @@ private:
         else if (isHorizontal) {
             // Проверка слева
             if (isValidCell(minX - 1, minY) && !board.wasShotAt(minX - 1, minY) &&
-                excludedCells.find(std::make_pair(minX - 1, minY)) == excludedCells.end()) {
+                !isExcluded(minX - 1, minY)) {
                 targetQueue.push({minX - 1, minY});
             }
             // Проверка справа
             if (isValidCell(maxX + 1, minY) && !board.wasShotAt(maxX + 1, minY) &&
-                excludedCells.find(std::make_pair(maxX + 1, minY)) == excludedCells.end()) {
+                !isExcluded(maxX + 1, minY)) {
                 targetQueue.push({maxX + 1, minY});
             }
         }
@@ -145,7 +156,7 @@ private:
                 int newY = y + dir.second;
                 
                 if (isValidCell(newX, newY) && !board.wasShotAt(newX, newY) &&
-                    excludedCells.find(std::make_pair(newX, newY)) == excludedCells.end()) {
+                    !isExcluded(newX, newY)) {
                     targetQueue.push({newX, newY});
                 }
             }
@@ -164,7 +175,7 @@ private:
         for (int y = 0; y < boardSize; ++y) {
             for (int x = 0; x < boardSize; ++x) {
                 if (!board.wasShotAt(x, y) && ((x + y) % 2 == parity) &&
-                    excludedCells.find(std::make_pair(x, y)) == excludedCells.end()) {
+                    !isExcluded(x, y)) {
                     cells.emplace_back(x, y);
                 }
             }
@@ -188,71 +199,10 @@ private:
      * @brief Помечает клетки вокруг потопленного корабля как недоступные для выстрелов
      * Основан на правиле "no-touch" - корабли не могут касаться друг друга
      * 
-     * @param board Текущее состояние игрового поля
+     * @param ship Событие потопления (клетки корабля и его ореол сообщает доска)
      */
-    void markSurroundingCellsAsUnavailable(const Board& board) {
-        // Временная матрица для отслеживания посещенных клеток
-        std::vector<std::vector<bool>> visited(boardSize, std::vector<bool>(boardSize, false));
-        
-        // Находим все потопленные корабли на доске
-        for (int y = 0; y < boardSize; ++y) {
-            for (int x = 0; x < boardSize; ++x) {
-                if (board.isShot(x, y) && board.wasShipSunkAt(x, y) && !visited[y][x]) {
-                    // Нашли потопленный корабль, определяем его размер и ориентацию
-                    std::vector<std::pair<int, int>> shipCells;
-                    
-                    // Проверяем горизонтальную ориентацию
-                    bool isHorizontal = (x + 1 < boardSize && board.isShot(x + 1, y) && 
-                                         board.wasShipSunkAt(x + 1, y));
-                    
-                    // Проверяем вертикальную ориентацию
-                    bool isVertical = (y + 1 < boardSize && board.isShot(x, y + 1) && 
-                                       board.wasShipSunkAt(x, y + 1));
-                    
-                    if (isHorizontal) {
-                        // Собираем все клетки горизонтального корабля
-                        int xx = x;
-                        while (xx < boardSize && board.isShot(xx, y) && board.wasShipSunkAt(xx, y)) {
-                            shipCells.emplace_back(xx, y);
-                            visited[y][xx] = true;
-                            xx++;
-                        }
-                    } else if (isVertical) {
-                        // Собираем все клетки вертикального корабля
-                        int yy = y;
-                        while (yy < boardSize && board.isShot(x, yy) && board.wasShipSunkAt(x, yy)) {
-                            shipCells.emplace_back(x, yy);
-                            visited[yy][x] = true;
-                            yy++;
-                        }
-                    } else {
-                        // Одноклеточный корабль
-                        shipCells.emplace_back(x, y);
-                        visited[y][x] = true;
-                    }
-                    
-                    // Теперь помечаем все окружающие клетки как недоступные для выстрелов
-                    for (const auto& cell : shipCells) {
-                        int cellX = cell.first;
-                        int cellY = cell.second;
-                        
-                        // Проходим по всем соседним клеткам (включая диагональные)
-                        for (int dy = -1; dy <= 1; ++dy) {
-                            for (int dx = -1; dx <= 1; ++dx) {
-                                int nx = cellX + dx;
-                                int ny = cellY + dy;
-                                
-                                // Проверяем, что клетка внутри границ и не является частью корабля
-                                if (isValidCell(nx, ny) && 
-                                    !(board.isShot(nx, ny) && board.wasShipSunkAt(nx, ny))) {
-                                    excludedCells.emplace(nx, ny);
-                                }
-                            }
-                        }
-                    }
-                }
-            }
-        }
+    void markSurroundingCellsAsUnavailable(const SunkShip& ship) {
+        m_fleet.update(ship);
     }
     
 public:
@@ -304,14 +254,14 @@ public:
             // Проверяем, доступна ли она (может быть уже обстреляна или исключена)
             while (!targetQueue.empty() && 
                    (board.wasShotAt(nextShot.first, nextShot.second) || 
-                    excludedCells.find(nextShot) != excludedCells.end())) {
+                    isExcluded(nextShot.first, nextShot.second))) {
                 nextShot = targetQueue.front();
                 targetQueue.pop();
             }
             
             // Если нашли доступную клетку, используем её
             if (!board.wasShotAt(nextShot.first, nextShot.second) && 
-                excludedCells.find(nextShot) == excludedCells.end()) {
+                !isExcluded(nextShot.first, nextShot.second)) {
                 shots.push_back(nextShot);
                 return nextShot;
             }
@@ -367,7 +317,7 @@ public:
             
         if (sunk) {
             // Корабль потоплен, помечаем клетки вокруг него как недоступные
-            markSurroundingCellsAsUnavailable(board);
+            markSurroundingCellsAsUnavailable(board.lastSunk());
             
             // Очищаем очередь и переходим в режим поиска
             std::queue<std::pair<int, int>> emptyQueue;
@@ -400,8 +350,8 @@ public:
         std::queue<std::pair<int, int>> emptyQueue;
         targetQueue.swap(emptyQueue);
         
-        // Очистка списка исключенных клеток
-        excludedCells.clear();
+        // Очистка исключенных клеток вместе с потопленными кораблями
+        m_fleet.reset();
         
         currentMode = Mode::HUNT;
         
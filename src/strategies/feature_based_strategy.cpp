@@ -5,42 +5,33 @@
 #include <random>
 #include <iostream>
 
-FeatureBasedStrategy::FeatureBasedStrategy(const std::vector<double>& weights)
-    : m_weights(weights), m_iteration(0)
+FeatureBasedStrategy::FeatureBasedStrategy(const std::vector<double>& weights,
+                                           std::shared_ptr<const PlacementPool> pool)
+    : m_weights(weights), m_scorer(weights), m_iteration(0),
+      m_pool(pool ? std::move(pool) : std::make_shared<const PlacementPool>())
 {
     // Проверка на соответствие количества весов 
     if (weights.size() != Features::FEATURE_COUNT) {
         throw std::invalid_argument("Неверное количество весов для стратегии на основе признаков");
     }
+    m_heat.reset(*m_pool);
 }
 
 std::pair<int, int> FeatureBasedStrategy::getNextShot(const Board& board) {
-    // Поиск непростреленной клетки с максимальной оценкой
-    double maxScore = -std::numeric_limits<double>::max();
-    Cell bestCell{0, 0};
-    bool found = false;
-
-    // Проверяем все клетки на доске
-    int availableCells = 0;
-    for (int y = 0; y < 10; ++y) {
-        for (int x = 0; x < 10; ++x) {
-            // Пропускаем клетки, по которым уже стреляли
-            if (board.isShot(x, y)) {
-                continue;
-            }
-            
-            availableCells++;
-
-            Cell cell{x, y};
-            double score = scoreCell(cell, board);
-
-            if (score > maxScore) {
-                maxScore = score;
-                bestCell = cell;
-                found = true;
-            }
-        }
+    // Признаки всех непростреленных клеток считаются разом (только нужные
+    // оценке), затем выбирается клетка с максимальной взвешенной суммой
+    const BitMask128 available = ~board.shotMask();
+    const int availableCells = available.count();
+    if (m_shotHistory.empty()) {
+        m_tracker.reset(board.shipMask());
     }
+    m_planes.compute(m_tracker, m_heat, m_iteration, available, m_scorer.features());
+
+    float maxScore = 0.0f;
+    const int bestIdx = m_scorer.argmax(m_planes, m_iteration, available, maxScore);
+    const bool found = bestIdx >= 0;
+    const Cell bestCell = found
+        ? Cell{bestIdx % BitMask128::SIDE, bestIdx / BitMask128::SIDE} : Cell{0, 0};
 
     // Если все клетки прострелены, возвращаем случайную
     if (!found) {
@@ -71,12 +62,18 @@ void FeatureBasedStrategy::notifyShotResult(int x, int y, bool hit, bool sunk, c
         result = ShotResult::MISS;
     }
     
+    if (m_shotHistory.empty()) {
+        m_tracker.reset(board.shipMask());
+    }
     m_shotHistory.push_back({Cell{x, y}, result});
+    m_tracker.observe(x, y, result);
+    m_heat.observe(BitMask128::index(x, y), hit);
 }
 
 void FeatureBasedStrategy::reset() {
     m_shotHistory.clear();
     m_iteration = 0;
+    m_heat.reset(*m_pool);
 }
 
 std::vector<std::pair<int, int>> FeatureBasedStrategy::getAllShots() const {
@@ -89,19 +86,3 @@ std::vector<std::pair<int, int>> FeatureBasedStrategy::getAllShots() const {
     
     return shots;
 }
-
-double FeatureBasedStrategy::scoreCell(const Cell& cell, const Board& board) const {
-    // Создаем объект Features для вычисления признаков
-    Features features(board, m_shotHistory, m_pool, m_iteration);
-    
-    // Получаем значения всех признаков для клетки
-    auto featureValues = features.getFeatures(cell);
-    
-    // Вычисляем взвешенную сумму
-    double score = 0.0;
-    for (size_t i = 0; i < featureValues.size() && i < m_weights.size(); ++i) {
-        score += featureValues[i] * m_weights[i];
-    }
-    
-    return score;
-} 
\ No newline at end of file
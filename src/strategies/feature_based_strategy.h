@@ -18,8 +18,10 @@ public:
     /**
      * @brief Конструктор стратегии с указанными весами признаков
      * @param weights Веса признаков (должен содержать 20 значений)
+     * @param pool Пул расстановок для признака Heat (nullptr - пустой пул)
      */
-    explicit FeatureBasedStrategy(const std::vector<double>& weights);
+    explicit FeatureBasedStrategy(const std::vector<double>& weights,
+                                  std::shared_ptr<const PlacementPool> pool = nullptr);
 
     /**
      * @brief Определяет клетку для следующего выстрела
@@ -59,6 +61,9 @@ private:
     // Веса признаков из DecisionGA
     std::vector<double> m_weights;
     
+    // Оценка клеток, собранная из весов: статические признаки свернуты, нулевые веса отброшены
+    FeatureScorer m_scorer;
+    
     // История выстрелов и результатов
     std::vector<std::pair<Cell, ShotResult>> m_shotHistory;
     
@@ -66,13 +71,14 @@ private:
     int m_iteration;
     
     // Пул расстановок для вычисления признаков
-    PlacementPool m_pool;
+    std::shared_ptr<const PlacementPool> m_pool;
     
-    /**
-     * @brief Вычисляет оценку для клетки на основе взвешенных признаков
-     * @param cell Клетка для оценки
-     * @param board Текущее состояние доски
-     * @return Оценка клетки
-     */
-    double scoreCell(const Cell& cell, const Board& board) const;
+    // Расстановки пула, согласованные с выстрелами текущей партии
+    PlacementHeatIndex m_heat;
+    
+    // Признаки партии, обновляемые после каждого выстрела
+    FeatureTracker m_tracker;
+    
+    // Плоскости признаков текущего хода
+    FeaturePlanes m_planes;
 }; 
\ No newline at end of file
@@ -3,8 +3,26 @@
 #include <algorithm>
 #include <cmath>
 #include <memory>
+#include <limits>
+#include <cstdint>
+#include <numeric>
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#endif
 #include "../models/fleet.h"
 
+namespace {
+
+// Общий генератор шума RandNoise для Features и FeaturePlanes
+double randNoise() {
+    static std::random_device rd;
+    static std::mt19937 gen(rd());
+    static std::uniform_real_distribution<> dis(0.0, 0.1);
+    return dis(gen);
+}
+
+} // namespace
+
 Features::Features(
     const Board& board,
     const std::vector<std::pair<Cell, ShotResult>>& history,
@@ -18,7 +36,7 @@ Features::Features(
 std::array<double, Features::FEATURE_COUNT> Features::getFeatures(const Cell& cell) const {
     std::array<double, FEATURE_COUNT> features{};
     
-    // 1. Heat - доля расстановок из PH, где клетка занята
+    // 1. Heat - доля согласованных с выстрелами расстановок из PH, где клетка занята
     features[0] = calculateHeat(cell);
     
     // 2. HitNeighbor - 4-сторонние соседи с попаданиями
@@ -80,17 +98,28 @@ double Features::calculateHeat(const Cell& cell) const {
         return 0.5; // На старте все клетки равновероятны
     }
 
+    // Наблюдения: клетка с попаданием остается попаданием и при повторном выстреле
+    BitMask128 hits, misses;
+    for (const auto& [shotCell, result] : history) {
+        (isHit(result) ? hits : misses).set(BitMask128::index(shotCell.x, shotCell.y));
+    }
+    misses = misses & ~hits;
+
+    // Доля расстановок P_best, согласованных с выстрелами, где клетка занята
     int count = 0;
-    const auto& validPlacements = pool.getBestPlacements();
-    
-    for (const auto& placement : validPlacements) {
-        auto fleet = placement.decodeFleet();
-        if (fleet && fleet->hasShipAt(cell.x, cell.y)) {
+    int consistent = 0;
+    const int idx = BitMask128::index(cell.x, cell.y);
+    for (const auto& mask : pool.getBestMasks()) {
+        if ((mask & misses).any() || (mask & hits) != hits) {
+            continue;
+        }
+        ++consistent;
+        if (mask.test(idx)) {
             count++;
         }
     }
     
-    return static_cast<double>(count) / validPlacements.size();
+    return consistent > 0 ? static_cast<double>(count) / consistent : 0.5;
 }
 
 double Features::hasHitNeighbor(const Cell& cell) const {
@@ -319,12 +348,394 @@ double Features::getTimeDecayMiss(const Cell& cell) const {
 }
 
 double Features::getRandNoise() const {
-    static std::random_device rd;
-    static std::mt19937 gen(rd());
-    static std::uniform_real_distribution<> dis(0.0, 0.1);
-    return dis(gen);
+    return randNoise();
 }
 
 double Features::getIterParityFlip(const Cell& cell) const {
     return ((cell.x + cell.y + currentIteration) % 2) ? 1.0 : 0.0;
-} 
\ No newline at end of file
+} 
+
+namespace {
+
+constexpr int SIDE = BitMask128::SIDE;
+constexpr int CELLS = BitMask128::CELLS;
+constexpr int MAX_DIST2 = 2 * (SIDE - 1) * (SIDE - 1);
+
+using Row = std::array<double, CELLS>;
+
+/**
+ * @brief Признаки, не зависящие от хода, и таблица exp(-расстояние)
+ */
+struct StaticPlanes {
+    Row parity{};
+    Row centerBias{};
+    Row edgeBias{};
+    Row corner{};
+    std::array<int, CELLS> clusterCells{};           ///< Клеток поля в окне 5x5 MissCluster
+    std::array<std::array<uint8_t, CELLS>, CELLS> dist2{}; ///< Квадраты расстояний между клетками
+    std::array<double, MAX_DIST2 + 1> expDist{};           ///< exp(-расстояние) по квадрату расстояния
+
+    StaticPlanes() {
+        for (int idx = 0; idx < CELLS; ++idx) {
+            const int x = idx % SIDE;
+            const int y = idx / SIDE;
+            parity[idx] = (x + y) % 2;
+            const double dist = std::sqrt(std::pow(x - 4.5, 2) + std::pow(y - 4.5, 2));
+            centerBias[idx] = 1.0 - (dist / 7.07);
+            const bool edgeX = x == 0 || x == SIDE - 1;
+            const bool edgeY = y == 0 || y == SIDE - 1;
+            edgeBias[idx] = (edgeX || edgeY) ? 1.0 : 0.0;
+            corner[idx] = (edgeX && edgeY) ? 1.0 : 0.0;
+            const int w = std::min(x, 2) + std::min(SIDE - 1 - x, 2) + 1;
+            const int h = std::min(y, 2) + std::min(SIDE - 1 - y, 2) + 1;
+            clusterCells[idx] = w * h;
+        }
+        for (int from = 0; from < CELLS; ++from) {
+            for (int idx = 0; idx < CELLS; ++idx) {
+                const int dx = from % SIDE - idx % SIDE;
+                const int dy = from / SIDE - idx / SIDE;
+                dist2[from][idx] = static_cast<uint8_t>(dx * dx + dy * dy);
+            }
+        }
+        for (int d2 = 0; d2 <= MAX_DIST2; ++d2) {
+            expDist[d2] = std::exp(-std::sqrt(static_cast<double>(d2)));
+        }
+    }
+};
+
+const StaticPlanes& staticPlanes() {
+    static const StaticPlanes planes;
+    return planes;
+}
+
+} // namespace
+
+void FeatureTracker::reset(const BitMask128& ships) {
+    m_free = ~ships;
+    m_hits = m_misses = m_hitNeighbor = m_diagHitNeighbor = BitMask128();
+    m_history.clear();
+    for (int idx = 0; idx < CELLS; ++idx) {
+        m_hitRecords[idx].clear();
+        m_missRecords[idx].clear();
+    }
+    m_missCount.fill(0);
+    m_rowFree.fill(0);
+    m_colFree.fill(0);
+    for (BitMask128 rest = m_free; rest.any(); ) {
+        const int idx = rest.popLowest();
+        ++m_rowFree[idx / SIDE];
+        ++m_colFree[idx % SIDE];
+    }
+    for (int i = 0; i < SIDE; ++i) {
+        updateRuns(i, i);
+    }
+}
+
+void FeatureTracker::updateRuns(int x, int y) {
+    // Отрезки строки y и столбца x пересчитываются справа налево и снизу вверх
+    for (int cx = SIDE - 1; cx >= 0; --cx) {
+        const int idx = BitMask128::index(cx, y);
+        m_runRight[idx] = m_free.test(idx) ? 1 + (cx + 1 < SIDE ? m_runRight[idx + 1] : 0) : 0;
+    }
+    for (int cy = SIDE - 1; cy >= 0; --cy) {
+        const int idx = BitMask128::index(x, cy);
+        m_runDown[idx] = m_free.test(idx) ? 1 + (cy + 1 < SIDE ? m_runDown[idx + SIDE] : 0) : 0;
+    }
+}
+
+void FeatureTracker::observe(int x, int y, ShotResult result) {
+    const StaticPlanes& fixed = staticPlanes();
+    const int shotIdx = BitMask128::index(x, y);
+    const int shot = static_cast<int>(m_history.size());
+    const bool hit = result != ShotResult::MISS;
+    m_history.push_back({shotIdx, result});
+
+    // Клетки, к которым выстрел ближе всех прежних выстрелов того же типа
+    auto& records = hit ? m_hitRecords : m_missRecords;
+    const auto& distRow = fixed.dist2[shotIdx];
+    for (int idx = 0; idx < CELLS; ++idx) {
+        Records& cellRecords = records[idx];
+        if (cellRecords.empty() || distRow[idx] < cellRecords.back().dist2) {
+            cellRecords.push_back({shot, distRow[idx]});
+        }
+    }
+
+    if (hit && !m_hits.test(shotIdx)) {
+        m_hits.set(shotIdx);
+        for (int d = -1; d <= 1; d += 2) {
+            if (x + d >= 0 && x + d < SIDE) {
+                m_hitNeighbor.set(shotIdx + d);
+                if (y > 0) m_diagHitNeighbor.set(shotIdx + d - SIDE);
+                if (y + 1 < SIDE) m_diagHitNeighbor.set(shotIdx + d + SIDE);
+            }
+            if (y + d >= 0 && y + d < SIDE) m_hitNeighbor.set(shotIdx + d * SIDE);
+        }
+    }
+    if (!hit && !m_misses.test(shotIdx)) {
+        m_misses.set(shotIdx);
+        // Окно 5x5 симметрично: промах попадает в окна клеток своего окна
+        for (int cy = std::max(0, y - 2); cy <= std::min(SIDE - 1, y + 2); ++cy) {
+            for (int cx = std::max(0, x - 2); cx <= std::min(SIDE - 1, x + 2); ++cx) {
+                ++m_missCount[BitMask128::index(cx, cy)];
+            }
+        }
+    }
+    if (m_free.test(shotIdx)) {
+        m_free.reset(shotIdx);
+        --m_rowFree[y];
+        --m_colFree[x];
+        updateRuns(x, y);
+    }
+}
+
+void FeaturePlanes::compute(
+    const FeatureTracker& tracker,
+    const PlacementHeatIndex& heat,
+    int currentIteration,
+    const BitMask128& cells,
+    uint32_t features
+) {
+    const StaticPlanes& fixed = staticPlanes();
+    const auto& history = tracker.history();
+    const int historySize = static_cast<int>(history.size());
+
+    std::array<uint8_t, CELLS> order;
+    int count = 0;
+    for (BitMask128 rest = cells; rest.any(); ) {
+        order[count++] = static_cast<uint8_t>(rest.popLowest());
+    }
+
+    // Каждая плоскость из маски заполняется своим проходом по клеткам хода
+    auto fill = [&](size_t feature, auto&& value) {
+        if (!(features >> feature & 1u)) return;
+        Plane& plane = m_planes[feature];
+        for (int i = 0; i < count; ++i) {
+            plane[order[i]] = static_cast<float>(value(order[i]));
+        }
+    };
+    auto flag = [](bool value) { return value ? 1.0 : 0.0; };
+
+    // Затухающее влияние: максимум по выстрелам, каждый из которых ближе предыдущих
+    auto decay = [&](const FeatureTracker::Records& records) {
+        double maxInfluence = 0.0;
+        for (const auto& record : records) {
+            const double timeDecay = static_cast<double>(record.shot) / historySize;
+            maxInfluence = std::max(maxInfluence, fixed.expDist[record.dist2] * (1.0 - timeDecay));
+        }
+        return maxInfluence;
+    };
+
+    fill(0, [&](int idx) { return history.empty() ? 0.5 : heat.heat(idx); });
+    fill(1, [&](int idx) { return flag(tracker.hitNeighbor(idx)); });
+    fill(2, [&](int idx) { return flag(tracker.diagHitNeighbor(idx)); });
+    fill(3, [&](int idx) { return fixed.parity[idx]; });
+    fill(4, [&](int idx) {
+        const auto& hitRecords = tracker.hitRecords(idx);
+        return 1.0 / (1.0 + (hitRecords.empty() ? 100.0 : std::sqrt(static_cast<double>(hitRecords.back().dist2))));
+    });
+    fill(5, [&](int idx) { return static_cast<double>(tracker.missCount(idx)) / fixed.clusterCells[idx]; });
+    fill(6, [&](int idx) { return static_cast<double>(tracker.rowFree(idx / SIDE)) / 10; });
+    fill(7, [&](int idx) { return static_cast<double>(tracker.colFree(idx % SIDE)) / 10; });
+    fill(8, [&](int idx) { return fixed.centerBias[idx]; });
+    fill(9, [&](int idx) { return fixed.edgeBias[idx]; });
+    fill(10, [&](int idx) { return fixed.corner[idx]; });
+    for (int size = 4; size >= 1; --size) {
+        fill(15 - size, [&](int idx) {
+            return flag(tracker.runRight(idx) >= size || tracker.runDown(idx) >= size);
+        });
+    }
+
+    // RecentMissPenalty: промах среди последних 5 выстрелов на расстоянии не больше 2
+    if (features >> 15 & 1u) {
+        std::array<uint8_t, CELLS> recentMiss{};
+        for (int i = std::max(0, historySize - 5); i < historySize; ++i) {
+            if (history[i].second != ShotResult::MISS) continue;
+            const auto& distRow = fixed.dist2[history[i].first];
+            for (int idx = 0; idx < CELLS; ++idx) {
+                recentMiss[idx] |= distRow[idx] <= 4;
+            }
+        }
+        fill(15, [&](int idx) { return flag(recentMiss[idx]); });
+    }
+
+    fill(16, [&](int idx) { return decay(tracker.hitRecords(idx)); });
+    fill(17, [&](int idx) { return decay(tracker.missRecords(idx)); });
+    fill(18, [](int) { return randNoise(); });
+    fill(19, [&](int idx) { return flag((idx % SIDE + idx / SIDE + currentIteration) % 2); });
+}
+
+void FeaturePlanes::compute(
+    const Board& board,
+    const std::vector<std::pair<Cell, ShotResult>>& history,
+    const PlacementHeatIndex& heat,
+    int currentIteration,
+    const BitMask128& cells
+) {
+    FeatureTracker tracker;
+    tracker.reset(board.shipMask());
+    for (const auto& [shotCell, result] : history) {
+        tracker.observe(shotCell.x, shotCell.y, result);
+    }
+    compute(tracker, heat, currentIteration, cells);
+}
+
+FeaturePlanes::Weights FeaturePlanes::toWeights(const std::vector<double>& weights) {
+    Weights result{};
+    const size_t count = std::min(weights.size(), result.size());
+    for (size_t f = 0; f < count; ++f) {
+        result[f] = static_cast<float>(weights[f]);
+    }
+    return result;
+}
+
+namespace {
+
+// Биты разрешенных клеток блока из 8 клеток, начинающегося с клетки 8 * block
+unsigned blockBits(const BitMask128& cells, int block) {
+    const int shift = block * 8;
+    return static_cast<unsigned>((shift < 64 ? cells.lo >> shift : cells.hi >> (shift - 64)) & 0xFFu);
+}
+
+// Все признаки по порядку и нулевое смещение: взвешенная сумма без специализации
+struct FullSum {
+    std::array<uint8_t, Features::FEATURE_COUNT> features{};
+    FeaturePlanes::Plane zero{};
+
+    FullSum() { std::iota(features.begin(), features.end(), 0); }
+};
+
+const FullSum& fullSum() {
+    static const FullSum sum;
+    return sum;
+}
+
+// Ядра считают bias + сумму weights[i] * plane(features[i]) по i = 0..count-1
+
+int argmaxScalar(const FeaturePlanes& planes, const FeaturePlanes::Plane& bias, const uint8_t* features,
+                 const float* weights, size_t count, const BitMask128& cells, float& bestScore) {
+    // Сумма по признакам для всех клеток (цикл по клеткам векторизуется компилятором)
+    FeaturePlanes::Plane score = bias;
+    for (size_t i = 0; i < count; ++i) {
+        const float w = weights[i];
+        const FeaturePlanes::Plane& plane = planes.plane(features[i]);
+        for (int idx = 0; idx < FeaturePlanes::STRIDE; ++idx) {
+            score[idx] += plane[idx] * w;
+        }
+    }
+
+    int best = -1;
+    bestScore = -std::numeric_limits<float>::max();
+    for (BitMask128 rest = cells; rest.any(); ) {
+        const int idx = rest.popLowest();
+        if (score[idx] > bestScore) {
+            bestScore = score[idx];
+            best = idx;
+        }
+    }
+    return best;
+}
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define FEATURE_PLANES_AVX2 1
+
+__attribute__((target("avx2")))
+int argmaxAvx2(const FeaturePlanes& planes, const FeaturePlanes::Plane& bias, const uint8_t* features,
+               const float* weights, size_t count, const BitMask128& cells, float& bestScore) {
+    const __m256i laneBit = _mm256_setr_epi32(1, 2, 4, 8, 16, 32, 64, 128);
+    const __m256i step = _mm256_set1_epi32(8);
+    __m256i index = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+    __m256 laneBest = _mm256_set1_ps(-std::numeric_limits<float>::max());
+    __m256i laneIndex = _mm256_set1_epi32(-1);
+
+    // Блок из 8 клеток: сумма по признакам (умножение и сложение без FMA, как в
+    // скалярном ядре), затем сравнение с максимумом дорожки только для разрешенных клеток
+    for (int block = 0; block < FeaturePlanes::STRIDE / 8; ++block) {
+        __m256 acc = _mm256_loadu_ps(bias.data() + block * 8);
+        for (size_t i = 0; i < count; ++i) {
+            const __m256 values = _mm256_loadu_ps(planes.plane(features[i]).data() + block * 8);
+            acc = _mm256_add_ps(acc, _mm256_mul_ps(values, _mm256_set1_ps(weights[i])));
+        }
+        const __m256i bits = _mm256_set1_epi32(static_cast<int>(blockBits(cells, block)));
+        const __m256i allowed = _mm256_cmpeq_epi32(_mm256_and_si256(bits, laneBit), laneBit);
+        const __m256 better = _mm256_and_ps(_mm256_cmp_ps(acc, laneBest, _CMP_GT_OQ),
+                                            _mm256_castsi256_ps(allowed));
+        laneBest = _mm256_blendv_ps(laneBest, acc, better);
+        laneIndex = _mm256_castps_si256(_mm256_blendv_ps(
+            _mm256_castsi256_ps(laneIndex), _mm256_castsi256_ps(index), better));
+        index = _mm256_add_epi32(index, step);
+    }
+
+    // Свертка дорожек: максимум, при равенстве - меньший индекс
+    alignas(32) float values[8];
+    alignas(32) int indices[8];
+    _mm256_store_ps(values, laneBest);
+    _mm256_store_si256(reinterpret_cast<__m256i*>(indices), laneIndex);
+    int best = -1;
+    bestScore = -std::numeric_limits<float>::max();
+    for (int lane = 0; lane < 8; ++lane) {
+        if (indices[lane] < 0) continue;
+        if (best < 0 || values[lane] > bestScore || (values[lane] == bestScore && indices[lane] < best)) {
+            bestScore = values[lane];
+            best = indices[lane];
+        }
+    }
+    return best;
+}
+#endif
+
+} // namespace
+
+bool FeaturePlanes::hasAvx2() {
+#ifdef FEATURE_PLANES_AVX2
+    static const bool supported = __builtin_cpu_supports("avx2");
+    return supported;
+#else
+    return false;
+#endif
+}
+
+int FeaturePlanes::argmax(const Weights& weights, const BitMask128& cells, float& bestScore, Kernel kernel) const {
+    const FullSum& sum = fullSum();
+#ifdef FEATURE_PLANES_AVX2
+    if (kernel != Kernel::SCALAR && hasAvx2()) {
+        return argmaxAvx2(*this, sum.zero, sum.features.data(), weights.data(), weights.size(), cells, bestScore);
+    }
+#endif
+    (void)kernel;
+    return argmaxScalar(*this, sum.zero, sum.features.data(), weights.data(), weights.size(), cells, bestScore);
+}
+
+FeatureScorer::FeatureScorer(const std::vector<double>& weights, double epsilon) {
+    const StaticPlanes& fixed = staticPlanes();
+    auto weight = [&](size_t f) { return f < weights.size() ? weights[f] : 0.0; };
+
+    // Смещение: статические признаки, сложенные заранее в double
+    for (int parity = 0; parity < 2; ++parity) {
+        for (int idx = 0; idx < CELLS; ++idx) {
+            const double flip = (idx % SIDE + idx / SIDE + parity) % 2 ? 1.0 : 0.0;
+            m_bias[parity][idx] = static_cast<float>(
+                fixed.parity[idx] * weight(3) + fixed.centerBias[idx] * weight(8) +
+                fixed.edgeBias[idx] * weight(9) + fixed.corner[idx] * weight(10) + flip * weight(19));
+        }
+    }
+
+    for (size_t f = 0; f < Features::FEATURE_COUNT; ++f) {
+        if ((FeaturePlanes::STATIC_FEATURES >> f & 1u) || std::abs(weight(f)) < epsilon) continue;
+        m_active[m_count] = static_cast<uint8_t>(f);
+        m_weights[m_count] = static_cast<float>(weight(f));
+        ++m_count;
+        m_features |= 1u << f;
+    }
+}
+
+int FeatureScorer::argmax(const FeaturePlanes& planes, int currentIteration, const BitMask128& cells,
+                          float& bestScore, FeaturePlanes::Kernel kernel) const {
+    const FeaturePlanes::Plane& bias = m_bias[currentIteration & 1];
+#ifdef FEATURE_PLANES_AVX2
+    if (kernel != FeaturePlanes::Kernel::SCALAR && FeaturePlanes::hasAvx2()) {
+        return argmaxAvx2(planes, bias, m_active.data(), m_weights.data(), m_count, cells, bestScore);
+    }
+#endif
+    (void)kernel;
+    return argmaxScalar(planes, bias, m_active.data(), m_weights.data(), m_count, cells, bestScore);
+}
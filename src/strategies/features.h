@@ -1,6 +1,7 @@
 #pragma once
 
 #include <array>
+#include <cstdint>
 #include <vector>
 #include <utility>
 #include "../models/cell.h"
@@ -69,4 +70,216 @@ private:
     bool isHit(const ShotResult& result) const;
     bool isMiss(const ShotResult& result) const;
     bool isKill(const ShotResult& result) const;
-};
\ No newline at end of file
+};
+
+/**
+ * @brief Состояние признаков партии, обновляемое после каждого выстрела
+ *
+ * Выстрел меняет большинство признаков только рядом с обстрелянной клеткой,
+ * поэтому трекер хранит их между ходами и обновляет локально: соседство с
+ * попаданиями, число промахов в окне 5x5, свободные клетки строки и столбца,
+ * свободные отрезки для Fit-признаков. Для TimeDecayHit/Miss и DistLastHit на
+ * клетку хранятся только выстрелы, которые ближе всех предыдущих того же типа:
+ * более ранний и не более далекий выстрел всегда дает не меньшее влияние.
+ */
+class FeatureTracker {
+public:
+    /// Выстрел, влияющий на клетку: номер в истории и квадрат расстояния до клетки
+    struct DecayRecord {
+        int shot;
+        uint8_t dist2;
+    };
+    using Records = std::vector<DecayRecord>;
+
+    /**
+     * @brief Начинает партию
+     * @param ships Клетки кораблей (свободные клетки - как в Board::isCellFree)
+     */
+    void reset(const BitMask128& ships);
+
+    /**
+     * @brief Учитывает очередной выстрел истории
+     */
+    void observe(int x, int y, ShotResult result);
+
+    /// Выстрелы партии: индекс клетки и результат
+    const std::vector<std::pair<int, ShotResult>>& history() const { return m_history; }
+
+    /// Попадания, каждое ближе к клетке всех предыдущих (последнее - ближайшее)
+    const Records& hitRecords(int idx) const { return m_hitRecords[idx]; }
+    /// Промахи, каждый ближе к клетке всех предыдущих
+    const Records& missRecords(int idx) const { return m_missRecords[idx]; }
+
+    bool hitNeighbor(int idx) const { return m_hitNeighbor.test(idx); }
+    bool diagHitNeighbor(int idx) const { return m_diagHitNeighbor.test(idx); }
+    /// Клеток с промахом в окне 5x5 вокруг клетки
+    int missCount(int idx) const { return m_missCount[idx]; }
+    int rowFree(int y) const { return m_rowFree[y]; }
+    int colFree(int x) const { return m_colFree[x]; }
+    /// Длина свободного отрезка от клетки вправо и вниз (0 - клетка занята)
+    int runRight(int idx) const { return m_runRight[idx]; }
+    int runDown(int idx) const { return m_runDown[idx]; }
+
+private:
+    BitMask128 m_free;   ///< Клетки без кораблей и выстрелов
+    BitMask128 m_hits;   ///< Клетки с записью попадания
+    BitMask128 m_misses; ///< Клетки с записью промаха
+    BitMask128 m_hitNeighbor;
+    BitMask128 m_diagHitNeighbor;
+    std::vector<std::pair<int, ShotResult>> m_history;
+    std::array<Records, BitMask128::CELLS> m_hitRecords;
+    std::array<Records, BitMask128::CELLS> m_missRecords;
+    std::array<int, BitMask128::CELLS> m_missCount{};
+    std::array<int, BitMask128::SIDE> m_rowFree{};
+    std::array<int, BitMask128::SIDE> m_colFree{};
+    std::array<int, BitMask128::CELLS> m_runRight{};
+    std::array<int, BitMask128::CELLS> m_runDown{};
+
+    void updateRuns(int x, int y);
+};
+
+/**
+ * @brief Плоскости признаков: все признаки Features для всех клеток за ход
+ *
+ * Features считает признаки одной клетки, и почти каждый признак заново
+ * просматривает историю выстрелов. Здесь все 20 признаков считаются один раз
+ * за ход в виде 20 плоскостей по 100 клеток из масок и счетчиков FeatureTracker,
+ * которые обновляются по одному выстрелу. Значения совпадают с
+ * Features::getFeatures.
+ */
+class FeaturePlanes {
+public:
+    static constexpr int STRIDE = 104; ///< Длина плоскости: 100 клеток, дополненные до кратного 8
+
+    using Plane = std::array<float, STRIDE>;
+    using Weights = std::array<float, Features::FEATURE_COUNT>;
+
+    /// Маска всех признаков (бит f - признак f)
+    static constexpr uint32_t ALL_FEATURES = (1u << Features::FEATURE_COUNT) - 1;
+    /// Признаки, не зависящие от истории: Parity, CenterBias, EdgeBias, Corner, IterParityFlip
+    static constexpr uint32_t STATIC_FEATURES = (1u << 3) | (1u << 8) | (1u << 9) | (1u << 10) | (1u << 19);
+    /// Признак RandNoise: случайный при каждом вычислении
+    static constexpr uint32_t NOISE_FEATURES = 1u << 18;
+
+    /**
+     * @brief Ядро взвешенной суммы и argmax
+     */
+    enum class Kernel {
+        AUTO,   ///< AVX2, если процессор его поддерживает, иначе SCALAR
+        SCALAR, ///< Переносимый цикл
+        AVX2    ///< 8 клеток за операцию (только x86 с поддержкой AVX2)
+    };
+
+    /**
+     * @brief Вычисляет плоскости признаков по состоянию трекера
+     *
+     * @param tracker Признаки партии после всех выстрелов истории
+     * @param heat Расстановки P_best, согласованные с историей (признак Heat)
+     * @param cells Клетки, для которых нужны признаки (значения остальных не определены).
+     *              Шум RandNoise выбирается для этих клеток в порядке индексов
+     * @param features Маска признаков: плоскости остальных не пересчитываются
+     */
+    void compute(
+        const FeatureTracker& tracker,
+        const PlacementHeatIndex& heat,
+        int currentIteration,
+        const BitMask128& cells,
+        uint32_t features = ALL_FEATURES
+    );
+
+    /**
+     * @brief Вычисляет плоскости признаков с нуля: трекер проигрывает всю историю
+     */
+    void compute(
+        const Board& board,
+        const std::vector<std::pair<Cell, ShotResult>>& history,
+        const PlacementHeatIndex& heat,
+        int currentIteration,
+        const BitMask128& cells
+    );
+
+    /**
+     * @brief Плоскость признака (индексы как в Features::getFeatures)
+     */
+    const Plane& plane(size_t feature) const { return m_planes[feature]; }
+
+    /**
+     * @brief Переводит веса хромосомы в float
+     */
+    static Weights toWeights(const std::vector<double>& weights);
+
+    /**
+     * @brief Доступно ли ядро AVX2 на этом процессоре
+     */
+    static bool hasAvx2();
+
+    /**
+     * @brief Клетка с максимальной взвешенной суммой признаков
+     *
+     * Сумма по признакам и выбор максимума среди разрешенных клеток идут в одном
+     * проходе по блокам из 8 клеток. Оба ядра складывают признаки в одном порядке,
+     * поэтому их результаты совпадают. При равенстве выбирается клетка с меньшим
+     * индексом.
+     *
+     * @param weights Веса признаков
+     * @param cells Разрешенные клетки
+     * @param bestScore Оценка выбранной клетки
+     * @param kernel Ядро (AVX2 без поддержки процессора заменяется на SCALAR)
+     * @return Индекс клетки или -1, если ни одна оценка не больше -FLT_MAX
+     */
+    int argmax(const Weights& weights, const BitMask128& cells, float& bestScore,
+               Kernel kernel = Kernel::AUTO) const;
+
+private:
+    alignas(32) std::array<Plane, Features::FEATURE_COUNT> m_planes{};
+};
+
+/**
+ * @brief Оценка клеток, специализированная под один вектор весов
+ *
+ * Собирается один раз из весов хромосомы. Статические признаки
+ * (FeaturePlanes::STATIC_FEATURES) сворачиваются в готовую плоскость смещения -
+ * по одной на четность хода, так как от нее зависит IterParityFlip. Признаки с
+ * весом меньше epsilon по модулю отбрасываются. Ход считает плоскости и
+ * взвешенную сумму только для оставшихся признаков (маска features()).
+ */
+class FeatureScorer {
+public:
+    static constexpr double DEFAULT_EPSILON = 1e-3; ///< Порог отбрасывания веса
+
+    /**
+     * @param weights Веса признаков (недостающие считаются нулевыми)
+     * @param epsilon Порог: признаки с |w| < epsilon не считаются (0 - учитываются все)
+     */
+    explicit FeatureScorer(const std::vector<double>& weights, double epsilon = DEFAULT_EPSILON);
+
+    /**
+     * @brief Признаки, которые нужно пересчитывать каждый ход
+     */
+    uint32_t features() const { return m_features; }
+
+    /**
+     * @brief Число признаков во взвешенной сумме хода
+     */
+    size_t activeCount() const { return m_count; }
+
+    /**
+     * @brief Клетка с максимальной оценкой: смещение плюс сумма оставшихся признаков
+     *
+     * @param planes Плоскости, посчитанные с маской features()
+     * @param currentIteration Номер хода (выбирает плоскость смещения)
+     * @param cells Разрешенные клетки
+     * @param bestScore Оценка выбранной клетки
+     * @param kernel Ядро, как в FeaturePlanes::argmax
+     * @return Индекс клетки или -1, если ни одна оценка не больше -FLT_MAX
+     */
+    int argmax(const FeaturePlanes& planes, int currentIteration, const BitMask128& cells,
+               float& bestScore, FeaturePlanes::Kernel kernel = FeaturePlanes::Kernel::AUTO) const;
+
+private:
+    alignas(32) std::array<FeaturePlanes::Plane, 2> m_bias{}; ///< Смещение по четности хода
+    std::array<uint8_t, Features::FEATURE_COUNT> m_active{};  ///< Оставшиеся признаки
+    std::array<float, Features::FEATURE_COUNT> m_weights{};   ///< Их веса
+    size_t m_count = 0;
+    uint32_t m_features = 0;
+};
@@ -0,0 +1,100 @@
+#include "fleet_corpus.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+const char CORPUS_MAGIC[4] = {'M', 'C', 'F', '1'};
+
+struct Header {
+    char magic[4];
+    uint32_t maskBytes;
+    uint64_t count;
+};
+
+} // namespace
+
+FleetCorpus::FleetCorpus(std::vector<BitMask128> fleets)
+    : m_loaded(std::move(fleets)) {
+    m_fleets = m_loaded.data();
+    m_count = m_loaded.size();
+}
+
+FleetCorpus::~FleetCorpus() {
+#ifndef _WIN32
+    if (m_map) {
+        munmap(m_map, m_mapSize);
+    }
+#endif
+}
+
+std::shared_ptr<FleetCorpus> FleetCorpus::load(const std::string& path) {
+    std::shared_ptr<FleetCorpus> corpus(new FleetCorpus());
+    Header header{};
+    const char* data = nullptr;
+    size_t size = 0;
+
+#ifndef _WIN32
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) return nullptr;
+    struct stat st{};
+    if (fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < sizeof(Header)) {
+        close(fd);
+        return nullptr;
+    }
+    size = static_cast<size_t>(st.st_size);
+    void* map = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) return nullptr;
+    corpus->m_map = map;
+    corpus->m_mapSize = size;
+    data = static_cast<const char*>(map);
+#else
+    // Без mmap маски читаются в память целиком
+    std::ifstream ifs(path, std::ios::binary);
+    if (!ifs) return nullptr;
+    std::vector<char> buffer((std::istreambuf_iterator<char>(ifs)), std::istreambuf_iterator<char>());
+    size = buffer.size();
+    if (size < sizeof(Header)) return nullptr;
+    data = buffer.data();
+#endif
+
+    std::memcpy(&header, data, sizeof(Header));
+    if (!std::equal(header.magic, header.magic + sizeof(CORPUS_MAGIC), CORPUS_MAGIC) ||
+        header.maskBytes != sizeof(BitMask128) ||
+        size != sizeof(Header) + static_cast<size_t>(header.count) * sizeof(BitMask128)) {
+        return nullptr; // Отображение освободит деструктор
+    }
+    corpus->m_count = static_cast<size_t>(header.count);
+#ifndef _WIN32
+    corpus->m_fleets = reinterpret_cast<const BitMask128*>(data + sizeof(Header));
+#else
+    corpus->m_loaded.resize(corpus->m_count);
+    std::memcpy(corpus->m_loaded.data(), data + sizeof(Header), corpus->bytes());
+    corpus->m_fleets = corpus->m_loaded.data();
+#endif
+    return corpus;
+}
+
+void FleetCorpus::save(const std::string& path) const {
+    std::ofstream ofs(path, std::ios::binary);
+    if (!ofs) throw std::runtime_error("Cannot open file for writing: " + path);
+
+    Header header{};
+    std::copy(CORPUS_MAGIC, CORPUS_MAGIC + sizeof(CORPUS_MAGIC), header.magic);
+    header.maskBytes = static_cast<uint32_t>(sizeof(BitMask128));
+    header.count = static_cast<uint64_t>(m_count);
+    ofs.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    ofs.write(reinterpret_cast<const char*>(m_fleets), static_cast<std::streamsize>(bytes()));
+    if (!ofs) throw std::runtime_error("Failed to write fleet corpus: " + path);
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include "../models/bitboard.h"
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+/**
+ * @class FleetCorpus
+ * @brief Заранее сгенерированный набор расстановок флота для стратегии Монте-Карло.
+ *
+ * Каждая расстановка хранится 128-битной маской клеток кораблей. Корабли не
+ * касаются друг друга, поэтому каждая связная область маски - ровно один
+ * корабль, и маски достаточно, чтобы проверить согласованность с наблюдениями.
+ * Файл отображается в память только для чтения (mmap): один корпус делят
+ * все стратегии процесса и все процессы, открывшие тот же файл.
+ *
+ * Формат файла (порядок байт машины): сигнатура "MCF1", uint32 размер маски
+ * в байтах, uint64 count, затем count масок BitMask128.
+ */
+class FleetCorpus {
+public:
+    static constexpr size_t DEFAULT_SIZE = 2000000;                  ///< Расстановок при построении
+    static constexpr const char* DEFAULT_PATH = "mc_fleets.corpus"; ///< Файл корпуса по умолчанию
+
+    /**
+     * @brief Корпус в памяти (без файла)
+     * @param fleets Маски расстановок
+     */
+    explicit FleetCorpus(std::vector<BitMask128> fleets);
+    ~FleetCorpus();
+
+    FleetCorpus(const FleetCorpus&) = delete;
+    FleetCorpus& operator=(const FleetCorpus&) = delete;
+
+    /**
+     * @brief Загружает корпус из файла
+     * @return Корпус или nullptr, если файла нет или он поврежден
+     */
+    static std::shared_ptr<FleetCorpus> load(const std::string& path);
+
+    /**
+     * @brief Сохраняет корпус в файл
+     */
+    void save(const std::string& path) const;
+
+    const BitMask128* data() const { return m_fleets; }
+    size_t size() const { return m_count; }
+
+    /**
+     * @brief Объем масок в байтах
+     */
+    size_t bytes() const { return m_count * sizeof(BitMask128); }
+
+private:
+    FleetCorpus() = default;
+
+    const BitMask128* m_fleets = nullptr; ///< Маски (отображение файла или m_loaded)
+    size_t m_count = 0;
+    void* m_map = nullptr;                ///< Отображение файла в память
+    size_t m_mapSize = 0;
+    std::vector<BitMask128> m_loaded;     ///< Маски корпуса в памяти или прочитанные без mmap
+};
@@ -3,259 +3,966 @@
 #include <algorithm>
 #include <map>
 #include <cmath>
+#include <cstring>
+#include <limits>
+#include <random>
+#include <thread>
+
+std::shared_ptr<OpeningBook> MonteCarloStrategy::s_defaultBook;
+std::shared_ptr<TranspositionTable> MonteCarloStrategy::s_defaultTable;
+std::shared_ptr<FleetCorpus> MonteCarloStrategy::s_defaultCorpus;
 
 bool MonteCarloStrategy::fits(int x, int y, int len, bool hor, 
-                              const MCPlacement& p, const Board& board,
-                              const std::vector<std::pair<int, int>>& hits) const {
-    // Флаг для проверки, покрывает ли корабль хотя бы одно попадание
-    bool coversHit = false;
-    int hitsCovered = 0;
+                              const MCPlacement& p, const BitMask128& missMask,
+                              const BitMask128& hitsMask) const {
+    const PlacementMask& m = PlacementMasks::get(x, y, len, hor);
     
-    // Проверяем все клетки корабля и окружающие их клетки
-    for (int i = 0; i < len; ++i) {
-        int xx = x + (hor ? i : 0);
-        int yy = y + (hor ? 0 : i);
-        
-        // Проверка границ и занятости
-        if (!inside(xx, yy) || p.occ[yy][xx])
-            return false;
-        
-        // Клетка не должна быть промахом
-        if (board.isShot(xx, yy) && board.getCell(xx, yy) == CellState::MISS)
-            return false;
-        
-        // Проверяем, покрывает ли корабль попадание
-        if (!hits.empty()) {
-            auto it = std::find(hits.begin(), hits.end(), std::make_pair(xx, yy));
-            if (it != hits.end()) {
-                coversHit = true;
-                hitsCovered++;
+    // Проверка границ, занятости и правила "не касаться"
+    if (!p.fleet.fits(m))
+        return false;
+    
+    // Клетки корабля не должны быть промахами
+    if ((m.body & missMask).any())
+        return false;
+    
+    // Если на доске есть попадания, корабль должен покрывать хотя бы одно из них
+    // (покрытые попадания автоматически лежат на одной линии с кораблем)
+    if (hitsMask.any() && (m.body & hitsMask).none())
+        return false;
+    
+    return true;
+}
+
+void MonteCarloStrategy::place(int x, int y, int len, bool hor, MCPlacement& p) const {
+    p.fleet.add(PlacementMasks::get(x, y, len, hor));
+}
+
+void MonteCarloStrategy::init_prob_board() {
+    prob_board.fill(0);
+}
+
+bool MonteCarloStrategy::prepareContext(const Board& board, SampleContext& ctx) {
+    // Попадания по раненым кораблям и оставшийся флот известны без обхода поля
+    m_hits = board.hitMask() & ~board.sunkMask();
+    ctx.ships = m_fleet.lengths();
+    if (ctx.ships.empty()) return false;
+
+    // Кораблей не может быть на промахах, а также на потопленных кораблях и их ореолах;
+    // генератор с отказами сохраняет прежнюю проверку (только промахи)
+    const BitMask128 misses = board.shotMask() & ~board.hitMask();
+    const BitMask128 observed = misses | board.sunkMask().dilate();
+    ctx.blocked = m_sampler == Sampler::TABLE ? observed : misses;
+    ctx.hitsMask = m_hits;
+    ctx.open = ~board.shotMask() & ~m_fleet.halo() & BitMask128::full();
+    ctx.symmetry = m_symmetry ? BoardSymmetry::stabilizer({board.shotMask(), board.hitMask(), board.sunkMask()}) : 1;
+    for (auto& list : ctx.candidates) list.clear();
+    ctx.hitCandidates.clear();
+
+    // Позиции, допустимые при текущих наблюдениях, для каждой оставшейся длины
+    for (int len : ctx.ships) {
+        auto& list = ctx.candidates[len];
+        if (!list.empty()) continue;
+        for (int hor = 0; hor <= 1; ++hor) {
+            for (int idx = 0; idx < BitMask128::CELLS; ++idx) {
+                const int slot = PlacementMasks::slot(idx % 10, idx / 10, len, hor == 1);
+                const PlacementMask& m = PlacementMasks::TABLE[slot];
+                if (m.legal && (m.body & observed).none()) {
+                    list.push_back(static_cast<uint16_t>(slot));
+                }
             }
         }
-        
-        // Проверка окружающих клеток (правило "не касаться")
-        for (int dy = -1; dy <= 1; ++dy) {
-            for (int dx = -1; dx <= 1; ++dx) {
-                // Пропускаем текущую клетку
-                if (dx == 0 && dy == 0) continue;
-                
-                int nx = xx + dx;
-                int ny = yy + dy;
-                
-                if (inside(nx, ny) && p.occ[ny][nx])
-                    return false;
+    }
+    // Самый длинный корабль ставится на попадания
+    if (ctx.hitsMask.any()) {
+        for (uint16_t slot : ctx.candidates[ctx.ships.front()]) {
+            if ((PlacementMasks::TABLE[slot].body & ctx.hitsMask).any()) {
+                ctx.hitCandidates.push_back(slot);
             }
         }
     }
-    
-    // Если на доске есть попадания:
-    // 1) Корабль должен покрывать хотя бы одно попадание
-    // 2) Все попадания, которые он покрывает, должны быть в линию (соответствовать ориентации)
-    if (!hits.empty()) {
-        // Если ни одно попадание не покрыто, не подходит
-        if (!coversHit)
-            return false;
-            
-        // Если покрыто больше одного попадания, проверяем, соответствуют ли они ориентации
-        if (hitsCovered > 1) {
-            // Для горизонтального корабля все попадания должны быть на одной y-координате
-            // Для вертикального корабля все попадания должны быть на одной x-координате
-            if (hor) {
-                int firstY = -1;
-                for (const auto& hit : hits) {
-                    // Пропускаем попадания, не покрытые этим кораблем
-                    if (hit.first < x || hit.first >= x + len || hit.second != y)
-                        continue;
-                        
-                    if (firstY == -1)
-                        firstY = hit.second;
-                    else if (hit.second != firstY)
-                        return false; // Попадания не в одну линию по горизонтали
-                }
-            } else {
-                int firstX = -1;
-                for (const auto& hit : hits) {
-                    // Пропускаем попадания, не покрытые этим кораблем
-                    if (hit.second < y || hit.second >= y + len || hit.first != x)
-                        continue;
-                        
-                    if (firstX == -1)
-                        firstX = hit.first;
-                    else if (hit.first != firstX)
-                        return false; // Попадания не в одну линию по вертикали
+    return true;
+}
+
+template <typename RandInt>
+bool MonteCarloStrategy::sampleFleet(const SampleContext& ctx, BitMask128& body, RandInt&& randInt,
+                                     SamplerStats& stats, std::vector<uint16_t>& scratch) const {
+    ++stats.attempts;
+    if (m_sampler == Sampler::TABLE) {
+        // Позиции берутся из списка, уже согласованного с наблюдениями; остается
+        // только не задеть ранее поставленные корабли. Несколько быстрых попыток
+        // (выбор из надмножества с отказом сохраняет равномерность), затем
+        // точный список свободных позиций - так пустых розыгрышей не бывает
+        FleetMask fleet;
+        for (size_t i = 0; i < ctx.ships.size(); ++i) {
+            const int len = ctx.ships[i];
+            const auto& source = (i == 0 && ctx.hitsMask.any()) ? ctx.hitCandidates : ctx.candidates[len];
+            if (source.empty()) return false;
+
+            const PlacementMask* chosen = nullptr;
+            for (int k = 0; k < TABLE_QUICK_DRAWS && !chosen; ++k) {
+                ++stats.draws;
+                const PlacementMask& m = PlacementMasks::TABLE[source[randInt(0, static_cast<int>(source.size()) - 1)]];
+                if (fleet.fits(m)) chosen = &m;
+            }
+            if (!chosen) {
+                scratch.clear();
+                for (uint16_t slot : source) {
+                    if (fleet.fits(PlacementMasks::TABLE[slot])) scratch.push_back(slot);
                 }
+                if (scratch.empty()) return false;
+                ++stats.draws;
+                chosen = &PlacementMasks::TABLE[scratch[randInt(0, static_cast<int>(scratch.size()) - 1)]];
             }
+            ++stats.placed;
+            fleet.add(*chosen);
         }
+        body = fleet.body;
+        ++stats.accepted;
+        return true;
     }
+
+    MCPlacement p{};
+    auto ships = ctx.ships;
     
+    // 1. если есть попадания, расставляем самый длинный корабль на попадания
+    if (ctx.hitsMask.any()) {
+        // перемешиваем ships вручную (Fisher-Yates)
+        for (int idx = static_cast<int>(ships.size()) - 1; idx > 0; --idx) {
+            int j = randInt(0, idx);
+            std::swap(ships[idx], ships[j]);
+        }
+        std::sort(ships.begin(), ships.end(), std::greater<int>());
+        int longest = ships.front();
+
+        bool placed = false;
+        for (int k = 0; k < 200 && !placed; ++k) {
+            ++stats.draws;
+            bool hor = randInt(0,1);
+            // Случайное попадание: k-я клетка маски в порядке обхода по строкам
+            BitMask128 hits = ctx.hitsMask;
+            for (int skip = randInt(0, hits.count() - 1); skip > 0; --skip) hits.popLowest();
+            const int hx = hits.lowest() % 10;
+            const int hy = hits.lowest() / 10;
+            int x0 = hor ? hx - randInt(0, longest-1) : hx;
+            int y0 = hor ? hy : hy - randInt(0, longest-1);
+            if (fits(x0, y0, longest, hor, p, ctx.blocked, ctx.hitsMask)) {
+                place(x0, y0, longest, hor, p);
+                ships.erase(std::find(ships.begin(), ships.end(), longest));
+                placed = true;
+                ++stats.placed;
+            }
+        }
+        if (!placed) return false;
+    }
+
+    // 2. расставляем остальные корабли
+    for (int len : ships) {
+        bool placed = false;
+        for (int k = 0; k < 200 && !placed; ++k) {
+            ++stats.draws;
+            bool hor = randInt(0,1);
+            int x = randInt(0, 10 - (hor ? len : 1));
+            int y = randInt(0, 10 - (hor ? 1 : len));
+            if (fits(x, y, len, hor, p, ctx.blocked, ctx.hitsMask)) {
+                place(x, y, len, hor, p);
+                placed = true;
+                ++stats.placed;
+            }
+        }
+        if (!placed) return false;
+    }
+
+    body = p.fleet.body;
+    ++stats.accepted;
     return true;
 }
 
-void MonteCarloStrategy::place(int x, int y, int len, bool hor, MCPlacement& p) const {
-    for (int i = 0; i < len; ++i) {
-        int xx = x + (hor ? i : 0);
-        int yy = y + (hor ? 0 : i);
-        p.occ[yy][xx] = 1;
+void MonteCarloStrategy::accumulate(const BitMask128& body, int delta) {
+    BitMask128 occupied = body;
+    while (occupied.any()) {
+        int idx = occupied.popLowest();
+        prob_board[idx] += delta;
     }
 }
 
-std::vector<int> MonteCarloStrategy::getRemainingShips(const Board& board) const {
-    // Стандартный набор кораблей: 4,3,3,2,2,2,1,1,1,1
-    std::vector<int> ships = { 4, 3, 3, 2, 2, 2, 1, 1, 1, 1 };
-    
-    // Для монте-карло симуляции нам нужны только те корабли, которые еще не потоплены
-    // Идея: проверим доску на количество уже потопленных кораблей каждого размера
-    
-    // Временная карта для отслеживания посещенных клеток SUNK
-    std::array<std::array<bool, 10>, 10> visited = {};
-    for (auto& row : visited) row.fill(false);
-    
-    // Корабли, которые мы уже определили как потопленные (их размеры)
-    std::vector<int> sunkShips;
-    
-    // Обнаружение потопленных кораблей
-    for (int y = 0; y < 10; ++y) {
-        for (int x = 0; x < 10; ++x) {
-            if (board.isShot(x, y) && board.wasShipSunkAt(x, y) && !visited[y][x]) {
-                // Нашли потопленный корабль, определяем его размер
-                int size = 0;
-                
-                // Проверяем горизонтальное направление
-                bool isHorizontal = (x + 1 < 10 && board.isShot(x + 1, y) && board.wasShipSunkAt(x + 1, y));
-                
-                // Проверяем вертикальное направление
-                bool isVertical = (y + 1 < 10 && board.isShot(x, y + 1) && board.wasShipSunkAt(x, y + 1));
-                
-                if (isHorizontal) {
-                    // Подсчитываем горизонтальную длину
-                    int xx = x;
-                    while (xx < 10 && board.isShot(xx, y) && board.wasShipSunkAt(xx, y)) {
-                        visited[y][xx] = true;
-                        size++;
-                        xx++;
-                    }
-                } else if (isVertical) {
-                    // Подсчитываем вертикальную длину
-                    int yy = y;
-                    while (yy < 10 && board.isShot(x, yy) && board.wasShipSunkAt(x, yy)) {
-                        visited[yy][x] = true;
-                        size++;
-                        yy++;
-                    }
-                } else {
-                    // Одноклеточный корабль
-                    visited[y][x] = true;
-                    size = 1;
+void MonteCarloStrategy::build_probability(const Board& board) {
+    if (m_prob_board_valid) return;
+    if (!m_incremental) init_prob_board();
+
+    // Диагностика хода: бюджет времени и счетчики до построения карты
+    const auto start = std::chrono::steady_clock::now();
+    m_deadline = start + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+        std::chrono::duration<double, std::milli>(m_moveBudgetMs));
+    const long long attemptsBefore = m_stats.attempts;
+    const long long stepsBefore = m_chainStats.steps;
+    const long long drawnBefore = m_samplesDrawn;
+    m_lastMove = MoveStats();
+
+    // Таблица карт хранит только карты, построенные с нуля (без переноса частиц)
+    const bool fresh = !m_incremental || m_particles.empty();
+    const uint64_t tableKey = m_hash ^ configKey();
+    uint64_t bookKey = 0;
+    SampleContext ctx;
+    if (m_book && lookupBook(board, bookKey)) {
+        ++m_heatStats.book;
+        m_lastMove.stop = StopReason::CACHED;
+    } else if (m_surrogate) {
+        m_surrogate->heatmap(SurrogateModel::Observation::from(board, m_fleet), prob_board);
+        ++m_heatStats.surrogate;
+        m_lastMove.stop = StopReason::SURROGATE;
+        m_particles.clear();
+    } else if (m_table && fresh && m_table->probe(tableKey, prob_board)) {
+        ++m_heatStats.table;
+        m_lastMove.stop = StopReason::CACHED;
+        // Карта таблицы не является суммой частиц: следующая выборка строится заново
+        m_particles.clear();
+    } else if (prepareContext(board, ctx)) {
+        if (m_exact && enumerateLayouts(ctx)) {
+            ++m_heatStats.exact;
+            m_lastMove.stop = StopReason::EXACT;
+        } else if (m_exact && ctx.hitsMask.any() && enumerateTarget(ctx)) {
+            ++m_heatStats.target;
+            m_lastMove.stop = StopReason::EXACT;
+        } else if (m_corpus && !m_libraryExhausted && sampleLibrary(board)) {
+            ++m_heatStats.library;
+        } else if (m_chain && m_acceptance < m_chainThreshold && sampleChain(ctx)) {
+            ++m_heatStats.chain;
+        } else {
+            ++m_heatStats.sampled;
+            m_lastMove.stop = StopReason::QUOTA; // Цепь могла отказаться от хода
+            if (m_incremental) refillParticles(ctx);
+            else sampleHeatmap(ctx);
+        }
+        // Карты, оборванные бюджетом времени, не сохраняются для других ходов
+        if (m_lastMove.stop != StopReason::BUDGET) {
+            // Книга в режиме записи запоминает посчитанную карту позиции
+            if (bookKey != 0 && m_book->isRecording()) {
+                m_book->record(bookKey, prob_board);
+            }
+            if (m_table && fresh) {
+                m_table->store(tableKey, board.shotMask().count(), prob_board);
+            }
+        }
+    }
+
+    m_lastMove.samples = static_cast<int>(m_samplesDrawn - drawnBefore);
+    m_lastMove.tries = (m_stats.attempts - attemptsBefore) + (m_chainStats.steps - stepsBefore);
+    if (m_lastMove.tries > 0) {
+        m_lastMove.acceptance = static_cast<double>(m_lastMove.samples) / m_lastMove.tries;
+    }
+    m_lastMove.ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    ++m_stopCounts[static_cast<int>(m_lastMove.stop)];
+    m_prob_board_valid = true;
+}
+
+bool MonteCarloStrategy::lookupBook(const Board& board, uint64_t& key) {
+    // В книге только ранние позиции без раненых кораблей
+    const BitMask128 shotCells = board.shotMask();
+    if (shotCells.count() > m_book->depth() || (board.hitMask() & ~board.sunkMask()).any()) {
+        return false;
+    }
+    key = OpeningBook::key(shotCells, board.sunkMask());
+    const OpeningBook::Entry* entry = m_book->find(key);
+    if (!entry) return false;
+
+    for (int idx = 0; idx < BitMask128::CELLS; ++idx) {
+        prob_board[idx] = entry->heat[idx];
+    }
+    // Карта книги не является суммой частиц: следующая выборка строится заново
+    m_particles.clear();
+    return true;
+}
+
+uint64_t MonteCarloStrategy::configKey() const {
+    // Карты стратегий с разными параметрами построения не смешиваются. Книга и
+    // заменитель таблицу не используют (их карты не сохраняются), поэтому в ключ не входят
+    uint64_t config = static_cast<uint64_t>(m_samples);
+    config |= static_cast<uint64_t>(m_sampler == Sampler::TABLE) << 32;
+    config |= static_cast<uint64_t>(m_exact) << 33;
+    config |= static_cast<uint64_t>(m_chain) << 34;
+    config |= static_cast<uint64_t>(m_symmetry) << 35;
+    config |= static_cast<uint64_t>(m_incremental) << 36;
+    uint64_t key = ObservationHash::mix(config);
+
+    // Вещественные параметры входят в ключ своим двоичным представлением
+    auto add = [&key](uint64_t value) { key = ObservationHash::mix(key ^ value); };
+    auto bits = [](double value) {
+        uint64_t result;
+        std::memcpy(&result, &value, sizeof(result));
+        return result;
+    };
+    if (m_chain) {
+        add(static_cast<uint64_t>(m_chainBurnIn) | (static_cast<uint64_t>(m_chainThinning) << 32));
+        add(bits(m_chainThreshold));
+    }
+    // Досрочная остановка меняет число образцов карты
+    add(bits(m_stopZ));
+    add(bits(m_moveBudgetMs));
+    // Фильтр корпуса: карты разных корпусов (и без корпуса) не смешиваются
+    add(static_cast<uint64_t>(reinterpret_cast<uintptr_t>(m_corpus.get())));
+    return key;
+}
+
+void MonteCarloStrategy::sampleHeatmap(const SampleContext& ctx) {
+    int successful = 0;
+    // Симметричная позиция: генерируется доля выборки, карта сворачивается по группе
+    const int group = BoardSymmetry::groupSize(ctx.symmetry);
+    const int NEED = (m_samples + group - 1) / group;
+    // Предел неудач защищает от зацикливания, если наблюдения несовместимы с сэмплером
+    const int maxFailures = NEED * MAX_BUILD_FAILURES_FACTOR;
+    const long long attemptsBefore = m_stats.attempts;
+    StopReason stop = StopReason::QUOTA;
+    if (workerCount(NEED) > 1) {
+        // Параллельная выборка: сводим локальные карты потоков
+        for (const auto& batch : sampleParallel(NEED, maxFailures, false, ctx)) {
+            for (int idx = 0; idx < BitMask128::CELLS; ++idx) {
+                prob_board[idx] += batch.heat[idx];
+            }
+            successful += batch.accepted;
+            m_stats += batch.stats;
+            if (batch.timedOut) stop = StopReason::BUDGET;
+        }
+        if (stop != StopReason::BUDGET && successful < NEED) stop = StopReason::FAILURES;
+    } else {
+        auto randInt = [this](int lo, int hi) { return m_rng.uniformInt(lo, hi); };
+        std::vector<uint16_t> scratch;
+        BitSlicedCounter counter;
+        BitMask128 body;
+        int failures = 0;
+        while (successful < NEED) {
+            if (!sampleFleet(ctx, body, randInt, m_stats, scratch)) {
+                if (++failures >= maxFailures) {
+                    stop = StopReason::FAILURES;
+                    break;
+                }
+                if (successful > 0 && failures % STOP_CHECK_INTERVAL == 0 && pastDeadline()) {
+                    stop = StopReason::BUDGET;
+                    break;
+                }
+                continue;
+            }
+
+            // 3. учитываем образец
+            ++successful;
+            counter.add(body);
+
+            // Проверки остановки - на контрольных точках, чтобы не замедлять генератор
+            if (successful % STOP_CHECK_INTERVAL != 0 || successful == NEED) continue;
+            if (pastDeadline()) {
+                stop = StopReason::BUDGET;
+                break;
+            }
+            if (m_stopZ > 0.0 && successful >= STOP_MIN_SAMPLES) {
+                counter.addTo(prob_board);
+                counter.clear();
+                if (leaderSettled(ctx.open, successful)) {
+                    stop = StopReason::CONVERGED;
+                    break;
                 }
-                
-                // Добавляем размер потопленного корабля
-                sunkShips.push_back(size);
             }
         }
+        counter.addTo(prob_board);
     }
-    
-    // Удаляем найденные потопленные корабли из списка оставшихся
-    for (int size : sunkShips) {
-        auto it = std::find(ships.begin(), ships.end(), size);
-        if (it != ships.end()) {
-            ships.erase(it);
+    if (group > 1) {
+        BoardSymmetry::fold(prob_board, ctx.symmetry);
+        ++m_heatStats.folded;
+    }
+    m_samplesDrawn += successful;
+    m_lastMove.stop = stop;
+    const long long attempts = m_stats.attempts - attemptsBefore;
+    if (attempts > 0) m_acceptance = static_cast<double>(successful) / attempts;
+}
+
+bool MonteCarloStrategy::sampleLibrary(const Board& board) {
+    // В режиме фильтра частиц корпус дозаполняет выборку, иначе дает всю карту
+    const int count = m_incremental ? m_samples - static_cast<int>(m_particles.size()) : m_samples;
+    const size_t total = m_corpus->size();
+    if (count <= 0 || total == 0) return false;
+
+    // Расстановки корпуса содержат весь флот: потопленные корабли должны совпасть
+    // с наблюдениями целиком (их ореол свободен), раненые - продолжаться в
+    // необстрелянную клетку, иначе они уже были бы потоплены
+    CorpusFilter filter;
+    const BitMask128 sunk = board.sunkMask();
+    const BitMask128 open = board.hitMask() & ~sunk;
+    filter.forbidden = (board.shotMask() & ~board.hitMask()) | (sunk.dilate() & ~sunk);
+    filter.required = board.hitMask();
+    filter.needWound = open.any();
+    filter.wound = open.dilate() & ~board.shotMask();
+    filter.strip = sunk;
+
+    // Участок корпуса начинается со случайного места; потоки делят его на непересекающиеся части
+    const size_t limit = std::min(total, static_cast<size_t>(count) * LIBRARY_SCAN_FACTOR);
+    const size_t start = static_cast<size_t>(m_rng.uniformInt(0, static_cast<int>(total - 1)));
+    const int workers = workerCount(count);
+    std::vector<SampleBatch> batches(workers);
+    auto worker = [&](int t) {
+        const size_t offset = limit / workers * t + std::min<size_t>(t, limit % workers);
+        const size_t length = limit / workers + (static_cast<size_t>(t) < limit % workers ? 1 : 0);
+        const int quota = count / workers + (t < count % workers ? 1 : 0);
+        scanCorpus(*m_corpus, filter, start + offset, length, quota, m_incremental, batches[t]);
+    };
+    if (workers > 1) {
+        std::vector<std::thread> threads;
+        threads.reserve(workers - 1);
+        for (int t = 1; t < workers; ++t) {
+            threads.emplace_back(worker, t);
+        }
+        worker(0);
+        for (auto& thread : threads) {
+            thread.join();
         }
+    } else {
+        worker(0);
     }
-    
-    return ships;
+
+    int accepted = 0;
+    for (const auto& batch : batches) {
+        accepted += batch.accepted;
+        m_stats += batch.stats;
+    }
+    if (accepted < count) {
+        m_libraryExhausted = true;
+        return false;
+    }
+
+    if (m_incremental && m_particles.empty()) init_prob_board();
+    for (const auto& batch : batches) {
+        for (int idx = 0; idx < BitMask128::CELLS; ++idx) {
+            prob_board[idx] += batch.heat[idx];
+        }
+        if (m_incremental) m_particles.insert(m_particles.end(), batch.samples.begin(), batch.samples.end());
+    }
+    m_samplesDrawn += accepted;
+    return true;
 }
 
-void MonteCarloStrategy::init_prob_board() {
-    for (auto& row : prob_board) {
-        row.fill(0);
+void MonteCarloStrategy::scanCorpus(const FleetCorpus& corpus, const CorpusFilter& filter, size_t begin,
+                                    size_t length, int quota, bool particles, SampleBatch& batch) {
+    const BitMask128* fleets = corpus.data();
+    const size_t total = corpus.size();
+    const uint64_t needWound = filter.needWound ? 1 : 0;
+    BitSlicedCounter counter;
+    size_t pos = begin % total;
+    size_t scanned = 0;
+    while (scanned < length && batch.accepted < quota) {
+        const size_t block = std::min<size_t>({64, length - scanned, total - pos});
+        // Проверка блока без ветвлений: бит i слова - расстановка pos + i согласована
+        uint64_t matches = 0;
+        for (size_t i = 0; i < block; ++i) {
+            const BitMask128& fleet = fleets[pos + i];
+            const uint64_t clear = ((fleet.lo & filter.forbidden.lo) | (fleet.hi & filter.forbidden.hi)) == 0;
+            const uint64_t covers = ((filter.required.lo & ~fleet.lo) | (filter.required.hi & ~fleet.hi)) == 0;
+            const uint64_t wound = ((fleet.lo & filter.wound.lo) | (fleet.hi & filter.wound.hi)) != 0;
+            matches |= (clear & covers & (wound | (needWound ^ 1))) << i;
+        }
+        // Учитываем согласованные расстановки, пока не набрана квота
+        for (BitMask128 pending(matches, 0); pending.any() && batch.accepted < quota; ) {
+            const int i = pending.popLowest();
+            const BitMask128 body = fleets[pos + i] & ~filter.strip;
+            counter.add(body);
+            if (particles) batch.samples.push_back(body);
+            ++batch.accepted;
+        }
+        scanned += block;
+        pos = (pos + block) % total;
     }
+    counter.addTo(batch.heat);
+    batch.stats.attempts += static_cast<long long>(scanned);
+    batch.stats.accepted += batch.accepted;
 }
 
-void MonteCarloStrategy::updateHitsList(const Board& board) {
-    // Очищаем текущий список попаданий
-    m_hits.clear();
-    
-    // Собираем все клетки с попаданиями, но не потопленными кораблями
-    for (int y = 0; y < 10; ++y) {
-        for (int x = 0; x < 10; ++x) {
-            if (board.isShot(x, y) && 
-                board.getCell(x, y) == CellState::HIT && 
-                !board.wasShipSunkAt(x, y)) {
-                m_hits.emplace_back(x, y);
+bool MonteCarloStrategy::leaderSettled(const BitMask128& open, int n) const {
+    int first = -1, second = -1;
+    for (BitMask128 cells = open; cells.any(); ) {
+        const int value = prob_board[cells.popLowest()];
+        if (value > first) {
+            second = first;
+            first = value;
+        } else if (value > second) {
+            second = value;
+        }
+    }
+    if (second < 0 || n <= 0) return false;
+
+    const double lead = first - second;
+    const double variance = (first + second) - lead * lead / n;
+    const double bound = m_stopZ * m_stopZ * std::max(variance, 1.0);
+    // Лидер отделился от второй клетки на m_stopZ стандартных отклонений разности
+    return lead > 0.0 && lead * lead >= bound;
+}
+
+void MonteCarloStrategy::refillParticles(const SampleContext& ctx) {
+    // После точного подсчета карта не является суммой частиц: строим выборку заново
+    if (m_particles.empty()) init_prob_board();
+
+    // Дозаполняем выборку; число неудач ограничено, чтобы при редких
+    // согласованных расстановках (много попаданий) ход не зависал
+    // Симметричная позиция: генерируется доля недостающих частиц, остальное - их образы
+    const int have = static_cast<int>(m_particles.size());
+    const int group = BoardSymmetry::groupSize(ctx.symmetry);
+    const int maxFailures = std::max(1, m_samples * MAX_REFILL_FAILURES_FACTOR);
+    const int missing = std::max(0, (m_samples - have + group - 1) / group);
+    const int NEED = have + missing;
+    const long long attemptsBefore = m_stats.attempts;
+    // Доля принятых образцов (с учетом покрытия попаданий) для выбора генератора
+    // и образы новых частиц
+    auto measure = [&]() {
+        const long long attempts = m_stats.attempts - attemptsBefore;
+        const int added = static_cast<int>(m_particles.size()) - have;
+        if (attempts > 0) m_acceptance = static_cast<double>(added) / attempts;
+        if (group > 1 && added > 0) {
+            mirrorParticles(have, ctx.symmetry);
+            ++m_heatStats.folded;
+        }
+    };
+    if (workerCount(missing) > 1) {
+        for (const auto& batch : sampleParallel(missing, maxFailures, true, ctx)) {
+            for (int idx = 0; idx < BitMask128::CELLS; ++idx) {
+                prob_board[idx] += batch.heat[idx];
             }
+            m_particles.insert(m_particles.end(), batch.samples.begin(), batch.samples.end());
+            m_samplesDrawn += batch.accepted;
+            m_stats += batch.stats;
+            if (batch.timedOut) m_lastMove.stop = StopReason::BUDGET;
+        }
+        if (m_lastMove.stop != StopReason::BUDGET && static_cast<int>(m_particles.size()) < NEED) {
+            m_lastMove.stop = StopReason::FAILURES;
         }
+        measure();
+        return;
     }
+
+    auto randInt = [this](int lo, int hi) { return m_rng.uniformInt(lo, hi); };
+    std::vector<uint16_t> scratch;
+    BitSlicedCounter counter;
+    int failures = 0;
+    BitMask128 body;
+    StopReason stop = StopReason::QUOTA;
+    int added = 0;
+    while (static_cast<int>(m_particles.size()) < NEED) {
+        // Образец должен покрывать все попадания, иначе следующий фильтр
+        // сравнивал бы его с другим набором наблюдений
+        if (!sampleFleet(ctx, body, randInt, m_stats, scratch) || (ctx.hitsMask & ~body).any()) {
+            if (++failures >= maxFailures) {
+                stop = StopReason::FAILURES;
+                break;
+            }
+            if (!m_particles.empty() && failures % STOP_CHECK_INTERVAL == 0 && pastDeadline()) {
+                stop = StopReason::BUDGET;
+                break;
+            }
+            continue;
+        }
+        m_particles.push_back(body);
+        counter.add(body);
+        ++m_samplesDrawn;
+
+        // Сходимость проверяется по всей выборке, включая перенесенные частицы
+        const int total = static_cast<int>(m_particles.size());
+        if (++added % STOP_CHECK_INTERVAL != 0 || total == NEED) continue;
+        if (pastDeadline()) {
+            stop = StopReason::BUDGET;
+            break;
+        }
+        if (m_stopZ > 0.0 && total >= STOP_MIN_SAMPLES) {
+            counter.addTo(prob_board);
+            counter.clear();
+            if (leaderSettled(ctx.open, total)) {
+                stop = StopReason::CONVERGED;
+                break;
+            }
+        }
+    }
+    counter.addTo(prob_board);
+    m_lastMove.stop = stop;
+    measure();
 }
 
-void MonteCarloStrategy::build_probability(const Board& board) {
-    if (m_prob_board_valid) return;
+void MonteCarloStrategy::mirrorParticles(size_t from, uint8_t group) {
+    const size_t end = m_particles.size();
+    BitSlicedCounter counter;
+    for (int t = 1; t < BoardSymmetry::COUNT; ++t) {
+        if (!((group >> t) & 1)) continue;
+        for (size_t i = from; i < end; ++i) {
+            const BitMask128 image = BoardSymmetry::apply(m_particles[i], t);
+            m_particles.push_back(image);
+            counter.add(image);
+        }
+    }
+    counter.addTo(prob_board);
+}
+
+bool MonteCarloStrategy::sampleChain(const SampleContext& ctx) {
+    // Собственный генератор цепи, засеянный одним числом из глобального RNG
+    std::mt19937 engine(static_cast<uint32_t>(m_rng.uniformInt(0, std::numeric_limits<int>::max())));
+    auto randInt = [&engine](int lo, int hi) {
+        return std::uniform_int_distribution<int>(lo, hi)(engine);
+    };
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+
+    // Пробная выборка текущим генератором: если доля принятых восстановилась
+    // (например, после потопления), обычная выборка снова выгоднее цепи
+    std::vector<uint16_t> scratch;
+    BitMask128 body;
+    int kept = 0;
+    for (int k = 0; k < CHAIN_PROBE_DRAWS; ++k) {
+        if (sampleFleet(ctx, body, randInt, m_stats, scratch) &&
+            (!m_incremental || (ctx.hitsMask & ~body).none())) {
+            ++kept;
+        }
+    }
+    m_acceptance = static_cast<double>(kept) / CHAIN_PROBE_DRAWS;
+    if (m_acceptance >= m_chainThreshold) return false;
+
+    // Начальное состояние: последовательная расстановка из списков допустимых
+    // позиций; из нескольких попыток берется покрывающая больше всего попаданий
+    const size_t n = ctx.ships.size();
+    std::vector<uint16_t> slots(n), state;
+    int uncovered = std::numeric_limits<int>::max();
+    for (int k = 0; k < CHAIN_PROBE_DRAWS && uncovered > 0; ++k) {
+        FleetMask fleet;
+        bool complete = true;
+        for (size_t i = 0; i < n && complete; ++i) {
+            const auto& source = (i == 0 && !ctx.hitCandidates.empty()) ? ctx.hitCandidates : ctx.candidates[ctx.ships[i]];
+            scratch.clear();
+            for (uint16_t slot : source) {
+                if (fleet.fits(PlacementMasks::TABLE[slot])) scratch.push_back(slot);
+            }
+            if (scratch.empty()) {
+                complete = false;
+                continue;
+            }
+            slots[i] = scratch[randInt(0, static_cast<int>(scratch.size()) - 1)];
+            fleet.add(PlacementMasks::TABLE[slots[i]]);
+        }
+        if (!complete) continue;
+        const int missed = (ctx.hitsMask & ~fleet.body).count();
+        if (missed < uncovered) {
+            state = slots;
+            uncovered = missed;
+            body = fleet.body;
+        }
+    }
+    if (state.empty()) return false;
+
+    // Цепь Метрополиса: один корабль переносится на случайную позицию из списка
+    // своей длины (предложение симметрично). Вес расстановки - exp(-beta * k),
+    // k - число непокрытых попаданий, поэтому цепь может обходить через
+    // почти согласованные состояния, а записи с k = 0 распределены равномерно
+    // по расстановкам, согласованным со всеми наблюдениями
+    const int burnIn = m_chainBurnIn;
+    const int thinning = m_chainThinning;
+    const long long budget = (static_cast<long long>(burnIn) + static_cast<long long>(m_samples) * thinning)
+                           * CHAIN_STEP_BUDGET_FACTOR;
+    std::vector<BitMask128> records;
+    records.reserve(m_samples);
+    long long step = 0;
+    for (; step < budget && static_cast<int>(records.size()) < m_samples; ++step) {
+        if (step % STOP_CHECK_INTERVAL == 0 && !records.empty() && pastDeadline()) {
+            m_lastMove.stop = StopReason::BUDGET;
+            break;
+        }
+        const int i = randInt(0, static_cast<int>(n) - 1);
+        const auto& list = ctx.candidates[ctx.ships[i]];
+        const uint16_t slot = list[randInt(0, static_cast<int>(list.size()) - 1)];
+        const PlacementMask& proposal = PlacementMasks::TABLE[slot];
+        FleetMask others;
+        for (size_t j = 0; j < n; ++j) {
+            if (static_cast<int>(j) != i) others.add(PlacementMasks::TABLE[state[j]]);
+        }
+        if (others.fits(proposal)) {
+            const BitMask128 next = others.body | proposal.body;
+            const int missed = (ctx.hitsMask & ~next).count();
+            if (missed <= uncovered || unit(engine) < std::exp(-CHAIN_BETA * (missed - uncovered))) {
+                state[i] = slot;
+                uncovered = missed;
+                body = next;
+                ++m_chainStats.moves;
+            }
+        }
+        if (step >= burnIn && (step - burnIn) % thinning == 0 && uncovered == 0) {
+            records.push_back(body);
+        }
+    }
+    if (m_lastMove.stop != StopReason::BUDGET && static_cast<int>(records.size()) < m_samples) {
+        m_lastMove.stop = StopReason::FAILURES;
+    }
+    ++m_chainStats.runs;
+    m_chainStats.steps += step;
+    m_chainStats.samples += static_cast<long long>(records.size());
+    if (records.empty()) return false;
+
     init_prob_board();
-    updateHitsList(board);
+    m_chainStats.ess += accumulateChain(records);
+    m_samplesDrawn += static_cast<long long>(records.size());
+    // Записи цепи покрывают все попадания и служат частицами для следующих ходов
+    if (m_incremental) m_particles = std::move(records);
+    return true;
+}
 
-    const std::vector<int> baseShips = getRemainingShips(board);
-    if (baseShips.empty()) return;
+double MonteCarloStrategy::accumulateChain(const std::vector<BitMask128>& records) {
+    const int total = static_cast<int>(records.size());
+    const int batchSize = total / CHAIN_ESS_BATCHES;
+    BitSlicedCounter counter;
 
-    int successful = 0;
-    const int NEED = m_samples;
-    for (int tries = 0; successful < NEED; ++tries) {
-        MCPlacement p{};
-        auto ships = baseShips;
-        bool ok = true;
-        
-        // 1. если есть попадания, расставляем самый длинный корабль на попадания
-        if (!m_hits.empty()) {
-            // перемешиваем ships вручную (Fisher-Yates)
-            for (int idx = static_cast<int>(ships.size()) - 1; idx > 0; --idx) {
-                int j = m_rng.uniformInt(0, idx);
-                std::swap(ships[idx], ships[j]);
+    // Слишком короткая цепь: оценка дисперсии ненадежна, считаем записи независимыми
+    if (batchSize < 2) {
+        for (const auto& record : records) counter.add(record);
+        counter.addTo(prob_board);
+        return total;
+    }
+
+    // Карты по пачкам подряд идущих записей; хвост, не вошедший в пачки, - только в доску
+    std::vector<std::array<int, BitMask128::CELLS>> batches(CHAIN_ESS_BATCHES);
+    for (int b = 0; b < CHAIN_ESS_BATCHES; ++b) {
+        batches[b].fill(0);
+        for (int r = b * batchSize; r < (b + 1) * batchSize; ++r) counter.add(records[r]);
+        counter.addTo(batches[b]);
+        counter.clear();
+    }
+    for (int r = CHAIN_ESS_BATCHES * batchSize; r < total; ++r) counter.add(records[r]);
+    counter.addTo(prob_board);
+
+    // ESS = N * sum p(1-p) / sum sigma^2, где sigma^2 = batchSize * Var(средних пачек):
+    // для независимых записей отношение близко к 1, автокорреляция его уменьшает
+    const double batched = static_cast<double>(CHAIN_ESS_BATCHES) * batchSize;
+    double variance = 0.0, asymptotic = 0.0;
+    for (int idx = 0; idx < BitMask128::CELLS; ++idx) {
+        int sum = 0;
+        for (const auto& batch : batches) sum += batch[idx];
+        prob_board[idx] += sum;
+        const double p = sum / batched;
+        double spread = 0.0;
+        for (const auto& batch : batches) {
+            const double d = static_cast<double>(batch[idx]) / batchSize - p;
+            spread += d * d;
+        }
+        variance += p * (1.0 - p);
+        asymptotic += batchSize * spread / (CHAIN_ESS_BATCHES - 1);
+    }
+    if (asymptotic <= 0.0) return total;
+    return std::min(static_cast<double>(total), total * variance / asymptotic);
+}
+
+bool MonteCarloStrategy::enumerateLayouts(const SampleContext& ctx) {
+    // Верхняя оценка числа расстановок: произведение размеров списков позиций,
+    // деленное на перестановки кораблей одной длины
+    const double limit = static_cast<double>(m_samples) * EXACT_LIMIT_FACTOR;
+    double bound = 1.0;
+    int sameLength = 0;
+    for (size_t i = 0; i < ctx.ships.size(); ++i) {
+        sameLength = (i > 0 && ctx.ships[i] == ctx.ships[i - 1]) ? sameLength + 1 : 1;
+        bound *= static_cast<double>(ctx.candidates[ctx.ships[i]].size()) / sameLength;
+    }
+    if (bound > limit) return false;
+
+    // Перебор с возвратом: корабли одной длины выбираются в порядке возрастания
+    // позиции, поэтому каждая расстановка учитывается ровно один раз
+    struct Counter {
+        const SampleContext& ctx;
+        BitSlicedCounter cells;
+        uint64_t layouts = 0;
+        uint64_t nodes = 0;
+        uint64_t budget = 0;
+        bool aborted = false;
+
+        Counter(const SampleContext& context, uint64_t nodeBudget) : ctx(context), budget(nodeBudget) {}
+
+        void run(size_t shipIdx, size_t start, const FleetMask& fleet) {
+            if (shipIdx == ctx.ships.size()) {
+                if ((ctx.hitsMask & ~fleet.body).any()) return;
+                ++layouts;
+                cells.add(fleet.body);
+                return;
             }
-            std::sort(ships.begin(), ships.end(), std::greater<int>());
-            int longest = ships.front();
-
-            bool placed = false;
-            for (int k = 0; k < 200 && !placed; ++k) {
-                bool hor = m_rng.uniformInt(0,1);
-                auto [hx, hy] = m_hits[m_rng.uniformInt(0, m_hits.size()-1)];
-                int x0 = hor ? hx - m_rng.uniformInt(0, longest-1) : hx;
-                int y0 = hor ? hy : hy - m_rng.uniformInt(0, longest-1);
-                if (fits(x0, y0, longest, hor, p, board, m_hits)) {
-                    place(x0, y0, longest, hor, p);
-                    ships.erase(std::find(ships.begin(), ships.end(), longest));
-                    placed = true;
-                }
+            const int len = ctx.ships[shipIdx];
+            const auto& list = ctx.candidates[len];
+            const bool sameNext = shipIdx + 1 < ctx.ships.size() && ctx.ships[shipIdx + 1] == len;
+            for (size_t k = start; k < list.size(); ++k) {
+                if (++nodes > budget) { aborted = true; return; }
+                const PlacementMask& m = PlacementMasks::TABLE[list[k]];
+                if (!fleet.fits(m)) continue;
+                FleetMask next = fleet;
+                next.add(m);
+                // Непокрытое попадание в ореоле уже не покроет ни один корабль
+                if ((ctx.hitsMask & ~next.body & next.blocked).any()) continue;
+                run(shipIdx + 1, sameNext ? k + 1 : 0, next);
+                if (aborted) return;
             }
-            if (!placed) ok = false;
-        }
-
-        // 2. расставляем остальные корабли
-        for (int len : ships) {
-            bool placed = false;
-            for (int k = 0; k < 200 && !placed; ++k) {
-                bool hor = m_rng.uniformInt(0,1);
-                int x = m_rng.uniformInt(0, 10 - (hor ? len : 1));
-                int y = m_rng.uniformInt(0, 10 - (hor ? 1 : len));
-                if (fits(x, y, len, hor, p, board, m_hits)) {
-                    place(x, y, len, hor, p);
-                    placed = true;
-                }
+        }
+    };
+
+    Counter counter(ctx, static_cast<uint64_t>(limit) * EXACT_NODE_BUDGET_FACTOR);
+    counter.run(0, 0, FleetMask{});
+    if (counter.aborted || counter.layouts == 0) return false;
+
+    prob_board.fill(0);
+    counter.cells.addTo(prob_board);
+    m_particles.clear();
+    return true;
+}
+
+bool MonteCarloStrategy::enumerateTarget(const SampleContext& ctx) {
+    // Все позиции раненого корабля: любая оставшаяся длина, покрывающая все попадания
+    struct Covering { uint16_t slot; size_t shipIdx; };
+    std::vector<Covering> covering;
+    for (size_t i = 0; i < ctx.ships.size(); ++i) {
+        if (i > 0 && ctx.ships[i] == ctx.ships[i - 1]) continue;
+        for (uint16_t slot : ctx.candidates[ctx.ships[i]]) {
+            if ((PlacementMasks::TABLE[slot].body & ctx.hitsMask) == ctx.hitsMask) {
+                covering.push_back({slot, i});
             }
-            if (!placed) { ok = false; break; }
         }
+    }
+    if (covering.empty()) return false;
 
-        if (!ok) continue;
+    // Вес позиции - число расстановок остального флота при ней. Оно оценивается
+    // последовательной выборкой (оценка Кнута: произведение числа свободных позиций
+    // на каждом шаге), деленной на перестановки одинаковых кораблей
+    const int runs = std::max(1, m_samples / static_cast<int>(covering.size()));
+    std::array<double, BitMask128::CELLS> heat{};
+    double total = 0.0;
+    std::vector<uint16_t> scratch;
+    for (const auto& c : covering) {
+        double permutations = 1.0;
+        int sameLength = 0;
+        int prevLen = 0;
+        for (size_t i = 0; i < ctx.ships.size(); ++i) {
+            if (i == c.shipIdx) continue;
+            sameLength = ctx.ships[i] == prevLen ? sameLength + 1 : 1;
+            prevLen = ctx.ships[i];
+            permutations *= sameLength;
+        }
 
-        // 3. учитываем образец
-        ++successful;
-        for (int yy = 0; yy < 10; ++yy) {
-            for (int xx = 0; xx < 10; ++xx) {
-                if (p.occ[yy][xx]) {
-                    prob_board[yy][xx] += 1;
+        for (int r = 0; r < runs; ++r) {
+            FleetMask fleet;
+            fleet.add(PlacementMasks::TABLE[c.slot]);
+            double estimate = 1.0;
+            for (size_t i = 0; i < ctx.ships.size(); ++i) {
+                if (i == c.shipIdx) continue;
+                scratch.clear();
+                for (uint16_t slot : ctx.candidates[ctx.ships[i]]) {
+                    if (fleet.fits(PlacementMasks::TABLE[slot])) scratch.push_back(slot);
                 }
+                if (scratch.empty()) { estimate = 0.0; break; }
+                estimate *= static_cast<double>(scratch.size());
+                fleet.add(PlacementMasks::TABLE[scratch[m_rng.uniformInt(0, static_cast<int>(scratch.size()) - 1)]]);
             }
+            if (estimate <= 0.0) continue;
+
+            const double weight = estimate / (permutations * runs);
+            total += weight;
+            BitMask128 occupied = fleet.body;
+            while (occupied.any()) heat[occupied.popLowest()] += weight;
         }
     }
+    if (total <= 0.0) return false;
 
-    m_prob_board_valid = true;
+    // Нормируем к масштабу обычной выборки из m_samples образцов
+    for (int idx = 0; idx < BitMask128::CELLS; ++idx) {
+        prob_board[idx] = static_cast<int>(std::lround(heat[idx] / total * m_samples));
+    }
+    m_particles.clear();
+    return true;
+}
+
+int MonteCarloStrategy::workerCount(int count) const {
+    int threads = m_threads;
+    if (threads == 0) {
+        threads = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+    }
+    return std::max(1, std::min(threads, count / MIN_SAMPLES_PER_THREAD));
+}
+
+std::vector<MonteCarloStrategy::SampleBatch> MonteCarloStrategy::sampleParallel(
+        int count, int maxFailures, bool particles, const SampleContext& ctx) {
+    const int workers = workerCount(count);
+    // Единственное обращение к глобальному RNG за ход: базовый сид потоков
+    const uint32_t baseSeed = static_cast<uint32_t>(m_rng.uniformInt(0, std::numeric_limits<int>::max()));
+
+    std::vector<SampleBatch> batches(workers);
+    auto worker = [&](int t) {
+        std::seed_seq seq{baseSeed, static_cast<uint32_t>(t)};
+        std::mt19937 engine(seq);
+        auto randInt = [&engine](int lo, int hi) {
+            return std::uniform_int_distribution<int>(lo, hi)(engine);
+        };
+
+        // Фиксированная квота потока: остаток распределяется по первым потокам
+        const int quota = count / workers + (t < count % workers ? 1 : 0);
+        const int failureLimit = std::max(1, maxFailures / workers);
+        SampleBatch& batch = batches[t];
+        std::vector<uint16_t> scratch;
+        BitSlicedCounter counter;
+        int failures = 0;
+        BitMask128 body;
+        int tries = 0;
+        while (batch.accepted < quota && failures < failureLimit) {
+            // Бюджет времени проверяется каждые STOP_CHECK_INTERVAL попыток
+            if (++tries % STOP_CHECK_INTERVAL == 0 && batch.accepted > 0 && pastDeadline()) {
+                batch.timedOut = true;
+                break;
+            }
+            if (!sampleFleet(ctx, body, randInt, batch.stats, scratch) ||
+                (particles && (ctx.hitsMask & ~body).any())) {
+                ++failures;
+                continue;
+            }
+            ++batch.accepted;
+            if (particles) batch.samples.push_back(body);
+            counter.add(body);
+        }
+        counter.addTo(batch.heat);
+    };
+
+    std::vector<std::thread> threads;
+    threads.reserve(workers - 1);
+    for (int t = 1; t < workers; ++t) {
+        threads.emplace_back(worker, t);
+    }
+    worker(0); // Текущий поток тоже генерирует свою часть
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    return batches;
+}
+
+void MonteCarloStrategy::filterParticles(int x, int y, bool hit) {
+    const int idx = BitMask128::index(x, y);
+    size_t kept = 0;
+    for (size_t i = 0; i < m_particles.size(); ++i) {
+        if (m_particles[i].test(idx) == hit) {
+            m_particles[kept++] = m_particles[i];
+        } else {
+            accumulate(m_particles[i], -1);
+        }
+    }
+    m_samplesDropped += static_cast<long long>(m_particles.size() - kept);
+    m_particles.resize(kept);
+}
+
+void MonteCarloStrategy::foldSunkShip(const SunkShip& sunk) {
+    const BitMask128& ship = sunk.cells;
+    const BitMask128& halo = sunk.halo;
+
+    size_t kept = 0;
+    for (size_t i = 0; i < m_particles.size(); ++i) {
+        const BitMask128& body = m_particles[i];
+        if ((body & ship) == ship && (body & halo).none()) {
+            accumulate(ship, -1);
+            m_particles[kept++] = body & ~ship;
+        } else {
+            accumulate(body, -1);
+        }
+    }
+    m_samplesDropped += static_cast<long long>(m_particles.size() - kept);
+    m_particles.resize(kept);
+}
+
+void MonteCarloStrategy::clearParticles() {
+    m_particles.clear();
+    init_prob_board();
 }
 
 // Константы для направлений обхода (вверх, вправо, вниз, влево)
@@ -263,173 +970,56 @@ const int dx[4] = {0, 1, 0, -1};
 const int dy[4] = {-1, 0, 1, 0};
 
 void MonteCarloStrategy::addTargetsAroundHit(int x, int y) {
-    // Если уже есть несколько попаданий, определяем их ориентацию
-    bool isVertical = false;
-    bool isHorizontal = false;
-    
-    if (m_hits.size() > 1) {
-        // Проверяем вертикальную ориентацию
-        bool allSameX = true;
-        int firstX = m_hits[0].first;
-        
-        // Проверяем горизонтальную ориентацию
-        bool allSameY = true;
-        int firstY = m_hits[0].second;
-        
-        for (size_t i = 1; i < m_hits.size(); ++i) {
-            if (m_hits[i].first != firstX)
-                allSameX = false;
-            if (m_hits[i].second != firstY)
-                allSameY = false;
+    // Клетка годится в цель, если она на поле, не обстреляна и не исключена
+    const BitMask128 closed = m_shotCells | m_fleet.halo();
+    auto pushTarget = [&](int nx, int ny) {
+        if (inside(nx, ny) && !closed.test(BitMask128::index(nx, ny))) {
+            m_targets.push(nx, ny);
         }
-        
-        isVertical = allSameX && !allSameY;
-        isHorizontal = allSameY && !allSameX;
+    };
+
+    // Если уже есть несколько попаданий, определяем их ориентацию
+    // по крайним точкам: общая X - вертикаль, общая Y - горизонталь
+    int minX = 10, maxX = -1, minY = 10, maxY = -1;
+    for (BitMask128 hits = m_hits; hits.any(); ) {
+        const int idx = hits.popLowest();
+        minX = std::min(minX, idx % 10);
+        maxX = std::max(maxX, idx % 10);
+        minY = std::min(minY, idx / 10);
+        maxY = std::max(maxY, idx / 10);
     }
+    const bool several = m_hits.count() > 1;
+    const bool isVertical = several && minX == maxX && minY != maxY;
+    const bool isHorizontal = several && minY == maxY && minX != maxX;
     
-    // Если ориентация определена
-    if (isVertical || isHorizontal) {
-        // Находим крайние точки
-        int minX = 10, maxX = -1, minY = 10, maxY = -1;
-        for (const auto& hit : m_hits) {
-            minX = std::min(minX, hit.first);
-            maxX = std::max(maxX, hit.first);
-            minY = std::min(minY, hit.second);
-            maxY = std::max(maxY, hit.second);
-        }
-        
-        // Для вертикальной ориентации проверяем клетки сверху и снизу
-        if (isVertical) {
-            // Клетка сверху от верхней точки
-            int nx = minX;
-            int ny = minY - 1;
-            
-            if (inside(nx, ny) && 
-                std::find(shots.begin(), shots.end(), std::make_pair(nx, ny)) == shots.end() &&
-                m_excluded_cells.find(std::make_pair(nx, ny)) == m_excluded_cells.end()) {
-                m_targets.emplace(nx, ny);
-            }
-            
-            // Клетка снизу от нижней точки
-            nx = minX;
-            ny = maxY + 1;
-            
-            if (inside(nx, ny) && 
-                std::find(shots.begin(), shots.end(), std::make_pair(nx, ny)) == shots.end() &&
-                m_excluded_cells.find(std::make_pair(nx, ny)) == m_excluded_cells.end()) {
-                m_targets.emplace(nx, ny);
-            }
-        } 
-        // Для горизонтальной ориентации проверяем клетки слева и справа
-        else if (isHorizontal) {
-            // Клетка слева от левой точки
-            int nx = minX - 1;
-            int ny = minY;
-            
-            if (inside(nx, ny) && 
-                std::find(shots.begin(), shots.end(), std::make_pair(nx, ny)) == shots.end() &&
-                m_excluded_cells.find(std::make_pair(nx, ny)) == m_excluded_cells.end()) {
-                m_targets.emplace(nx, ny);
-            }
-            
-            // Клетка справа от правой точки
-            nx = maxX + 1;
-            ny = minY;
-            
-            if (inside(nx, ny) && 
-                std::find(shots.begin(), shots.end(), std::make_pair(nx, ny)) == shots.end() &&
-                m_excluded_cells.find(std::make_pair(nx, ny)) == m_excluded_cells.end()) {
-                m_targets.emplace(nx, ny);
-            }
-        }
-    } 
-    else {
+    if (isVertical) {
+        // Клетки сверху от верхней точки и снизу от нижней
+        pushTarget(minX, minY - 1);
+        pushTarget(minX, maxY + 1);
+    } else if (isHorizontal) {
+        // Клетки слева от левой точки и справа от правой
+        pushTarget(minX - 1, minY);
+        pushTarget(maxX + 1, minY);
+    } else {
         // Если ориентация неизвестна, добавляем все 4 направления
         for (int i = 0; i < 4; ++i) {
-            int nx = x + dx[i];
-            int ny = y + dy[i];
-            
-            // Если клетка в границах, не была обстреляна и не исключена
-            if (inside(nx, ny) && 
-                std::find(shots.begin(), shots.end(), std::make_pair(nx, ny)) == shots.end() &&
-                m_excluded_cells.find(std::make_pair(nx, ny)) == m_excluded_cells.end()) {
-                m_targets.emplace(nx, ny);
-            }
+            pushTarget(x + dx[i], y + dy[i]);
         }
     }
 }
 
 void MonteCarloStrategy::removeFromProbBoard(int x, int y) {
     if (inside(x, y)) {
-        prob_board[y][x] = 0;
+        prob_board[BitMask128::index(x, y)] = 0;
     }
 }
 
-void MonteCarloStrategy::markSurroundingCellsAsUnavailable(const Board& board) {
-    // Временная карта для отслеживания посещенных клеток с потопленными кораблями
-    std::array<std::array<bool, 10>, 10> visited = {};
-    for (auto& row : visited) row.fill(false);
-    
-    // Находим все потопленные корабли на доске
-    for (int y = 0; y < 10; ++y) {
-        for (int x = 0; x < 10; ++x) {
-            if (board.isShot(x, y) && board.wasShipSunkAt(x, y) && !visited[y][x]) {
-                // Нашли потопленный корабль, определяем его размер и ориентацию
-                std::vector<std::pair<int, int>> shipCells;
-                
-                // Проверяем горизонтальную ориентацию
-                bool isHorizontal = (x + 1 < 10 && board.isShot(x + 1, y) && 
-                                     board.wasShipSunkAt(x + 1, y));
-                
-                // Проверяем вертикальную ориентацию
-                bool isVertical = (y + 1 < 10 && board.isShot(x, y + 1) && 
-                                  board.wasShipSunkAt(x, y + 1));
-                
-                if (isHorizontal) {
-                    // Собираем все клетки горизонтального корабля
-                    int xx = x;
-                    while (xx < 10 && board.isShot(xx, y) && board.wasShipSunkAt(xx, y)) {
-                        shipCells.emplace_back(xx, y);
-                        visited[y][xx] = true;
-                        xx++;
-                    }
-                } else if (isVertical) {
-                    // Собираем все клетки вертикального корабля
-                    int yy = y;
-                    while (yy < 10 && board.isShot(x, yy) && board.wasShipSunkAt(x, yy)) {
-                        shipCells.emplace_back(x, yy);
-                        visited[yy][x] = true;
-                        yy++;
-                    }
-                } else {
-                    // Одноклеточный корабль
-                    shipCells.emplace_back(x, y);
-                    visited[y][x] = true;
-                }
-                
-                // Теперь помечаем все окружающие клетки как недоступные для выстрелов
-                for (const auto& cell : shipCells) {
-                    int cellX = cell.first;
-                    int cellY = cell.second;
-                    
-                    // Проходим по всем соседним клеткам (включая диагональные)
-                    for (int dy = -1; dy <= 1; ++dy) {
-                        for (int dx = -1; dx <= 1; ++dx) {
-                            int nx = cellX + dx;
-                            int ny = cellY + dy;
-                            
-                            // Проверяем, что клетка внутри границ и не является частью корабля
-                            if (inside(nx, ny) && 
-                                !(board.isShot(nx, ny) && board.wasShipSunkAt(nx, ny))) {
-                                m_excluded_cells.emplace(nx, ny);
-                                // Также обнуляем вероятность для этой клетки
-                                removeFromProbBoard(nx, ny);
-                            }
-                        }
-                    }
-                }
-            }
-        }
+void MonteCarloStrategy::markSurroundingCellsAsUnavailable(const SunkShip& ship) {
+    // Ореол корабля (соседние клетки, включая диагональные) попадает в исключенные
+    // клетки оставшегося флота; обнуляем вероятность для этих клеток
+    m_fleet.update(ship);
+    for (BitMask128 halo = ship.halo; halo.any(); ) {
+        prob_board[halo.popLowest()] = 0;
     }
 }
 
@@ -437,25 +1027,23 @@ std::pair<int, int> MonteCarloStrategy::getNextShot(const Board& board) {
     // при первом ходе партии сбрасываем флаг валидности вероятностной карты
     if (shots.empty()) {
         m_prob_board_valid = false;
+        if (m_incremental) clearParticles();
     }
     // Если мы в режиме добивания и очередь не пуста
     if (m_targeting_mode && !m_targets.empty()) {
         // Берем клетку из очереди
-        std::pair<int, int> target = m_targets.front();
-        m_targets.pop();
+        const BitMask128 closed = m_shotCells | m_fleet.halo();
+        std::pair<int, int> target = m_targets.pop();
         
         // Проверяем, что клетка еще не была обстреляна и не исключена
-        while (!m_targets.empty() && 
-               (std::find(shots.begin(), shots.end(), target) != shots.end() ||
-                m_excluded_cells.find(target) != m_excluded_cells.end())) {
-            target = m_targets.front();
-            m_targets.pop();
+        while (!m_targets.empty() && closed.test(BitMask128::index(target.first, target.second))) {
+            target = m_targets.pop();
         }
         
         // Если нашли подходящую клетку, стреляем туда
-        if (std::find(shots.begin(), shots.end(), target) == shots.end() &&
-            m_excluded_cells.find(target) == m_excluded_cells.end()) {
+        if (!closed.test(BitMask128::index(target.first, target.second))) {
             shots.push_back(target);
+            m_shotCells.set(BitMask128::index(target.first, target.second));
             return target;
         }
     }
@@ -467,28 +1055,15 @@ std::pair<int, int> MonteCarloStrategy::getNextShot(const Board& board) {
         build_probability(board);
     }
     
-    // Находим клетку с максимальной "температурой"
-    int bestHeat = -1;
-    int bestX = -1;
-    int bestY = -1;
-    
-    for (int y = 0; y < 10; ++y) {
-        for (int x = 0; x < 10; ++x) {
-            // Проверяем, что клетка не исключена и не была обстреляна
-            if (!board.wasShotAt(x, y) && 
-                m_excluded_cells.find(std::make_pair(x, y)) == m_excluded_cells.end() && 
-                prob_board[y][x] > bestHeat) {
-                bestHeat = prob_board[y][x];
-                bestX = x;
-                bestY = y;
-                }
-            }
-        }
+    // Находим клетку с максимальной "температурой" среди не обстрелянных и не исключенных
+    const BitMask128 allowed = ~board.shotMask() & ~m_fleet.halo();
+    const int best = HeatmapOps::maskedArgmax(prob_board, allowed);
         
     // Если нашли хотя бы одну подходящую клетку
-    if (bestHeat >= 0) {
-        auto nextShot = std::make_pair(bestX, bestY);
+    if (best >= 0) {
+        auto nextShot = std::make_pair(best % 10, best / 10);
         shots.push_back(nextShot);
+        m_shotCells.set(best);
         return nextShot;
     }
     
@@ -498,101 +1073,78 @@ std::pair<int, int> MonteCarloStrategy::getNextShot(const Board& board) {
     auto nextShot = fallbackStrategy.getNextShot(board);
     
     // Пропускаем исключенные клетки
-    while (m_excluded_cells.find(nextShot) != m_excluded_cells.end()) {
+    while (inside(nextShot.first, nextShot.second) &&
+           m_fleet.halo().test(BitMask128::index(nextShot.first, nextShot.second))) {
         nextShot = fallbackStrategy.getNextShot(board);
     }
     
     shots.push_back(nextShot);
+    if (inside(nextShot.first, nextShot.second)) {
+        m_shotCells.set(BitMask128::index(nextShot.first, nextShot.second));
+    }
     return nextShot;
 }
 
 void MonteCarloStrategy::notifyShotResult(int x, int y, bool hit, bool sunk, const Board& board) {
+    // Хеш наблюдений: выстрел добавляет клетку, потопление переводит клетки корабля в SUNK
+    // Потопленный корабль сообщает доска: клетки, длина и ореол без обхода поля
+    const SunkShip& sunkShip = board.lastSunk();
+    const int shotIdx = BitMask128::index(x, y);
+    m_hash ^= ObservationHash::key(hit ? ObservationHash::HIT : ObservationHash::MISS, shotIdx);
+    if (sunk) {
+        for (BitMask128 ship = sunkShip.cells; ship.any(); ) {
+            const int idx = ship.popLowest();
+            m_hash ^= ObservationHash::key(ObservationHash::HIT, idx) ^ ObservationHash::key(ObservationHash::SUNK, idx);
+        }
+    }
+
+    // В режиме фильтра частиц сначала согласуем выборку с выстрелом
+    if (m_incremental) {
+        filterParticles(x, y, hit);
+        if (sunk) foldSunkShip(sunkShip);
+    }
+    
     // Если попали, добавляем соседние клетки в очередь целей и переходим в режим добивания
     if (hit) {
         m_targeting_mode = true;
         
-        // Добавляем координаты попадания в список и в очередь добивания
-        m_hits.emplace_back(x, y);
+        // Добавляем координаты попадания в маску и в очередь добивания
+        m_hits.set(BitMask128::index(x, y));
         addTargetsAroundHit(x, y);
         
         // Если есть несколько попаданий, проверяем, не образуют ли они линию
-        if (m_hits.size() > 1) {
-            bool horizontal_line = true;
-            bool vertical_line = true;
-            int base_y = m_hits[0].second;
-            int base_x = m_hits[0].first;
-            
-            for (size_t i = 1; i < m_hits.size(); ++i) {
-                if (m_hits[i].second != base_y)
-                    horizontal_line = false;
-                if (m_hits[i].first != base_x)
-                    vertical_line = false;
+        if (m_hits.count() > 1) {
+            int min_x = 10, max_x = -1, min_y = 10, max_y = -1;
+            for (BitMask128 hits = m_hits; hits.any(); ) {
+                const int idx = hits.popLowest();
+                min_x = std::min(min_x, idx % 10);
+                max_x = std::max(max_x, idx % 10);
+                min_y = std::min(min_y, idx / 10);
+                max_y = std::max(max_y, idx / 10);
             }
+            const bool horizontal_line = min_y == max_y;
+            const bool vertical_line = min_x == max_x;
+            const BitMask128 closed = m_shotCells | m_fleet.halo();
             
-            // Если попадания образуют линию, приоритизируем клетки в этом направлении
+            // Если попадания образуют линию, приоритизируем клетки в этом направлении:
+            // очередь заменяется клетками за крайними попаданиями
             if (horizontal_line && !vertical_line) {
-                // Находим крайние точки по X
-                int min_x = base_x;
-                int max_x = base_x;
-                for (const auto& hit : m_hits) {
-                    min_x = std::min(min_x, hit.first);
-                    max_x = std::max(max_x, hit.first);
+                m_targets.clear();
+                if (min_x > 0 && !closed.test(BitMask128::index(min_x - 1, min_y))) {
+                    m_targets.push(min_x - 1, min_y);
                 }
-                
-                // Очищаем текущую очередь
-                std::queue<std::pair<int, int>> new_targets;
-                
-                // Добавляем только клетки слева и справа от крайних попаданий
-                if (min_x > 0 && !std::any_of(shots.begin(), shots.end(), 
-                                              [min_x, base_y](const auto& s) { 
-                                                  return s.first == min_x - 1 && s.second == base_y; 
-                                              }) &&
-                   m_excluded_cells.find(std::make_pair(min_x - 1, base_y)) == m_excluded_cells.end()) {
-                    new_targets.emplace(min_x - 1, base_y);
+                if (max_x < 9 && !closed.test(BitMask128::index(max_x + 1, min_y))) {
+                    m_targets.push(max_x + 1, min_y);
                 }
-                
-                if (max_x < 9 && !std::any_of(shots.begin(), shots.end(), 
-                                             [max_x, base_y](const auto& s) { 
-                                                 return s.first == max_x + 1 && s.second == base_y; 
-                                             }) &&
-                   m_excluded_cells.find(std::make_pair(max_x + 1, base_y)) == m_excluded_cells.end()) {
-                    new_targets.emplace(max_x + 1, base_y);
-                }
-                
-                // Заменяем очередь целей
-                m_targets = new_targets;
             }
             else if (!horizontal_line && vertical_line) {
-                // Находим крайние точки по Y
-                int min_y = base_y;
-                int max_y = base_y;
-                for (const auto& hit : m_hits) {
-                    min_y = std::min(min_y, hit.second);
-                    max_y = std::max(max_y, hit.second);
-                }
-                
-                // Очищаем текущую очередь
-                std::queue<std::pair<int, int>> new_targets;
-                
-                // Добавляем только клетки сверху и снизу от крайних попаданий
-                if (min_y > 0 && !std::any_of(shots.begin(), shots.end(), 
-                                              [base_x, min_y](const auto& s) { 
-                                                  return s.first == base_x && s.second == min_y - 1; 
-                                              }) &&
-                   m_excluded_cells.find(std::make_pair(base_x, min_y - 1)) == m_excluded_cells.end()) {
-                    new_targets.emplace(base_x, min_y - 1);
+                m_targets.clear();
+                if (min_y > 0 && !closed.test(BitMask128::index(min_x, min_y - 1))) {
+                    m_targets.push(min_x, min_y - 1);
                 }
-                
-                if (max_y < 9 && !std::any_of(shots.begin(), shots.end(), 
-                                             [base_x, max_y](const auto& s) { 
-                                                 return s.first == base_x && s.second == max_y + 1; 
-                                             }) &&
-                   m_excluded_cells.find(std::make_pair(base_x, max_y + 1)) == m_excluded_cells.end()) {
-                    new_targets.emplace(base_x, max_y + 1);
+                if (max_y < 9 && !closed.test(BitMask128::index(min_x, max_y + 1))) {
+                    m_targets.push(min_x, max_y + 1);
                 }
-                
-                // Заменяем очередь целей
-                m_targets = new_targets;
             }
         }
         
@@ -608,14 +1160,14 @@ void MonteCarloStrategy::notifyShotResult(int x, int y, bool hit, bool sunk, con
     
     // Если потопили корабль
     if (sunk) {
-        // Помечаем клетки вокруг потопленного корабля как недоступные
-        markSurroundingCellsAsUnavailable(board);
+        // Вычеркиваем корабль из оставшегося флота и помечаем клетки вокруг него как недоступные
+        markSurroundingCellsAsUnavailable(sunkShip);
         
-        // Очищаем список попаданий, так как корабль уже потоплен
-        m_hits.clear();
+        // Очищаем маску попаданий, так как корабль уже потоплен
+        m_hits = BitMask128();
         
         // Очищаем очередь целей
-        while (!m_targets.empty()) m_targets.pop();
+        m_targets.clear();
         
         // Выходим из режима добивания
         m_targeting_mode = false;
@@ -630,11 +1182,18 @@ void MonteCarloStrategy::reset() {
     init_prob_board();
     m_targeting_mode = false;
     
-    // Очищаем очередь целей и список попаданий
-    while (!m_targets.empty()) m_targets.pop();
-    m_hits.clear();
-    // Очищаем список исключенных клеток
-    m_excluded_cells.clear();
+    m_shotCells = BitMask128();
+    
+    // Очищаем очередь целей и маску попаданий
+    m_targets.clear();
+    m_hits = BitMask128();
+    // Очищаем маску исключенных клеток и восстанавливаем полный флот
+    m_fleet.reset();
+    // Выборка фильтра частиц и замер генератора относятся к прошлой партии
+    m_particles.clear();
+    m_acceptance = 1.0;
+    m_hash = 0;
+    m_libraryExhausted = false;
     // Сбрасываем флаг валидности вероятностной карты для новой игры
     m_prob_board_valid = false;
 }
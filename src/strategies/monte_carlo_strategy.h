@@ -2,14 +2,66 @@
 
 #include "strategy.h"
 #include "../models/board.h"
+#include "../models/placement_masks.h"
+#include "../models/heatmap.h"
+#include "../models/symmetry.h"
+#include "../models/remaining_fleet.h"
+#include "opening_book.h"
+#include "transposition_table.h"
+#include "fleet_corpus.h"
+#include "surrogate_model.h"
 #include "../utils/rng.h"
 #include <string>
 #include <vector>
 #include <utility>
 #include <array>
 #include <memory>
-#include <queue>
-#include <set>
+#include <algorithm>
+#include <chrono>
+
+/**
+ * @brief Счетчики генератора расстановок (для оценки доли принятых образцов)
+ */
+struct SamplerStats {
+    long long attempts = 0; ///< Попыток сгенерировать флот
+    long long accepted = 0; ///< Успешно сгенерированных флотов
+    long long draws = 0;    ///< Выбранных позиций кораблей
+    long long placed = 0;   ///< Позиций, оказавшихся допустимыми
+
+    SamplerStats& operator+=(const SamplerStats& o) {
+        attempts += o.attempts;
+        accepted += o.accepted;
+        draws += o.draws;
+        placed += o.placed;
+        return *this;
+    }
+};
+
+/**
+ * @brief Счетчики способов построения тепловой карты по ходам
+ */
+struct HeatmapStats {
+    long long sampled = 0; ///< Карта построена выборкой
+    long long exact = 0;   ///< Полный перебор всех согласованных расстановок
+    long long target = 0;  ///< Перебор позиций раненого корабля, остальной флот - выборкой
+    long long chain = 0;   ///< Цепь Маркова перемещений кораблей (MCMC)
+    long long book = 0;    ///< Карта взята из дебютной книги
+    long long table = 0;   ///< Карта взята из общей таблицы карт
+    long long library = 0; ///< Карта собрана фильтром корпуса расстановок
+    long long surrogate = 0; ///< Карта предсказана моделью-заменителем
+    long long folded = 0;  ///< Из карт выборкой: свернуто по симметриям наблюдения
+};
+
+/**
+ * @brief Счетчики цепи Маркова генератора расстановок
+ */
+struct ChainStats {
+    long long runs = 0;    ///< Запусков цепи
+    long long steps = 0;   ///< Предложенных перемещений кораблей
+    long long moves = 0;   ///< Принятых перемещений
+    long long samples = 0; ///< Записанных согласованных состояний
+    double ess = 0.0;      ///< Сумма эффективных размеров выборки по запускам
+};
 
 /**
  * @brief Стратегия стрельбы на основе метода Монте-Карло
@@ -23,19 +75,196 @@ private:
     int m_samples;                          ///< Количество симуляций для каждого хода
     std::vector<std::pair<int, int>> shots; ///< История выстрелов
     RNG m_rng;                              ///< Генератор случайных чисел
-    std::array<std::array<int, 10>, 10> prob_board{}; ///< Вероятностная доска ("тепловая карта")
+    std::array<int, BitMask128::CELLS> prob_board{}; ///< Вероятностная доска ("тепловая карта"), индекс y * 10 + x
+    
+    /**
+     * @brief Очередь клеток добивания фиксированной емкости (без выделения памяти)
+     * 
+     * Выдает клетки в порядке постановки, как std::queue. Клетка, уже стоящая
+     * в очереди, повторно не ставится: ее вторая копия все равно была бы
+     * пропущена как обстрелянная, поэтому в очереди не больше 100 клеток.
+     */
+    struct TargetQueue {
+        std::array<uint8_t, BitMask128::CELLS> cells{}; ///< Кольцевой буфер индексов клеток
+        BitMask128 queued;                              ///< Клетки, стоящие в очереди
+        int head = 0;
+        int size = 0;
+
+        bool empty() const { return size == 0; }
+
+        void push(int x, int y) {
+            const int idx = BitMask128::index(x, y);
+            if (queued.test(idx)) return;
+            queued.set(idx);
+            cells[(head + size++) % BitMask128::CELLS] = static_cast<uint8_t>(idx);
+        }
+
+        std::pair<int, int> pop() {
+            const int idx = cells[head];
+            head = (head + 1) % BitMask128::CELLS;
+            --size;
+            queued.reset(idx);
+            return {idx % BitMask128::SIDE, idx / BitMask128::SIDE};
+        }
+
+        void clear() {
+            head = size = 0;
+            queued = BitMask128();
+        }
+    };
     
     bool m_targeting_mode;                  ///< Режим добивания раненых кораблей
-    std::queue<std::pair<int, int>> m_targets; ///< Очередь клеток для добивания
-    std::vector<std::pair<int, int>> m_hits;   ///< Список клеток с попаданиями
+    TargetQueue m_targets;                  ///< Очередь клеток для добивания
+    BitMask128 m_shotCells;                 ///< Обстрелянные клетки (маска истории shots)
+    BitMask128 m_hits;                      ///< Клетки с попаданиями по раненым кораблям
     bool m_prob_board_valid;                ///< Флаг валидности вероятностной доски
-    std::set<std::pair<int, int>> m_excluded_cells; ///< Клетки, исключенные из рассмотрения (вокруг потопленных кораблей)
+    RemainingFleet m_fleet;                 ///< Непотопленные корабли и ореолы потопленных (исключенные клетки)
+    
+    bool m_incremental = false;             ///< Режим фильтра частиц: выборка переживает ходы
+    std::vector<BitMask128> m_particles;    ///< Сохраненные образцы (маски клеток оставшихся кораблей)
+    long long m_samplesDrawn = 0;           ///< Всего сгенерировано образцов (для диагностики)
+    long long m_samplesDropped = 0;         ///< Всего отброшено образцов фильтром частиц
+    
+    /// Предел неудачных попыток дозаполнения выборки (в долях m_samples)
+    static constexpr int MAX_REFILL_FAILURES_FACTOR = 1;
+    
+    /// Предел неудачных попыток при полном пересчете (в долях m_samples)
+    static constexpr int MAX_BUILD_FAILURES_FACTOR = 20;
+    
+    bool m_exact = true;                    ///< Точный перебор, когда расстановок немного
+    bool m_symmetry = true;                 ///< Свертка выборки по симметриям наблюдения
+    HeatmapStats m_heatStats;               ///< Счетчики способов построения карты
+    /// Порог полного перебора: верхняя оценка числа расстановок (в долях m_samples)
+    static constexpr int EXACT_LIMIT_FACTOR = 8;
+    /// Предел узлов перебора (в долях порога), после которого он прерывается
+    static constexpr int EXACT_NODE_BUDGET_FACTOR = 4;
+    
+    int m_threads = 1;                      ///< Потоков для генерации выборки (0 - по числу ядер, 1 - последовательно)
+    /// Минимум образцов на поток: меньшие выборки не окупают запуск потоков
+    static constexpr int MIN_SAMPLES_PER_THREAD = 128;
+    
+public:
+    /**
+     * @brief Способ генерации расстановок
+     */
+    enum class Sampler {
+        REJECTION, ///< Случайные позиции с проверкой fits() (до 200 попыток на корабль)
+        TABLE      ///< Равномерный выбор из списка еще допустимых позиций
+    };
+    
+    /**
+     * @brief Почему закончилось построение карты на ходе
+     */
+    enum class StopReason {
+        QUOTA,     ///< Набрано m_samples образцов
+        CONVERGED, ///< Лучшая клетка статистически отделилась от второй
+        BUDGET,    ///< Исчерпан бюджет времени хода
+        FAILURES,  ///< Исчерпан предел неудачных попыток генератора
+        EXACT,     ///< Карта посчитана перебором (полным или позиций раненого корабля)
+        CACHED,    ///< Карта взята из дебютной книги или таблицы карт
+        SURROGATE, ///< Карта предсказана моделью-заменителем
+        COUNT
+    };
+    
+    /**
+     * @brief Диагностика построения карты на последнем ходе
+     */
+    struct MoveStats {
+        int samples = 0;          ///< Принятых образцов
+        long long tries = 0;      ///< Попыток генератора
+        double acceptance = 0.0;  ///< Доля принятых образцов
+        double ms = 0.0;          ///< Время построения карты
+        StopReason stop = StopReason::QUOTA;
+    };
+private:
+    Sampler m_sampler = Sampler::TABLE;     ///< Текущий способ генерации
+    /// Быстрых попыток выбора позиции из списка до построения точного списка свободных
+    static constexpr int TABLE_QUICK_DRAWS = 8;
+    SamplerStats m_stats;                   ///< Счетчики генератора за все партии
+    
+    static constexpr double DEFAULT_STOP_Z = 2.5;  ///< Порог z-критерия ранней остановки (setStopping)
+    /// Минимум образцов до первой проверки сходимости
+    static constexpr int STOP_MIN_SAMPLES = 64;
+    /// Образцов (или неудачных попыток) между проверками сходимости и времени
+    static constexpr int STOP_CHECK_INTERVAL = 32;
+    double m_stopZ = 0.0;                   ///< Порог ранней остановки (0 - всегда m_samples образцов)
+    double m_moveBudgetMs = 0.0;            ///< Бюджет времени хода в мс (0 - без ограничения)
+    std::chrono::steady_clock::time_point m_deadline; ///< Момент окончания бюджета текущего хода
+    MoveStats m_lastMove;                   ///< Диагностика последнего построения карты
+    std::array<long long, static_cast<int>(StopReason::COUNT)> m_stopCounts{}; ///< Построений карты по причинам остановки
+    
+    static constexpr int DEFAULT_CHAIN_BURN_IN = 200;        ///< Шагов цепи до первой записи
+    static constexpr int DEFAULT_CHAIN_THINNING = 5;         ///< Шагов цепи между записями
+    static constexpr double DEFAULT_CHAIN_THRESHOLD = 0.1;   ///< Порог доли принятых образцов
+    bool m_chain = true;                    ///< Автопереход на цепь Маркова при низкой доле принятых образцов
+    int m_chainBurnIn = DEFAULT_CHAIN_BURN_IN;
+    int m_chainThinning = DEFAULT_CHAIN_THINNING;
+    double m_chainThreshold = DEFAULT_CHAIN_THRESHOLD;
+    double m_acceptance = 1.0;              ///< Доля принятых образцов на последнем ходе с выборкой
+    ChainStats m_chainStats;                ///< Счетчики цепи за все партии
+    
+    std::shared_ptr<OpeningBook> m_book;    ///< Дебютная книга (nullptr - без книги)
+    static std::shared_ptr<OpeningBook> s_defaultBook; ///< Книга для вновь создаваемых стратегий
+    std::shared_ptr<TranspositionTable> m_table; ///< Общая таблица карт (nullptr - без таблицы)
+    static std::shared_ptr<TranspositionTable> s_defaultTable; ///< Таблица для вновь создаваемых стратегий
+    uint64_t m_hash = 0;                    ///< Хеш Зобриста наблюдений текущей партии
+    std::shared_ptr<FleetCorpus> m_corpus;  ///< Корпус расстановок (nullptr - только генерация)
+    static std::shared_ptr<FleetCorpus> s_defaultCorpus; ///< Корпус для вновь создаваемых стратегий
+    std::shared_ptr<const SurrogateModel> m_surrogate; ///< Модель вместо выборки (nullptr - выборка)
+    /// Предел просмотра корпуса за ход (в долях требуемого числа расстановок)
+    static constexpr int LIBRARY_SCAN_FACTOR = 256;
+    /// Корпус не набрал выборку: наблюдения только копятся, поэтому до конца партии он не используется
+    bool m_libraryExhausted = false;
+    /// Пробных образцов для замера доли принятых перед запуском цепи
+    static constexpr int CHAIN_PROBE_DRAWS = 64;
+    /// Штраф за каждое непокрытое попадание: вес состояния exp(-CHAIN_BETA * k)
+    static constexpr double CHAIN_BETA = 2.0;
+    /// Предел шагов цепи (в долях burn-in + m_samples * thinning)
+    static constexpr int CHAIN_STEP_BUDGET_FACTOR = 4;
+    /// Пачек для оценки эффективного размера выборки методом групповых средних
+    static constexpr int CHAIN_ESS_BATCHES = 20;
+    
+    /**
+     * @brief Наблюдения, общие для всех образцов одного хода
+     */
+    struct SampleContext {
+        std::vector<int> ships;  ///< Длины оставшихся кораблей (по убыванию)
+        BitMask128 blocked;      ///< Клетки, где кораблей быть не может
+        BitMask128 hitsMask;     ///< Попадания по еще не потопленным кораблям
+        /// Допустимые позиции (индексы PlacementMasks::TABLE) по длинам, табличный режим
+        std::array<std::vector<uint16_t>, PlacementMasks::MAX_SHIP_LENGTH + 1> candidates;
+        std::vector<uint16_t> hitCandidates; ///< Позиции самого длинного корабля, покрывающие попадание
+        BitMask128 open;         ///< Клетки, из которых выбирается выстрел
+        uint8_t symmetry = 1;    ///< Симметрии поля, сохраняющие наблюдения (бит t - преобразование t)
+    };
+    
+    /**
+     * @brief Маски проверки расстановки корпуса на согласованность с полем
+     */
+    struct CorpusFilter {
+        BitMask128 forbidden; ///< Промахи и ореолы потопленных кораблей
+        BitMask128 required;  ///< Все попадания
+        BitMask128 wound;     ///< Необстрелянные соседи попаданий по раненым кораблям
+        bool needWound = false; ///< Есть раненые корабли: расстановка должна их достраивать
+        BitMask128 strip;     ///< Потопленные корабли: в карту попадают только оставшиеся
+    };
+    
+    /**
+     * @brief Результат генерации выборки одним рабочим потоком
+     */
+    struct SampleBatch {
+        std::array<int, BitMask128::CELLS> heat{}; ///< Локальная тепловая карта потока
+        std::vector<BitMask128> samples;          ///< Образцы (только для фильтра частиц)
+        int accepted = 0;                         ///< Сгенерировано образцов
+        bool timedOut = false;                    ///< Поток остановлен бюджетом времени
+        SamplerStats stats;                       ///< Счетчики генератора потока
+    };
     
     /**
      * @brief Вспомогательная структура для Монте-Карло симуляции расстановки
      */
     struct MCPlacement {
-        std::array<std::array<int, 10>, 10> occ{};  ///< 1 если занято
+        FleetMask fleet;  ///< Корпуса размещенных кораблей и их ореолы
     };
     
     /**
@@ -57,13 +286,13 @@ private:
      * @param len Длина корабля
      * @param hor Ориентация (true - горизонтальная, false - вертикальная)
      * @param p Текущая симуляция размещения
-     * @param board Реальное состояние игрового поля
-     * @param hits Список попаданий
+     * @param missMask Маска промахов на реальном поле
+     * @param hitsMask Маска попаданий по еще не потопленным кораблям
      * @return true, если размещение возможно
      */
     bool fits(int x, int y, int len, bool hor, 
-              const MCPlacement& p, const Board& board,
-              const std::vector<std::pair<int, int>>& hits) const;
+              const MCPlacement& p, const BitMask128& missMask,
+              const BitMask128& hitsMask) const;
     
     /**
      * @brief Размещает корабль на доске
@@ -77,12 +306,214 @@ private:
     void place(int x, int y, int len, bool hor, MCPlacement& p) const;
     
     /**
-     * @brief Получает список оставшихся кораблей
+     * @brief Собирает наблюдения хода для генератора расстановок
+     * 
+     * В табличном режиме также строит списки допустимых позиций для каждой
+     * оставшейся длины (с учетом промахов и потопленных кораблей с ореолами).
+     * 
+     * @param board Текущее состояние игрового поля
+     * @param ctx Контекст выборки (выход)
+     * @return false, если кораблей не осталось
+     */
+    bool prepareContext(const Board& board, SampleContext& ctx);
+    
+    /**
+     * @brief Одна попытка сгенерировать расстановку оставшихся кораблей
+     * 
+     * @param ctx Наблюдения текущего хода
+     * @param body Маска клеток сгенерированной расстановки (выход)
+     * @param randInt Источник случайных чисел: randInt(lo, hi) в [lo, hi]
+     * @param stats Счетчики генератора
+     * @param scratch Рабочий буфер позиций (табличный режим)
+     * @return true, если все корабли удалось расставить
+     */
+    template <typename RandInt>
+    bool sampleFleet(const SampleContext& ctx, BitMask128& body, RandInt&& randInt,
+                     SamplerStats& stats, std::vector<uint16_t>& scratch) const;
+    
+    /**
+     * @brief Количество рабочих потоков для выборки заданного размера
+     */
+    int workerCount(int count) const;
+    
+    /**
+     * @brief Генерирует выборку в нескольких потоках
+     * 
+     * Каждый поток получает собственный генератор, засеянный из глобального RNG
+     * и номера потока, и собственную тепловую карту. Квоты потоков фиксированы,
+     * поэтому результат детерминирован при заданном сиде и числе потоков.
+     * 
+     * @param count Требуемое число образцов
+     * @param maxFailures Предел неудачных попыток на всю выборку
+     * @param particles true - образцы для фильтра частиц (сохраняются и покрывают все попадания)
+     * @param ctx Наблюдения текущего хода
+     * @return Результаты потоков в порядке их номеров
+     */
+    std::vector<SampleBatch> sampleParallel(int count, int maxFailures, bool particles,
+                                            const SampleContext& ctx);
+    
+    /**
+     * @brief Добавляет образец в вероятностную доску (delta = +1) или убирает его (delta = -1)
+     */
+    void accumulate(const BitMask128& body, int delta);
+    
+    /**
+     * @brief Строит карту из m_samples новых образцов
+     * 
+     * @param ctx Наблюдения текущего хода
+     */
+    void sampleHeatmap(const SampleContext& ctx);
+    
+    /**
+     * @brief Карта из расстановок корпуса, согласованных с полем
+     * 
+     * Просматривает корпус со случайного места, но не больше LIBRARY_SCAN_FACTOR
+     * расстановок на требуемую. Если согласованных набралось меньше, карта
+     * не меняется, и корпус до конца партии не используется: доля согласованных
+     * расстановок с каждым выстрелом только падает, и генерация становится выгоднее.
+     * 
+     * @param board Текущее состояние игрового поля
+     * @return true, если карта построена
+     */
+    bool sampleLibrary(const Board& board);
+    
+    /**
+     * @brief Просматривает участок корпуса и копит согласованные расстановки
+     * 
+     * Маски проверяются блоками по 64 без ветвлений: результаты блока собираются
+     * в 64-битное слово, затем учитываются только его установленные биты.
+     * 
+     * @param begin Первая расстановка участка (с переходом через конец корпуса)
+     * @param length Длина участка
+     * @param quota Сколько расстановок нужно
+     * @param particles true - сохранять расстановки как частицы
+     * @param batch Результат (карта, частицы, счетчики)
+     */
+    static void scanCorpus(const FleetCorpus& corpus, const CorpusFilter& filter, size_t begin,
+                           size_t length, int quota, bool particles, SampleBatch& batch);
+    
+    /**
+     * @brief Дополняет новые частицы их образами при симметриях наблюдения
+     * 
+     * @param from Индекс первой новой частицы
+     * @param group Симметрии, сохраняющие наблюдения
+     */
+    void mirrorParticles(size_t from, uint8_t group);
+    
+    /**
+     * @brief Последовательный тест остановки выборки
+     * 
+     * Сравнивает две лучшие клетки из open: разность их индикаторов в одном
+     * образце принимает значения -1, 0, 1, и отрыв лидера считается установленным,
+     * если z = (a - b) / sqrt(a + b - (a - b)^2 / n) не меньше m_stopZ.
+     * 
+     * @param open Клетки, среди которых выбирается выстрел
+     * @param n Число образцов в prob_board
+     */
+    bool leaderSettled(const BitMask128& open, int n) const;
+    
+    /**
+     * @brief Истек ли бюджет времени текущего хода
+     */
+    bool pastDeadline() const {
+        return m_moveBudgetMs > 0.0 && std::chrono::steady_clock::now() >= m_deadline;
+    }
+    
+    /**
+     * @brief Дозаполняет набор частиц до m_samples образцов, согласованных с полем
+     * 
+     * @param ctx Наблюдения текущего хода
+     */
+    void refillParticles(const SampleContext& ctx);
+    
+    /**
+     * @brief Карта из дебютной книги для позиции без раненых кораблей
      * 
      * @param board Текущее состояние игрового поля
-     * @return Вектор длин оставшихся кораблей
+     * @param key Ключ позиции (выход; 0, если позиция не подходит для книги)
+     * @return true, если карта найдена в книге
+     */
+    bool lookupBook(const Board& board, uint64_t& key);
+    
+    /**
+     * @brief Часть ключа таблицы карт, зависящая от параметров построения карты
+     *
+     * Учитывает все настройки, меняющие карту: число образцов, сэмплер, точный
+     * перебор, цепь и ее параметры, симметрии, фильтр частиц, досрочную
+     * остановку и корпус расстановок.
+     */
+    uint64_t configKey() const;
+    
+    /**
+     * @brief Карта цепью Маркова перемещений кораблей (MCMC)
+     * 
+     * Сначала пробной выборкой заново измеряет долю принятых образцов; если она
+     * не ниже порога, возвращает false. Иначе из одной расстановки выполняет
+     * burn-in и записывает каждое thinning-е состояние, покрывающее все попадания.
+     * 
+     * @param ctx Наблюдения текущего хода
+     * @return true, если карта построена
+     */
+    bool sampleChain(const SampleContext& ctx);
+    
+    /**
+     * @brief Добавляет записи цепи в вероятностную доску
+     * 
+     * @param records Состояния цепи в порядке записи
+     * @return Оценка эффективного размера выборки (групповые средние по клеткам)
+     */
+    double accumulateChain(const std::vector<BitMask128>& records);
+    
+    /**
+     * @brief Точная карта полным перебором согласованных расстановок
+     * 
+     * Выполняется, если верхняя оценка числа расстановок (произведение размеров
+     * списков позиций) не превышает порога; перебор с возвратом по битовым маскам
+     * прерывается при исчерпании бюджета узлов.
+     * 
+     * @param ctx Наблюдения текущего хода
+     * @return true, если карта построена
+     */
+    bool enumerateLayouts(const SampleContext& ctx);
+    
+    /**
+     * @brief Карта режима добивания: точный перебор позиций раненого корабля
+     * 
+     * Перебираются все позиции, покрывающие все попадания; вес каждой -
+     * оценка числа расстановок остального флота, полученная выборкой.
+     * 
+     * @param ctx Наблюдения текущего хода
+     * @return true, если карта построена
+     */
+    bool enumerateTarget(const SampleContext& ctx);
+    
+    /**
+     * @brief Отбрасывает частицы, противоречащие результату выстрела
+     * 
+     * Промах отбрасывает образцы с кораблем в клетке, попадание - образцы с водой.
+     * 
+     * @param x X-координата выстрела
+     * @param y Y-координата выстрела
+     * @param hit true, если попадание
+     */
+    void filterParticles(int x, int y, bool hit);
+    
+    /**
+     * @brief Согласует частицы с потоплением корабля
+     * 
+     * Корабли не касаются друг друга, поэтому потопленный корабль - отдельная
+     * связная компонента маски. Частицы, где эта компонента совпадает с ним,
+     * сохраняются без его клеток (выборка для оставшегося флота), остальные
+     * отбрасываются.
+     * 
+     * @param ship Событие потопления
      */
-    std::vector<int> getRemainingShips(const Board& board) const;
+    void foldSunkShip(const SunkShip& ship);
+    
+    /**
+     * @brief Удаляет все частицы и обнуляет вероятностную доску
+     */
+    void clearParticles();
     
     /**
      * @brief Инициализирует вероятностную доску нулями
@@ -99,13 +530,6 @@ private:
      */
     void build_probability(const Board& board);
 
-    /**
-     * @brief Обновляет список попаданий
-     * 
-     * @param board Текущее состояние игрового поля
-     */
-    void updateHitsList(const Board& board);
-
     /**
      * @brief Добавляет клетки в очередь для режима добивания
      * 
@@ -126,9 +550,9 @@ private:
      * @brief Помечает клетки вокруг потопленного корабля как недоступные для выстрелов
      * Основан на правиле "no-touch" - корабли не могут касаться друг друга
      * 
-     * @param board Текущее состояние игрового поля
+     * @param ship Событие потопления
      */
-    void markSurroundingCellsAsUnavailable(const Board& board);
+    void markSurroundingCellsAsUnavailable(const SunkShip& ship);
 
 public:
     /**
@@ -137,7 +561,8 @@ public:
      * @param samples Количество симуляций для каждого хода (по умолчанию 1000)
      */
     explicit MonteCarloStrategy(int samples = 1000)
-        : m_samples(samples), m_rng(), m_targeting_mode(false), m_prob_board_valid(false) {
+        : m_samples(samples), m_rng(), m_targeting_mode(false), m_prob_board_valid(false),
+          m_book(s_defaultBook), m_table(s_defaultTable), m_corpus(s_defaultCorpus) {
         reset();
     }
 
@@ -148,7 +573,8 @@ public:
      * @param samples Количество симуляций для каждого хода (по умолчанию 1000)
      */
     explicit MonteCarloStrategy(RNG& rng, int samples = 1000) 
-        : m_samples(samples), m_rng(rng), m_targeting_mode(false), m_prob_board_valid(false) {
+        : m_samples(samples), m_rng(rng), m_targeting_mode(false), m_prob_board_valid(false),
+          m_book(s_defaultBook), m_table(s_defaultTable), m_corpus(s_defaultCorpus) {
         reset();
     }
 
@@ -189,4 +615,185 @@ public:
      * @return Строка с именем стратегии
      */
     std::string getName() const override;
+    
+    /**
+     * @brief Включает режим фильтра частиц
+     * 
+     * Выборка расстановок сохраняется между ходами: после выстрела отбрасываются
+     * только противоречащие ему образцы, а набор дозаполняется до m_samples.
+     * После потопления корабля из образцов вычитается потопленный корабль.
+     * 
+     * @param incremental true - инкрементальный режим, false - пересчет на каждом ходу
+     */
+    void setIncremental(bool incremental) { m_incremental = incremental; clearParticles(); }
+    
+    /**
+     * @brief Задает число потоков для построения тепловой карты
+     * 
+     * @param threads 1 - последовательно (по умолчанию), 0 - по числу ядер
+     */
+    void setThreads(int threads) { m_threads = threads < 0 ? 1 : threads; }
+    
+    /**
+     * @brief Задает способ генерации расстановок (по умолчанию табличный)
+     */
+    void setSampler(Sampler sampler) { m_sampler = sampler; }
+    
+    /**
+     * @brief Включает точный перебор для позднего этапа партии и добивания
+     * 
+     * @param exact true - гибридный режим (по умолчанию), false - только выборка
+     */
+    void setExact(bool exact) { m_exact = exact; }
+    
+    /**
+     * @brief Включает свертку выборки по симметриям наблюдения
+     * 
+     * Если наблюдения переходят в себя при части из 8 симметрий поля (пустое
+     * поле, выстрелы на диагонали или оси), генерируется доля выборки, обратная
+     * размеру группы, а карта дополняется симметричными образами образцов.
+     * 
+     * @param enabled true - свертка (по умолчанию), false - всегда m_samples образцов
+     */
+    void setSymmetry(bool enabled) { m_symmetry = enabled; }
+    
+    /**
+     * @brief Текущая тепловая карта (индекс y * 10 + x)
+     */
+    const std::array<int, BitMask128::CELLS>& getHeatmap() const { return prob_board; }
+    
+    /**
+     * @brief Настраивает переход на цепь Маркова для сильно ограниченных позиций
+     * 
+     * Если на прошлом ходе с выборкой доля принятых образцов оказалась ниже порога,
+     * карта строится цепью: начиная с одной расстановки, корабли по одному
+     * переносятся на другие допустимые позиции.
+     * 
+     * @param enabled true - автоматический переход (по умолчанию), false - только выборка
+     * @param burnIn Шагов цепи до первой записи состояния
+     * @param thinning Шагов цепи между записями
+     * @param threshold Порог доли принятых образцов
+     */
+    void setChain(bool enabled, int burnIn = DEFAULT_CHAIN_BURN_IN,
+                  int thinning = DEFAULT_CHAIN_THINNING, double threshold = DEFAULT_CHAIN_THRESHOLD) {
+        m_chain = enabled;
+        m_chainBurnIn = std::max(0, burnIn);
+        m_chainThinning = std::max(1, thinning);
+        m_chainThreshold = threshold;
+    }
+    
+    /**
+     * @brief Настраивает досрочную остановку выборки
+     * 
+     * Выборка прекращается, когда лучшая клетка карты статистически отделилась
+     * от второй (последовательный z-критерий), или по истечении бюджета времени
+     * хода. Бюджет не прерывает ход до первого принятого образца и не ограничивает
+     * точный перебор. Без бюджета результат при фиксированном сиде воспроизводим.
+     * По умолчанию остановка выключена: стратегия набирает m_samples образцов.
+     * 
+     * @param z Порог z-критерия (0 - всегда набирать m_samples образцов)
+     * @param budgetMs Бюджет времени хода в мс (0 - без ограничения)
+     */
+    void setStopping(double z = DEFAULT_STOP_Z, double budgetMs = 0.0) {
+        m_stopZ = std::max(0.0, z);
+        m_moveBudgetMs = std::max(0.0, budgetMs);
+    }
+    
+    /**
+     * @brief Диагностика последнего построения карты: образцы, попытки, время, причина остановки
+     */
+    const MoveStats& getLastMoveStats() const { return m_lastMove; }
+    
+    /**
+     * @brief Сколько раз построение карты закончилось по причине reason
+     */
+    long long getStopCount(StopReason reason) const { return m_stopCounts[static_cast<int>(reason)]; }
+    
+    /**
+     * @brief Назначает дебютную книгу
+     * 
+     * Пока позиция есть в книге, карта берется из нее; книга в режиме записи
+     * пополняется картами, посчитанными этой стратегией.
+     * 
+     * @param book Книга или nullptr, чтобы отключить
+     */
+    void setOpeningBook(std::shared_ptr<OpeningBook> book) { m_book = std::move(book); }
+    
+    /**
+     * @brief Задает книгу для всех создаваемых после этого стратегий
+     * 
+     * Так книга попадает в стратегии, которые создаются на каждую партию
+     * (ShooterPool, фитнес-функция trainPlacement).
+     */
+    static void setDefaultOpeningBook(std::shared_ptr<OpeningBook> book) { s_defaultBook = std::move(book); }
+    
+    /**
+     * @brief Назначает таблицу карт
+     * 
+     * Таблица может быть общей для стратегий в разных потоках: карта позиции,
+     * уже посчитанная любой из них с теми же параметрами, берется из таблицы.
+     * 
+     * @param table Таблица или nullptr, чтобы отключить
+     */
+    void setTranspositionTable(std::shared_ptr<TranspositionTable> table) { m_table = std::move(table); }
+    
+    /**
+     * @brief Задает таблицу карт для всех создаваемых после этого стратегий
+     */
+    static void setDefaultTranspositionTable(std::shared_ptr<TranspositionTable> table) { s_defaultTable = std::move(table); }
+    
+    /**
+     * @brief Назначает корпус расстановок (режим фильтра корпуса)
+     * 
+     * Пока согласованных с полем расстановок в корпусе достаточно, карта
+     * собирается из них вместо генерации; точный перебор сохраняет приоритет.
+     * 
+     * @param corpus Корпус или nullptr, чтобы отключить
+     */
+    void setFleetCorpus(std::shared_ptr<FleetCorpus> corpus) { m_corpus = std::move(corpus); }
+    
+    /**
+     * @brief Задает корпус для всех создаваемых после этого стратегий
+     */
+    static void setDefaultFleetCorpus(std::shared_ptr<FleetCorpus> corpus) { s_defaultCorpus = std::move(corpus); }
+    
+    /**
+     * @brief Назначает модель-заменитель выборки
+     * 
+     * Карта позиции, которой нет в дебютной книге, предсказывается моделью
+     * без генерации расстановок; добивание остается прежним.
+     * 
+     * @param surrogate Модель или nullptr, чтобы вернуть выборку
+     */
+    void setSurrogate(std::shared_ptr<const SurrogateModel> surrogate) { m_surrogate = std::move(surrogate); }
+    
+    /**
+     * @brief Счетчики цепи Маркова за все партии этой стратегии
+     */
+    const ChainStats& getChainStats() const { return m_chainStats; }
+    
+    /**
+     * @brief Сколько ходов карта строилась каждым способом
+     */
+    const HeatmapStats& getHeatmapStats() const { return m_heatStats; }
+    
+    /**
+     * @brief Счетчики генератора расстановок за все партии этой стратегии
+     */
+    const SamplerStats& getSamplerStats() const { return m_stats; }
+    
+    /**
+     * @brief Проверяет, включен ли режим фильтра частиц
+     */
+    bool isIncremental() const { return m_incremental; }
+    
+    /**
+     * @brief Сколько образцов сгенерировано за все партии этой стратегии
+     */
+    long long getSamplesDrawn() const { return m_samplesDrawn; }
+    
+    /**
+     * @brief Сколько образцов отброшено фильтром частиц за все партии
+     */
+    long long getSamplesDropped() const { return m_samplesDropped; }
 }; 
\ No newline at end of file
@@ -0,0 +1,146 @@
+#include "opening_book.h"
+#include "../models/heatmap.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+const char BOOK_MAGIC[4] = {'M', 'C', 'B', '1'};
+
+struct Header {
+    char magic[4];
+    uint32_t depth;
+    uint32_t samples;
+    uint32_t count;
+};
+
+// Перемешивание splitmix64
+uint64_t mix(uint64_t z) {
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+} // namespace
+
+OpeningBook::OpeningBook(int depth, int samples)
+    : m_depth(depth), m_samples(samples), m_recording(true) {}
+
+OpeningBook::~OpeningBook() {
+#ifndef _WIN32
+    if (m_map) {
+        munmap(m_map, m_mapSize);
+    }
+#endif
+}
+
+std::shared_ptr<OpeningBook> OpeningBook::load(const std::string& path) {
+    std::shared_ptr<OpeningBook> book(new OpeningBook());
+    Header header{};
+    const char* data = nullptr;
+    size_t size = 0;
+
+#ifndef _WIN32
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) return nullptr;
+    struct stat st{};
+    if (fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < sizeof(Header)) {
+        close(fd);
+        return nullptr;
+    }
+    size = static_cast<size_t>(st.st_size);
+    void* map = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) return nullptr;
+    book->m_map = map;
+    book->m_mapSize = size;
+    data = static_cast<const char*>(map);
+#else
+    // Без mmap записи читаются в память целиком
+    std::ifstream ifs(path, std::ios::binary);
+    if (!ifs) return nullptr;
+    std::vector<char> buffer((std::istreambuf_iterator<char>(ifs)), std::istreambuf_iterator<char>());
+    size = buffer.size();
+    if (size < sizeof(Header)) return nullptr;
+    data = buffer.data();
+#endif
+
+    std::memcpy(&header, data, sizeof(Header));
+    if (!std::equal(header.magic, header.magic + sizeof(BOOK_MAGIC), BOOK_MAGIC) ||
+        size != sizeof(Header) + static_cast<size_t>(header.count) * sizeof(Entry)) {
+        return nullptr; // Отображение освободит деструктор
+    }
+    book->m_depth = static_cast<int>(header.depth);
+    book->m_samples = static_cast<int>(header.samples);
+    book->m_count = header.count;
+#ifndef _WIN32
+    book->m_entries = reinterpret_cast<const Entry*>(data + sizeof(Header));
+#else
+    book->m_loaded.resize(header.count);
+    std::memcpy(book->m_loaded.data(), data + sizeof(Header), header.count * sizeof(Entry));
+    book->m_entries = book->m_loaded.data();
+#endif
+    return book;
+}
+
+void OpeningBook::save(const std::string& path, int minVisits) const {
+    std::vector<Entry> entries(m_entries, m_entries + m_count);
+    for (const auto& item : m_recorded) {
+        if (item.second.visits >= minVisits) {
+            entries.push_back(item.second.entry);
+        }
+    }
+    std::sort(entries.begin(), entries.end(),
+              [](const Entry& a, const Entry& b) { return a.key < b.key; });
+
+    std::ofstream ofs(path, std::ios::binary);
+    if (!ofs) throw std::runtime_error("Cannot open file for writing: " + path);
+
+    Header header{};
+    std::copy(BOOK_MAGIC, BOOK_MAGIC + sizeof(BOOK_MAGIC), header.magic);
+    header.depth = static_cast<uint32_t>(m_depth);
+    header.samples = static_cast<uint32_t>(m_samples);
+    header.count = static_cast<uint32_t>(entries.size());
+    ofs.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    ofs.write(reinterpret_cast<const char*>(entries.data()),
+              static_cast<std::streamsize>(entries.size() * sizeof(Entry)));
+    if (!ofs) throw std::runtime_error("Failed to write opening book: " + path);
+}
+
+uint64_t OpeningBook::key(const BitMask128& shots, const BitMask128& sunk) {
+    uint64_t h = mix(shots.lo ^ 0x9E3779B97F4A7C15ULL);
+    h = mix(h ^ shots.hi);
+    h = mix(h ^ sunk.lo);
+    return mix(h ^ sunk.hi);
+}
+
+const OpeningBook::Entry* OpeningBook::find(uint64_t key) const {
+    if (m_recording) {
+        auto it = m_recorded.find(key);
+        if (it == m_recorded.end()) return nullptr;
+        ++it->second.visits;
+        return &it->second.entry;
+    }
+    const Entry* end = m_entries + m_count;
+    const Entry* it = std::lower_bound(m_entries, end, key,
+                                       [](const Entry& e, uint64_t k) { return e.key < k; });
+    return (it != end && it->key == key) ? it : nullptr;
+}
+
+void OpeningBook::record(uint64_t key, const std::array<int, BitMask128::CELLS>& heat) {
+    if (!m_recording) return;
+    Recorded& slot = m_recorded[key];
+    slot.entry.key = key;
+    HeatmapOps::quantize(heat, slot.entry.heat);
+    ++slot.visits;
+}
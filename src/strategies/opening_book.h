@@ -0,0 +1,121 @@
+#pragma once
+
+#include "../models/bitboard.h"
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @class OpeningBook
+ * @brief Дебютная книга стратегии Монте-Карло: тепловые карты ранних позиций.
+ *
+ * Пока на поле нет раненых кораблей, карта Монте-Карло зависит только от
+ * обстрелянных клеток и потопленных кораблей. Книга хранит для таких позиций
+ * (не больше depth выстрелов) карты, посчитанные на большой выборке; ключ
+ * записи - 64-битный хеш наблюдения. Файл книги отображается в память
+ * (mmap), записи отсортированы по ключу, поиск - двоичный.
+ *
+ * Формат файла (порядок байт машины): сигнатура "MCB1", uint32 depth,
+ * uint32 samples, uint32 count, затем count записей Entry.
+ *
+ * Книга в режиме записи (конструктор с параметрами) копит карты в памяти:
+ * стратегия, которой она назначена, сохраняет в нее каждую посчитанную
+ * карту подходящей позиции. Режим записи рассчитан на один поток.
+ */
+class OpeningBook {
+public:
+    static constexpr int DEFAULT_DEPTH = 10;          ///< Глубина книги (выстрелов)
+    static constexpr int DEFAULT_SAMPLES = 200000;    ///< Образцов на карту при построении
+    static constexpr int DEFAULT_GAMES = 200;         ///< Партий при построении
+    static constexpr const char* DEFAULT_PATH = "mc_opening.book"; ///< Файл книги по умолчанию
+
+    /**
+     * @brief Запись книги: ключ позиции и карта, нормированная к максимуму 65535
+     */
+    struct Entry {
+        uint64_t key;
+        std::array<uint16_t, BitMask128::CELLS> heat;
+    };
+
+    /**
+     * @brief Создает пустую книгу в режиме записи
+     *
+     * @param depth Наибольшее число выстрелов в позициях книги
+     * @param samples Образцов на карту (для заголовка файла)
+     */
+    OpeningBook(int depth, int samples);
+    ~OpeningBook();
+
+    OpeningBook(const OpeningBook&) = delete;
+    OpeningBook& operator=(const OpeningBook&) = delete;
+
+    /**
+     * @brief Загружает книгу из файла
+     * @return Книга или nullptr, если файла нет или он поврежден
+     */
+    static std::shared_ptr<OpeningBook> load(const std::string& path);
+
+    /**
+     * @brief Сохраняет книгу в файл
+     *
+     * @param path Путь к файлу
+     * @param minVisits Записываются позиции, встреченные не реже minVisits раз
+     *                  (для загруженных записей число посещений не ведется)
+     */
+    void save(const std::string& path, int minVisits = 1) const;
+
+    /**
+     * @brief Ключ позиции без раненых кораблей
+     *
+     * @param shots Обстрелянные клетки
+     * @param sunk Клетки потопленных кораблей
+     */
+    static uint64_t key(const BitMask128& shots, const BitMask128& sunk);
+
+    /**
+     * @brief Запись для позиции или nullptr
+     */
+    const Entry* find(uint64_t key) const;
+
+    /**
+     * @brief Добавляет карту позиции (только в режиме записи)
+     */
+    void record(uint64_t key, const std::array<int, BitMask128::CELLS>& heat);
+
+    bool isRecording() const { return m_recording; }
+    int depth() const { return m_depth; }
+    int samples() const { return m_samples; }
+
+    /**
+     * @brief Количество позиций в книге
+     */
+    size_t size() const { return m_count + m_recorded.size(); }
+
+    /**
+     * @brief Объем записей в байтах
+     */
+    size_t bytes() const { return size() * sizeof(Entry); }
+
+private:
+    OpeningBook() = default;
+
+    int m_depth = DEFAULT_DEPTH;
+    int m_samples = 0;
+    bool m_recording = false;
+
+    const Entry* m_entries = nullptr; ///< Отсортированные записи (отображение файла или m_loaded)
+    size_t m_count = 0;
+    void* m_map = nullptr;            ///< Отображение файла в память
+    size_t m_mapSize = 0;
+    std::vector<Entry> m_loaded;      ///< Записи, прочитанные без mmap
+
+    /// Карты, посчитанные в режиме записи, и число посещений позиций
+    struct Recorded {
+        Entry entry;
+        int visits = 0;
+    };
+    mutable std::unordered_map<uint64_t, Recorded> m_recorded;
+};
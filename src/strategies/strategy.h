@@ -33,7 +33,8 @@ public:
      * @param y Y-координата выстрела
      * @param hit true, если попадание, false, если промах
      * @param sunk true, если корабль потоплен, false иначе
-     * @param board Текущее состояние игрового поля (для более эффективного добивания)
+     * @param board Текущее состояние игрового поля (для более эффективного добивания);
+     *              при sunk == true board.lastSunk() содержит клетки, длину и ореол корабля
      */
     virtual void notifyShotResult(int x, int y, bool hit, bool sunk, const Board& board) = 0;
     
@@ -0,0 +1,322 @@
+#include "surrogate_model.h"
+#include "../models/heatmap.h"
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <stdexcept>
+
+namespace {
+
+const char SURROGATE_MAGIC[] = "MCS1";
+constexpr int MAX_LEN = PlacementMasks::MAX_SHIP_LENGTH;
+
+BitMask128 rowMask(int y) {
+    BitMask128 m;
+    for (int x = 0; x < BitMask128::SIDE; ++x) {
+        m.set(BitMask128::index(x, y));
+    }
+    return m;
+}
+
+// Клетки, у которых сосед со смещением (dx, dy) входит в mask
+// (при outsideClosed сосед за краем поля тоже считается входящим)
+BitMask128 neighborIn(const BitMask128& mask, int dx, int dy, bool outsideClosed) {
+    const int shift = dx + dy * BitMask128::SIDE;
+    const BitMask128 moved = shift > 0 ? mask.shiftRight(shift) : mask.shiftLeft(-shift);
+    BitMask128 border;
+    if (dx > 0) border |= BitMask128::column(BitMask128::SIDE - 1);
+    if (dx < 0) border |= BitMask128::column(0);
+    if (dy > 0) border |= rowMask(BitMask128::SIDE - 1);
+    if (dy < 0) border |= rowMask(0);
+    return (moved & ~border) | (outsideClosed ? border : BitMask128());
+}
+
+} // namespace
+
+SurrogateModel::Observation SurrogateModel::Observation::from(const Board& board, const RemainingFleet& fleet) {
+    Observation obs;
+    obs.shots = board.shotMask();
+    obs.hits = board.hitMask();
+    obs.sunk = board.sunkMask();
+    for (int len : fleet.lengths()) {
+        if (len >= 1 && len <= MAX_LEN) ++obs.ships[len];
+    }
+    return obs;
+}
+
+SurrogateModel::SurrogateModel() {
+    for (int f = COVER_1; f <= WOUND_4; ++f) {
+        m_weights[f] = 1.0;
+    }
+}
+
+BitMask128 SurrogateModel::features(const Observation& obs, FeatureMatrix& out) {
+    const BitMask128 misses = obs.shots & ~obs.hits;
+    const BitMask128 wounded = obs.hits & ~obs.sunk;
+    const BitMask128 blocked = misses | obs.sunk.dilate();
+    // Остальные корабли не касаются раненого
+    const BitMask128 nearWound = wounded.dilate();
+    const BitMask128 open = obs.open();
+
+    // Число допустимых позиций каждой длины через каждую клетку
+    std::array<std::array<int, BitMask128::CELLS>, MAX_LEN + 1> cover{};
+    std::array<std::array<int, BitMask128::CELLS>, MAX_LEN + 1> wound{};
+    std::array<int, MAX_LEN + 1> coverTotal{};
+    std::array<int, MAX_LEN + 1> woundTotal{};
+
+    // Позиции, не касающиеся раненого: начала свободных отрезков находятся
+    // сдвигами маски, покрытие клеток суммируется побитово-срезанным счетчиком
+    const BitMask128 free = ~blocked & ~nearWound;
+    BitSlicedCounter counter;
+    for (int len = 1; len <= MAX_LEN; ++len) {
+        if (obs.ships[len] == 0) continue;
+        BitMask128 startsH = free, startsV = free;
+        BitMask128 shiftedH = free, shiftedV = free;
+        for (int k = 1; k < len; ++k) {
+            shiftedH = (shiftedH & ~BitMask128::column(0)).shiftRight(1);
+            shiftedV = shiftedV.shiftRight(BitMask128::SIDE);
+            startsH &= shiftedH;
+            startsV &= shiftedV;
+        }
+        counter.clear();
+        for (int k = 0; k < len; ++k) {
+            counter.add(startsH.shiftLeft(k));
+            // Однопалубник в обеих ориентациях - одна и та же позиция
+            if (len > 1) counter.add(startsV.shiftLeft(k * BitMask128::SIDE));
+        }
+        counter.addTo(cover[len]);
+        coverTotal[len] = startsH.count() + (len > 1 ? startsV.count() : 0);
+    }
+
+    // Позиции раненого корабля накрывают его попадания целиком (нужны только при добивании)
+    if (wounded.any()) {
+        for (int len = 1; len <= MAX_LEN; ++len) {
+            if (obs.ships[len] == 0) continue;
+            for (int hor = 0; hor <= (len > 1 ? 1 : 0); ++hor) {
+                for (int idx = 0; idx < BitMask128::CELLS; ++idx) {
+                    const PlacementMask& pm = PlacementMasks::TABLE[PlacementMasks::slot(
+                        idx % BitMask128::SIDE, idx / BitMask128::SIDE, len, hor == 1)];
+                    if (!pm.legal || (pm.body & blocked).any()) continue;
+                    if ((pm.body & wounded).none() || (pm.halo & wounded).any()) continue;
+                    ++woundTotal[len];
+                    for (BitMask128 body = pm.body; body.any(); ) {
+                        ++wound[len][body.popLowest()];
+                    }
+                }
+            }
+        }
+    }
+
+    // Длина раненого корабля: пропорционально числу его позиций и кораблей этой длины
+    double woundWeight = 0.0;
+    for (int len = 1; len <= MAX_LEN; ++len) {
+        woundWeight += static_cast<double>(obs.ships[len]) * woundTotal[len];
+    }
+    std::array<float, MAX_LEN + 1> coverScale{}, woundScale{};
+    for (int len = 1; len <= MAX_LEN; ++len) {
+        if (coverTotal[len] > 0) {
+            coverScale[len] = static_cast<float>(static_cast<double>(obs.ships[len]) / coverTotal[len]);
+        }
+        if (woundWeight > 0.0) {
+            woundScale[len] = static_cast<float>(obs.ships[len] / woundWeight);
+        }
+    }
+
+    // Закрытые соседи (промах, ореол, край поля) и соседство с раненым - сдвигами масок
+    BitSlicedCounter sideCounter, diagCounter;
+    BitMask128 hitAdjacent;
+    for (int d = -1; d <= 1; d += 2) {
+        sideCounter.add(neighborIn(blocked, d, 0, true));
+        sideCounter.add(neighborIn(blocked, 0, d, true));
+        diagCounter.add(neighborIn(blocked, d, -1, true));
+        diagCounter.add(neighborIn(blocked, d, 1, true));
+        hitAdjacent |= neighborIn(wounded, d, 0, false) | neighborIn(wounded, 0, d, false);
+    }
+    std::array<int, BitMask128::CELLS> side{}, diag{};
+    sideCounter.addTo(side);
+    diagCounter.addTo(diag);
+    const BitMask128 edgeX = BitMask128::column(0) | BitMask128::column(BitMask128::SIDE - 1);
+    const BitMask128 edgeY = rowMask(0) | rowMask(BitMask128::SIDE - 1);
+
+    for (std::array<float, FEATURE_COUNT>& row : out) {
+        row.fill(0.0f);
+    }
+    for (BitMask128 cells = open; cells.any(); ) {
+        const int idx = cells.popLowest();
+        std::array<float, FEATURE_COUNT>& row = out[idx];
+        row[BIAS] = 1.0f;
+        for (int len = 1; len <= MAX_LEN; ++len) {
+            row[COVER_1 + len - 1] = coverScale[len] * cover[len][idx];
+            row[WOUND_1 + len - 1] = woundScale[len] * wound[len][idx];
+        }
+        row[EDGE] = (edgeX.test(idx) || edgeY.test(idx)) ? 1.0f : 0.0f;
+        row[CORNER] = (edgeX.test(idx) && edgeY.test(idx)) ? 1.0f : 0.0f;
+        row[SIDE_BLOCKED] = side[idx] / 4.0f;
+        row[DIAG_BLOCKED] = diag[idx] / 4.0f;
+        row[HIT_ADJACENT] = hitAdjacent.test(idx) ? 1.0f : 0.0f;
+    }
+    return open;
+}
+
+void SurrogateModel::heatmap(const Observation& obs, std::array<int, BitMask128::CELLS>& heat) const {
+    FeatureMatrix rows;
+    const BitMask128 open = features(obs, rows);
+
+    std::array<float, FEATURE_COUNT> weights;
+    for (int f = 0; f < FEATURE_COUNT; ++f) {
+        weights[f] = static_cast<float>(m_weights[f]);
+    }
+    // Строки закрытых клеток нулевые, поэтому цикл идет по всем клеткам без ветвлений
+    std::array<float, BitMask128::CELLS> score;
+    float maxScore = 0.0f;
+    for (int idx = 0; idx < BitMask128::CELLS; ++idx) {
+        float s = 0.0f;
+        for (int f = 0; f < FEATURE_COUNT; ++f) {
+            s += weights[f] * rows[idx][f];
+        }
+        score[idx] = std::max(s, 0.0f);
+        maxScore = std::max(maxScore, score[idx]);
+    }
+
+    // Отрицательные оценки обнуляются: maskedArgmax ожидает неотрицательную карту
+    const float scale = maxScore > 0.0f ? 65535.0f / maxScore : 0.0f;
+    for (int idx = 0; idx < BitMask128::CELLS; ++idx) {
+        if (!open.test(idx)) {
+            heat[idx] = 0;
+        } else if (maxScore > 0.0f) {
+            heat[idx] = static_cast<int>(score[idx] * scale + 0.5f);
+        } else {
+            heat[idx] = 1;
+        }
+    }
+}
+
+SurrogateModel SurrogateModel::fit(const std::vector<Sample>& samples, double ridge) {
+    // Нормальные уравнения по открытым клеткам всех позиций. Регуляризация тянет
+    // веса к модели без обучения: (X^T X + lambda I) d = X^T (y - X w0), w = w0 + d,
+    // так признаки, не встретившиеся в обучении (например, WOUND при добивании
+    // без карт), сохраняют исходный вес
+    std::array<std::array<double, FEATURE_COUNT>, FEATURE_COUNT> xtx{};
+    std::array<double, FEATURE_COUNT> xty{};
+    FeatureMatrix rows;
+    for (const Sample& sample : samples) {
+        const BitMask128 open = features(sample.obs, rows);
+        double heatSum = 0.0;
+        for (BitMask128 cells = open; cells.any(); ) {
+            heatSum += sample.heat[cells.popLowest()];
+        }
+        if (heatSum <= 0.0) continue;
+
+        int decks = 0;
+        for (int len = 1; len <= MAX_LEN; ++len) {
+            decks += sample.obs.ships[len] * len;
+        }
+        decks -= (sample.obs.hits & ~sample.obs.sunk).count();
+        const double scale = std::max(decks, 1) / heatSum;
+
+        for (BitMask128 cells = open; cells.any(); ) {
+            const int idx = cells.popLowest();
+            const double target = sample.heat[idx] * scale;
+            for (int i = 0; i < FEATURE_COUNT; ++i) {
+                const double xi = rows[idx][i];
+                if (xi == 0.0) continue;
+                xty[i] += xi * target;
+                for (int j = 0; j < FEATURE_COUNT; ++j) {
+                    xtx[i][j] += xi * rows[idx][j];
+                }
+            }
+        }
+    }
+
+    const SurrogateModel prior;
+    for (int i = 0; i < FEATURE_COUNT; ++i) {
+        for (int j = 0; j < FEATURE_COUNT; ++j) {
+            xty[i] -= xtx[i][j] * prior.m_weights[j];
+        }
+    }
+
+    double trace = 0.0;
+    for (int i = 0; i < FEATURE_COUNT; ++i) trace += xtx[i][i];
+    const double lambda = ridge * std::max(trace / FEATURE_COUNT, 1e-12);
+    for (int i = 0; i < FEATURE_COUNT; ++i) xtx[i][i] += lambda;
+
+    // Метод Гаусса с выбором ведущего элемента
+    std::array<double, FEATURE_COUNT> w = xty;
+    for (int col = 0; col < FEATURE_COUNT; ++col) {
+        int pivot = col;
+        for (int row = col + 1; row < FEATURE_COUNT; ++row) {
+            if (std::fabs(xtx[row][col]) > std::fabs(xtx[pivot][col])) pivot = row;
+        }
+        if (std::fabs(xtx[pivot][col]) < 1e-12) continue; // Признак ни разу не встретился
+        std::swap(xtx[col], xtx[pivot]);
+        std::swap(w[col], w[pivot]);
+        for (int row = 0; row < FEATURE_COUNT; ++row) {
+            if (row == col) continue;
+            const double factor = xtx[row][col] / xtx[col][col];
+            if (factor == 0.0) continue;
+            for (int k = col; k < FEATURE_COUNT; ++k) {
+                xtx[row][k] -= factor * xtx[col][k];
+            }
+            w[row] -= factor * w[col];
+        }
+    }
+    for (int i = 0; i < FEATURE_COUNT; ++i) {
+        w[i] = prior.m_weights[i] + (std::fabs(xtx[i][i]) < 1e-12 ? 0.0 : w[i] / xtx[i][i]);
+    }
+    return SurrogateModel(w);
+}
+
+SurrogateModel::Agreement SurrogateModel::agreement(const std::vector<Sample>& samples) const {
+    Agreement result;
+    std::array<int, BitMask128::CELLS> heat;
+    for (const Sample& sample : samples) {
+        const BitMask128 open = sample.obs.open();
+        int mcBest = 0;
+        for (BitMask128 cells = open; cells.any(); ) {
+            mcBest = std::max(mcBest, sample.heat[cells.popLowest()]);
+        }
+        if (mcBest <= 0) continue;
+
+        heatmap(sample.obs, heat);
+        int pick = -1;
+        for (BitMask128 cells = open; cells.any(); ) {
+            const int idx = cells.popLowest();
+            if (pick < 0 || heat[idx] > heat[pick]) pick = idx;
+        }
+        ++result.states;
+        // Равные по карте МК клетки считаются совпадением
+        if (sample.heat[pick] >= mcBest) result.top1 += 1.0;
+        result.heatRatio += static_cast<double>(sample.heat[pick]) / mcBest;
+    }
+    if (result.states > 0) {
+        result.top1 /= result.states;
+        result.heatRatio /= result.states;
+    }
+    return result;
+}
+
+std::shared_ptr<SurrogateModel> SurrogateModel::load(const std::string& path) {
+    std::ifstream in(path);
+    if (!in) return nullptr;
+    std::string magic;
+    int count = 0;
+    if (!(in >> magic >> count) || magic != SURROGATE_MAGIC || count != FEATURE_COUNT) {
+        return nullptr;
+    }
+    std::array<double, FEATURE_COUNT> weights{};
+    for (double& w : weights) {
+        if (!(in >> w)) return nullptr;
+    }
+    return std::make_shared<SurrogateModel>(weights);
+}
+
+void SurrogateModel::save(const std::string& path) const {
+    std::ofstream out(path);
+    if (!out) throw std::runtime_error("Cannot open file for writing: " + path);
+    out.precision(17);
+    out << SURROGATE_MAGIC << " " << FEATURE_COUNT << "\n";
+    for (int f = 0; f < FEATURE_COUNT; ++f) {
+        out << m_weights[f] << (f + 1 < FEATURE_COUNT ? " " : "\n");
+    }
+    if (!out) throw std::runtime_error("Failed to write surrogate model: " + path);
+}
@@ -0,0 +1,139 @@
+#pragma once
+
+#include "../models/board.h"
+#include "../models/placement_masks.h"
+#include "../models/remaining_fleet.h"
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+/**
+ * @class SurrogateModel
+ * @brief Дешевая линейная модель, заменяющая карту Монте-Карло.
+ *
+ * Для каждой клетки считаются признаки локального узора: доля допустимых
+ * позиций каждой длины, проходящих через клетку (отдельно для кораблей,
+ * которые должны накрыть раненый корабль), положение у края и состояние
+ * соседних клеток. Оценка клетки - взвешенная сумма признаков. Веса
+ * подбираются методом наименьших квадратов (с гребневой регуляризацией) по
+ * парам "наблюдение - карта" из настоящих партий MonteCarloStrategy.
+ *
+ * Формат файла (текст): сигнатура "MCS1", число признаков, затем веса.
+ */
+class SurrogateModel {
+public:
+    /// Признаки клетки
+    enum Feature {
+        BIAS,          ///< Константа
+        COVER_1,       ///< Ожидаемое число кораблей длины 1..4, накрывающих клетку
+        COVER_2,
+        COVER_3,
+        COVER_4,
+        WOUND_1,       ///< Вероятность, что раненый корабль длины 1..4 накрывает клетку
+        WOUND_2,
+        WOUND_3,
+        WOUND_4,
+        EDGE,          ///< Клетка на краю поля
+        CORNER,        ///< Угловая клетка
+        SIDE_BLOCKED,  ///< Доля закрытых соседей по стороне (промах, ореол, край поля)
+        DIAG_BLOCKED,  ///< Доля закрытых соседей по диагонали
+        HIT_ADJACENT,  ///< Соседство по стороне с раненым кораблем
+        FEATURE_COUNT
+    };
+
+    static constexpr const char* DEFAULT_PATH = "mc_surrogate.model"; ///< Файл модели по умолчанию
+    static constexpr double DEFAULT_RIDGE = 1e-3;                      ///< Регуляризация (доля среднего диагонального элемента)
+    static constexpr int DEFAULT_GAMES = 200;                          ///< Партий МК для обучения
+    static constexpr int DEFAULT_SAMPLES = 1000;                       ///< Образцов на карту у обучающей стратегии
+
+    /**
+     * @brief Наблюдения стреляющего: обстрелянные клетки и оставшийся флот
+     */
+    struct Observation {
+        BitMask128 shots; ///< Обстрелянные клетки
+        BitMask128 hits;  ///< Попадания (включая потопленные корабли)
+        BitMask128 sunk;  ///< Клетки потопленных кораблей
+        std::array<uint8_t, PlacementMasks::MAX_SHIP_LENGTH + 1> ships{}; ///< Непотопленных кораблей по длинам
+
+        static Observation from(const Board& board, const RemainingFleet& fleet);
+
+        /**
+         * @brief Клетки, куда имеет смысл стрелять (не обстреляны и не в ореоле потопленных)
+         */
+        BitMask128 open() const { return ~shots & ~sunk.dilate(); }
+    };
+
+    /**
+     * @brief Обучающая пара: наблюдение и карта настоящей стратегии Монте-Карло
+     */
+    struct Sample {
+        Observation obs;
+        std::array<int, BitMask128::CELLS> heat{};
+    };
+
+    /**
+     * @brief Совпадение выбора модели с выбором Монте-Карло
+     */
+    struct Agreement {
+        size_t states = 0;      ///< Число позиций
+        double top1 = 0.0;      ///< Доля позиций, где выбрана лучшая клетка карты МК
+        double heatRatio = 0.0; ///< Средняя доля максимума карты МК в выбранной клетке
+    };
+
+    using FeatureMatrix = std::array<std::array<float, FEATURE_COUNT>, BitMask128::CELLS>;
+
+    /**
+     * @brief Модель без обучения: сумма признаков COVER и WOUND (эвристика плотности позиций)
+     */
+    SurrogateModel();
+
+    explicit SurrogateModel(const std::array<double, FEATURE_COUNT>& weights) : m_weights(weights) {}
+
+    /**
+     * @brief Признаки всех клеток
+     *
+     * @param obs Наблюдения
+     * @param out Признаки (строки закрытых клеток обнуляются)
+     * @return Маска клеток, для которых посчитаны признаки (Observation::open)
+     */
+    static BitMask128 features(const Observation& obs, FeatureMatrix& out);
+
+    /**
+     * @brief Карта оценок, нормированная к максимуму 65535 (закрытые клетки - 0)
+     */
+    void heatmap(const Observation& obs, std::array<int, BitMask128::CELLS>& heat) const;
+
+    /**
+     * @brief Подбирает веса по обучающим парам
+     *
+     * Цель для клетки - доля карты МК, умноженная на число неподбитых палуб,
+     * то есть оценка вероятности, что в клетке корабль.
+     *
+     * @param samples Обучающие пары
+     * @param ridge Регуляризация (стягивает веса к модели без обучения)
+     */
+    static SurrogateModel fit(const std::vector<Sample>& samples, double ridge = DEFAULT_RIDGE);
+
+    /**
+     * @brief Сравнивает выбор модели с картами МК
+     */
+    Agreement agreement(const std::vector<Sample>& samples) const;
+
+    /**
+     * @brief Загружает модель из файла
+     * @return Модель или nullptr, если файла нет или он поврежден
+     */
+    static std::shared_ptr<SurrogateModel> load(const std::string& path);
+
+    /**
+     * @brief Сохраняет модель в файл
+     */
+    void save(const std::string& path) const;
+
+    const std::array<double, FEATURE_COUNT>& weights() const { return m_weights; }
+
+private:
+    std::array<double, FEATURE_COUNT> m_weights{};
+};
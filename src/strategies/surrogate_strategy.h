@@ -0,0 +1,45 @@
+#pragma once
+
+#include "monte_carlo_strategy.h"
+#include "surrogate_model.h"
+#include <memory>
+#include <string>
+
+/**
+ * @brief Быстрый заменитель стратегии Монте-Карло
+ *
+ * Играет как MonteCarloStrategy (то же добивание, та же дебютная книга),
+ * но карту вне книги предсказывает обученная SurrogateModel вместо выборки
+ * расстановок. Предназначен для отбора расстановок при обучении; итоговые
+ * кандидаты проверяются настоящей стратегией Монте-Карло.
+ */
+class SurrogateStrategy : public MonteCarloStrategy {
+public:
+    /**
+     * @brief Конструктор заменителя
+     *
+     * @param model Обученная модель (nullptr - модель без обучения)
+     */
+    explicit SurrogateStrategy(std::shared_ptr<const SurrogateModel> model)
+        : MonteCarloStrategy(0) {
+        setSurrogate(model ? std::move(model) : std::make_shared<SurrogateModel>());
+    }
+
+    /**
+     * @brief Конструктор с передачей генератора случайных чисел
+     *
+     * @param rng Генератор случайных чисел
+     * @param model Обученная модель (nullptr - модель без обучения)
+     */
+    SurrogateStrategy(RNG& rng, std::shared_ptr<const SurrogateModel> model)
+        : MonteCarloStrategy(rng, 0) {
+        setSurrogate(model ? std::move(model) : std::make_shared<SurrogateModel>());
+    }
+
+    /**
+     * @brief Получает имя стратегии
+     *
+     * @return Строка с именем стратегии
+     */
+    std::string getName() const override { return "Monte-Carlo-Surrogate"; }
+};
@@ -0,0 +1,78 @@
+#include "transposition_table.h"
+#include "../models/heatmap.h"
+#include <iomanip>
+#include <sstream>
+
+TranspositionTable::TranspositionTable(size_t maxBytes) {
+    // Число корзин - наибольшая степень двойки, помещающаяся в заданный объем
+    size_t sets = 1;
+    while (sets * 2 * WAYS * sizeof(Entry) <= maxBytes) {
+        sets *= 2;
+    }
+    m_entries.resize(sets * WAYS);
+    m_setMask = sets - 1;
+}
+
+bool TranspositionTable::probe(uint64_t key, std::array<int, BitMask128::CELLS>& heat) const {
+    m_probes.fetch_add(1, std::memory_order_relaxed);
+    const size_t set = static_cast<size_t>(key) & m_setMask;
+    std::lock_guard<std::mutex> lock(lockFor(set));
+    for (int way = 0; way < WAYS; ++way) {
+        const Entry& entry = m_entries[set * WAYS + way];
+        if (entry.used && entry.key == key) {
+            for (int idx = 0; idx < BitMask128::CELLS; ++idx) {
+                heat[idx] = entry.heat[idx];
+            }
+            m_hits.fetch_add(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+    return false;
+}
+
+void TranspositionTable::store(uint64_t key, int depth, const std::array<int, BitMask128::CELLS>& heat) {
+    const size_t set = static_cast<size_t>(key) & m_setMask;
+    std::lock_guard<std::mutex> lock(lockFor(set));
+    Entry* target = nullptr;
+    for (int way = 0; way < WAYS; ++way) {
+        Entry& entry = m_entries[set * WAYS + way];
+        if (entry.used && entry.key == key) return; // Позицию уже сохранил другой поток
+        if (!entry.used) {
+            if (!target || target->used) target = &entry;
+        } else if (!target || (target->used && entry.depth > target->depth)) {
+            target = &entry;
+        }
+    }
+    // Ранние позиции полезнее: более глубокая новая позиция их не вытесняет
+    if (target->used && target->depth < depth) return;
+    if (!target->used) m_used.fetch_add(1, std::memory_order_relaxed);
+
+    target->key = key;
+    target->depth = static_cast<uint16_t>(depth);
+    target->used = true;
+    HeatmapOps::quantize(heat, target->heat);
+    m_stores.fetch_add(1, std::memory_order_relaxed);
+}
+
+void TranspositionTable::clear() {
+    for (size_t set = 0; set <= m_setMask; ++set) {
+        std::lock_guard<std::mutex> lock(lockFor(set));
+        for (int way = 0; way < WAYS; ++way) {
+            m_entries[set * WAYS + way] = Entry();
+        }
+    }
+    m_probes = 0;
+    m_hits = 0;
+    m_stores = 0;
+    m_used = 0;
+}
+
+std::string TranspositionTable::report() const {
+    const uint64_t total = probes();
+    std::ostringstream out;
+    out << std::fixed << std::setprecision(1)
+        << "Таблица карт МК: обращений " << total << ", попаданий " << hits()
+        << " (" << (total ? 100.0 * hits() / total : 0.0) << "%), записей " << used()
+        << " из " << capacity() << ", " << (bytes() >> 10) << " КБ";
+    return out.str();
+}
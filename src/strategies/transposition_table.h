@@ -0,0 +1,131 @@
+#pragma once
+
+#include "../models/bitboard.h"
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Хеш Зобриста наблюдений на поле противника.
+ *
+ * Каждой паре (состояние клетки, клетка) сопоставлено случайное 64-битное
+ * число; хеш позиции - XOR чисел всех обстрелянных клеток. Выстрел меняет
+ * хеш одной операцией XOR, потопление - по две на клетку корабля (HIT -> SUNK).
+ */
+namespace ObservationHash {
+
+enum Kind { MISS = 0, HIT = 1, SUNK = 2, KINDS = 3 };
+
+/// Перемешивание splitmix64
+constexpr uint64_t mix(uint64_t z) {
+    z += 0x9E3779B97F4A7C15ULL;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+constexpr std::array<std::array<uint64_t, BitMask128::CELLS>, KINDS> buildKeys() {
+    std::array<std::array<uint64_t, BitMask128::CELLS>, KINDS> keys{};
+    uint64_t state = 0x5A0B4157ULL;
+    for (int kind = 0; kind < KINDS; ++kind) {
+        for (int idx = 0; idx < BitMask128::CELLS; ++idx) {
+            state = mix(state);
+            keys[kind][idx] = state;
+        }
+    }
+    return keys;
+}
+
+inline constexpr std::array<std::array<uint64_t, BitMask128::CELLS>, KINDS> KEYS = buildKeys();
+
+/**
+ * @brief Число Зобриста для клетки idx в состоянии kind
+ */
+constexpr uint64_t key(Kind kind, int idx) { return KEYS[kind][idx]; }
+
+} // namespace ObservationHash
+
+/**
+ * @class TranspositionTable
+ * @brief Общая для всех стратегий Монте-Карло таблица готовых тепловых карт.
+ *
+ * Ключ - хеш Зобриста наблюдений, смешанный с параметрами стратегии.
+ * Память ограничена при создании: таблица из двухэлементных корзин, при
+ * переполнении вытесняется более глубокая позиция (ранние позиции
+ * встречаются чаще). Корзины защищены полосами мьютексов, поэтому
+ * стратегии в разных потоках могут пользоваться одной таблицей.
+ */
+class TranspositionTable {
+public:
+    static constexpr size_t DEFAULT_BYTES = size_t(64) << 20; ///< Объем по умолчанию (64 МБ)
+    static constexpr int STRIPES = 64;                       ///< Число полос блокировок
+
+    /**
+     * @brief Создает таблицу
+     * @param maxBytes Наибольший объем записей в байтах
+     */
+    explicit TranspositionTable(size_t maxBytes = DEFAULT_BYTES);
+
+    /**
+     * @brief Ищет карту позиции
+     *
+     * @param key Ключ позиции
+     * @param heat Карта (выход, заполняется только при успехе)
+     * @return true, если позиция найдена
+     */
+    bool probe(uint64_t key, std::array<int, BitMask128::CELLS>& heat) const;
+
+    /**
+     * @brief Сохраняет карту позиции
+     *
+     * @param key Ключ позиции
+     * @param depth Число выстрелов в позиции (для выбора вытесняемой записи)
+     * @param heat Карта позиции
+     */
+    void store(uint64_t key, int depth, const std::array<int, BitMask128::CELLS>& heat);
+
+    /**
+     * @brief Удаляет все записи и обнуляет счетчики
+     */
+    void clear();
+
+    uint64_t probes() const { return m_probes.load(std::memory_order_relaxed); }
+    uint64_t hits() const { return m_hits.load(std::memory_order_relaxed); }
+    uint64_t stores() const { return m_stores.load(std::memory_order_relaxed); }
+    size_t used() const { return m_used.load(std::memory_order_relaxed); }
+    size_t capacity() const { return m_entries.size(); }
+
+    /**
+     * @brief Объем записей в байтах
+     */
+    size_t bytes() const { return m_entries.size() * sizeof(Entry); }
+
+    /**
+     * @brief Строка со статистикой для журнала: попадания, заполнение, объем
+     */
+    std::string report() const;
+
+private:
+    static constexpr int WAYS = 2; ///< Записей в корзине
+
+    struct Entry {
+        uint64_t key = 0;
+        uint16_t depth = 0;
+        bool used = false;
+        std::array<uint16_t, BitMask128::CELLS> heat{}; ///< Карта, нормированная к максимуму 65535
+    };
+
+    std::vector<Entry> m_entries;
+    size_t m_setMask = 0;
+    mutable std::array<std::mutex, STRIPES> m_locks;
+
+    mutable std::atomic<uint64_t> m_probes{0};
+    mutable std::atomic<uint64_t> m_hits{0};
+    std::atomic<uint64_t> m_stores{0};
+    std::atomic<size_t> m_used{0};
+
+    std::mutex& lockFor(size_t set) const { return m_locks[set % STRIPES]; }
+};
@@ -1,32 +1,25 @@
 #include "io.h"
 #include <fstream>
 #include <stdexcept>
+#include <algorithm>
 
 using std::uint8_t;
 
-static void writeUint8(std::ofstream& ofs, uint8_t value) {
-    ofs.write(reinterpret_cast<const char*>(&value), sizeof(uint8_t));
-}
-
-static uint8_t readUint8(std::ifstream& ifs) {
-    uint8_t v{};
-    ifs.read(reinterpret_cast<char*>(&v), sizeof(uint8_t));
-    return v;
-}
+// Сигнатура файла с упакованными расстановками. Файлы старого формата
+// (30 байт на хромосому) начинаются с координаты 0..9 и не совпадают с ней.
+static const char PACKED_MAGIC[4] = {'B', 'S', 'P', '1'};
 
 void savePlacements(const std::string& path,
                     const std::vector<PlacementChromosome>& placements) {
     std::ofstream ofs(path, std::ios::binary);
     if (!ofs) throw std::runtime_error("Cannot open file for writing: " + path);
 
+    ofs.write(PACKED_MAGIC, sizeof(PACKED_MAGIC));
+    PlacementChromosome::PackedGenome packed;
     for (const auto& chrom : placements) {
-        const auto& genes = chrom.getGenes();
-        if (genes.size() != PlacementChromosome::GENES_COUNT)
-            throw std::runtime_error("Invalid gene count in chromosome");
-        for (int g : genes) {
-            uint8_t byte = static_cast<uint8_t>(g & 0xFF);
-            writeUint8(ofs, byte);
-        }
+        if (!chrom.pack(packed))
+            throw std::runtime_error("Invalid genes in chromosome");
+        ofs.write(reinterpret_cast<const char*>(packed.data()), packed.size());
     }
 }
 
@@ -35,13 +28,24 @@ std::vector<PlacementChromosome> loadPlacements(const std::string& path) {
     if (!ifs) throw std::runtime_error("Cannot open file for reading: " + path);
 
     std::vector<PlacementChromosome> out;
-    std::vector<int> genes(PlacementChromosome::GENES_COUNT);
 
-    while (ifs.peek() != EOF) {
-        for (int i = 0; i < PlacementChromosome::GENES_COUNT; ++i) {
-            uint8_t b = readUint8(ifs);
-            genes[i] = static_cast<int>(b);
+    char magic[sizeof(PACKED_MAGIC)] = {};
+    ifs.read(magic, sizeof(magic));
+    if (ifs.gcount() == sizeof(magic) &&
+        std::equal(magic, magic + sizeof(magic), PACKED_MAGIC)) {
+        // Упакованный формат: байт на корабль
+        PlacementChromosome::PackedGenome packed;
+        while (ifs.read(reinterpret_cast<char*>(packed.data()), packed.size())) {
+            out.push_back(PlacementChromosome::unpack(packed));
         }
+        return out;
+    }
+
+    // Старый формат: 30 байт (x, y, o) на хромосому
+    ifs.clear();
+    ifs.seekg(0);
+    PlacementChromosome::Genome genes;
+    while (ifs.read(reinterpret_cast<char*>(genes.data()), genes.size())) {
         out.emplace_back(genes);
     }
     return out;
@@ -7,13 +7,15 @@
 
 /**
  * @brief Сохраняет пул расстановок в бинарный файл.
- *        Формат: K подряд идущих хромосом, каждая 30 байт (uint8_t x,y,o)
+ *        Формат: сигнатура "BSP1", затем K хромосом в упакованной форме,
+ *        каждая 10 байт (байт на корабль: (y*10+x) | (o << 7))
  */
 void savePlacements(const std::string& path,
                     const std::vector<PlacementChromosome>& placements);
 
 /**
  * @brief Загружает пул расстановок из бинарного файла.
+ *        Поддерживает упакованный формат и старый (30 байт x,y,o на хромосому).
  */
 std::vector<PlacementChromosome> loadPlacements(const std::string& path);
 
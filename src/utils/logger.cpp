@@ -96,7 +96,7 @@ std::string Logger::genesAsString(const Chromosome& ch) const
     
     for (size_t i = 0; i < genes.size(); ++i) {
         if (i > 0) ss << " ";
-        ss << genes[i];
+        ss << +genes[i]; // унарный плюс: гены uint8_t печатаются числами, а не символами
     }
     
     return ss.str();
@@ -153,13 +153,29 @@ bool Logger::saveGAState(int gen, const ChromVec& population, double mutationRat
         // Получаем гены хромосомы
         const auto& genes = chrom.getGenes();
         
-        // Записываем размер вектора генов
-        size_t genesSize = genes.size();
-        file.write(reinterpret_cast<const char*>(&genesSize), sizeof(genesSize));
+        // Для PlacementChromosome пишем упакованную форму (байт на корабль);
+        // размер блока PACKED_SIZE отличает ее от старого формата (30 генов int)
+        bool written = false;
+        if constexpr (std::is_same_v<typename ChromVec::value_type, PlacementChromosome>) {
+            PlacementChromosome::PackedGenome packed;
+            if (chrom.pack(packed)) {
+                size_t genesSize = packed.size();
+                file.write(reinterpret_cast<const char*>(&genesSize), sizeof(genesSize));
+                file.write(reinterpret_cast<const char*>(packed.data()), packed.size());
+                written = true;
+            }
+        }
         
-        // Записываем сами гены
-        for (const auto& gene : genes) {
-            file.write(reinterpret_cast<const char*>(&gene), sizeof(gene));
+        if (!written) {
+            // Записываем размер вектора генов
+            size_t genesSize = genes.size();
+            file.write(reinterpret_cast<const char*>(&genesSize), sizeof(genesSize));
+            
+            // Записываем сами гены
+            for (const auto& gene : genes) {
+                int geneAsInt = static_cast<int>(gene);
+                file.write(reinterpret_cast<const char*>(&geneAsInt), sizeof(geneAsInt));
+            }
         }
         
         // Записываем значение фитнеса
@@ -207,16 +223,30 @@ bool Logger::loadGAState(int& gen, ChromVec& population, double& mutationRate, c
         size_t genesSize;
         file.read(reinterpret_cast<char*>(&genesSize), sizeof(genesSize));
         
-        // Создаем вектор для генов
-        std::vector<int> genes(genesSize);
-        
-        // Читаем гены
-        for (size_t j = 0; j < genesSize; ++j) {
-            file.read(reinterpret_cast<char*>(&genes[j]), sizeof(int));
+        typename ChromVec::value_type chrom;
+        bool loaded = false;
+        if constexpr (std::is_same_v<typename ChromVec::value_type, PlacementChromosome>) {
+            // Упакованная форма: байт на корабль
+            if (genesSize == PlacementChromosome::SHIP_COUNT) {
+                PlacementChromosome::PackedGenome packed;
+                file.read(reinterpret_cast<char*>(packed.data()), packed.size());
+                chrom = PlacementChromosome::unpack(packed);
+                loaded = true;
+            }
         }
         
-        // Создаем новую хромосому с загруженными генами
-        typename ChromVec::value_type chrom(genes);
+        if (!loaded) {
+            // Создаем вектор для генов
+            std::vector<int> genes(genesSize);
+            
+            // Читаем гены
+            for (size_t j = 0; j < genesSize; ++j) {
+                file.read(reinterpret_cast<char*>(&genes[j]), sizeof(int));
+            }
+            
+            // Создаем новую хромосому с загруженными генами
+            chrom = typename ChromVec::value_type(genes);
+        }
         
         // Читаем значение фитнеса
         double fitness;